@@ -0,0 +1,320 @@
+#include "libra/dependency_dag.h"
+#include "libra/table_of_contents.h"
+
+// Estimate how many archive blocks have to be read to load each root asset
+// (an asset that nothing else depends on) and all of its dependencies, both
+// for the layout in the TOC and for a new layout where every asset is placed
+// straight after its dependencies.
+
+#define DEFAULT_BLOCK_SIZE (256 * 1024)
+
+typedef struct {
+	RA_DependencyDag dag;
+	RA_TableOfContents toc;
+	RA_TocAsset** toc_assets; // Indexed by DAG asset index, NULL if the asset isn't in the TOC.
+	u32 block_size;
+	u32* visited; // Which root last visited each asset, plus one.
+	s32* stack;
+	u32* stack_next; // Index of the next dependency to visit for each stack entry.
+	u64* blocks;
+	u32 block_count;
+	u32 block_capacity;
+} Planner;
+
+typedef struct {
+	u64 total_blocks;
+	u32 max_blocks;
+} BlockStats;
+
+static void load(Planner* planner, const char* dag_path, const char* toc_path);
+static void plan_order(Planner* planner, s32* order, u32* order_count_dest, u64* new_offsets);
+static BlockStats count_blocks(Planner* planner, u64* new_offsets);
+static u32 count_blocks_for_root(Planner* planner, s32 root, u32 root_number, u64* new_offsets);
+static void add_blocks(Planner* planner, u64 archive, u64 offset, u32 size);
+static int compare_u64(const void* lhs, const void* rhs);
+static void print_help();
+
+int main(int argc, char** argv) {
+	const char* dag_path = NULL;
+	const char* toc_path = NULL;
+	const char* output_path = NULL;
+	u32 block_size = DEFAULT_BLOCK_SIZE;
+	for(int i = 1; i < argc; i++) {
+		if(strcmp(argv[i], "--block-size") == 0 && i + 1 < argc) {
+			block_size = (u32) strtoul(argv[++i], NULL, 0);
+		} else if(strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+			output_path = argv[++i];
+		} else if(dag_path == NULL) {
+			dag_path = argv[i];
+		} else if(toc_path == NULL) {
+			toc_path = argv[i];
+		} else {
+			print_help();
+			return 1;
+		}
+	}
+	if(dag_path == NULL || toc_path == NULL || block_size == 0) {
+		print_help();
+		return 1;
+	}
+	
+	Planner planner = {0};
+	planner.block_size = block_size;
+	load(&planner, dag_path, toc_path);
+	
+	u32 asset_count = planner.dag.asset_count;
+	s32* order = RA_malloc(asset_count * sizeof(s32));
+	u64* new_offsets = RA_malloc(asset_count * sizeof(u64));
+	if(order == NULL || new_offsets == NULL) {
+		fprintf(stderr, "Failed to allocate memory.\n");
+		return 1;
+	}
+	
+	u32 order_count;
+	plan_order(&planner, order, &order_count, new_offsets);
+	
+	BlockStats before = count_blocks(&planner, NULL);
+	BlockStats after = count_blocks(&planner, new_offsets);
+	
+	u32 root_count = 0;
+	for(u32 i = 0; i < asset_count; i++) {
+		u32 dependent_count;
+		RA_dag_lookup_dependents(&planner.dag, i, &dependent_count);
+		if(dependent_count == 0) {
+			root_count++;
+		}
+	}
+	
+	printf("%u assets, %u in the TOC, %u roots, %u byte blocks.\n", asset_count, order_count, root_count, block_size);
+	if(root_count > 0) {
+		printf("Blocks touched per root (TOC order):       %.2f average, %u max\n", (double) before.total_blocks / root_count, before.max_blocks);
+		printf("Blocks touched per root (dependency order): %.2f average, %u max\n", (double) after.total_blocks / root_count, after.max_blocks);
+	}
+	
+	if(output_path != NULL) {
+		FILE* output = fopen(output_path, "w");
+		if(output == NULL) {
+			fprintf(stderr, "Failed to open output file '%s'.\n", output_path);
+			return 1;
+		}
+		for(u32 i = 0; i < order_count; i++) {
+			fprintf(output, "%s\n", planner.dag.assets[order[i]].name);
+		}
+		fclose(output);
+	}
+	
+	RA_free(order);
+	RA_free(new_offsets);
+	RA_free(planner.toc_assets);
+	RA_free(planner.visited);
+	RA_free(planner.stack);
+	RA_free(planner.stack_next);
+	if(planner.blocks) {
+		RA_free(planner.blocks);
+	}
+	RA_toc_free(&planner.toc, FREE_FILE_DATA);
+	RA_dag_free(&planner.dag, true);
+	
+	return 0;
+}
+
+static void load(Planner* planner, const char* dag_path, const char* toc_path) {
+	RA_Result result;
+	
+	u8* dag_data;
+	s64 dag_size;
+	if((result = RA_file_read(dag_path, &dag_data, &dag_size)) != RA_SUCCESS) {
+		fprintf(stderr, "Failed to read DAG file '%s' (%s).\n", dag_path, result->message);
+		exit(1);
+	}
+	
+	if((result = RA_dag_parse(&planner->dag, dag_data, (u32) dag_size)) != RA_SUCCESS) {
+		fprintf(stderr, "Failed to parse DAG file '%s' (%s).\n", dag_path, result->message);
+		exit(1);
+	}
+	
+	if((result = RA_dag_build_reverse_index(&planner->dag)) != RA_SUCCESS) {
+		fprintf(stderr, "Failed to build reverse index (%s).\n", result->message);
+		exit(1);
+	}
+	
+	u8* toc_data;
+	s64 toc_size;
+	if((result = RA_file_read(toc_path, &toc_data, &toc_size)) != RA_SUCCESS) {
+		fprintf(stderr, "Failed to read TOC file '%s' (%s).\n", toc_path, result->message);
+		exit(1);
+	}
+	
+	if((result = RA_toc_parse(&planner->toc, toc_data, (u32) toc_size)) != RA_SUCCESS) {
+		fprintf(stderr, "Failed to parse TOC file '%s' (%s).\n", toc_path, result->message);
+		exit(1);
+	}
+	
+	u32 asset_count = planner->dag.asset_count;
+	planner->toc_assets = RA_malloc(asset_count * sizeof(RA_TocAsset*));
+	planner->visited = RA_calloc(asset_count, sizeof(u32));
+	planner->stack = RA_malloc(asset_count * sizeof(s32));
+	planner->stack_next = RA_malloc(asset_count * sizeof(u32));
+	if(planner->toc_assets == NULL || planner->visited == NULL || planner->stack == NULL || planner->stack_next == NULL) {
+		fprintf(stderr, "Failed to allocate memory.\n");
+		exit(1);
+	}
+	
+	// Only the main asset group is considered, since that's what gets loaded
+	// when an asset is first needed.
+	for(u32 i = 0; i < asset_count; i++) {
+		planner->toc_assets[i] = RA_toc_lookup_asset(planner->toc.assets, planner->toc.asset_count, planner->dag.assets[i].name_crc, 0);
+	}
+}
+
+// Place the assets in DFS postorder starting from each of the roots, so that
+// assets come straight after their dependencies, and assets that are only
+// used by one root are packed together.
+static void plan_order(Planner* planner, s32* order, u32* order_count_dest, u64* new_offsets) {
+	RA_DependencyDag* dag = &planner->dag;
+	u64 offset = 0;
+	u32 order_count = 0;
+	
+	// Do the roots first, then pick up any assets left over in cycles.
+	for(u32 pass = 0; pass < 2; pass++) {
+		for(u32 root = 0; root < dag->asset_count; root++) {
+			u32 dependent_count;
+			RA_dag_lookup_dependents(dag, root, &dependent_count);
+			if(planner->visited[root] || (pass == 0 && dependent_count > 0)) {
+				continue;
+			}
+			
+			u32 stack_top = 0;
+			planner->stack[stack_top] = (s32) root;
+			planner->stack_next[stack_top] = 0;
+			stack_top++;
+			planner->visited[root] = 1;
+			while(stack_top > 0) {
+				RA_DependencyDagAsset* asset = &dag->assets[planner->stack[stack_top - 1]];
+				u32* next = &planner->stack_next[stack_top - 1];
+				if(*next < asset->dependency_count) {
+					s32 dependency = asset->dependencies[(*next)++];
+					if(!planner->visited[dependency]) {
+						planner->visited[dependency] = 1;
+						planner->stack[stack_top] = dependency;
+						planner->stack_next[stack_top] = 0;
+						stack_top++;
+					}
+				} else {
+					s32 index = planner->stack[--stack_top];
+					RA_TocAsset* toc_asset = planner->toc_assets[index];
+					if(toc_asset != NULL) {
+						order[order_count++] = index;
+						new_offsets[index] = offset;
+						offset += toc_asset->metadata.size;
+					}
+				}
+			}
+		}
+	}
+	
+	*order_count_dest = order_count;
+}
+
+// If new_offsets is NULL, use the offsets from the TOC.
+static BlockStats count_blocks(Planner* planner, u64* new_offsets) {
+	BlockStats stats = {0};
+	memset(planner->visited, 0, planner->dag.asset_count * sizeof(u32));
+	
+	u32 root_number = 0;
+	for(u32 root = 0; root < planner->dag.asset_count; root++) {
+		u32 dependent_count;
+		RA_dag_lookup_dependents(&planner->dag, root, &dependent_count);
+		if(dependent_count == 0) {
+			u32 block_count = count_blocks_for_root(planner, (s32) root, ++root_number, new_offsets);
+			stats.total_blocks += block_count;
+			stats.max_blocks = MAX(stats.max_blocks, block_count);
+		}
+	}
+	
+	return stats;
+}
+
+static u32 count_blocks_for_root(Planner* planner, s32 root, u32 root_number, u64* new_offsets) {
+	RA_DependencyDag* dag = &planner->dag;
+	planner->block_count = 0;
+	
+	u32 stack_top = 0;
+	planner->stack[stack_top++] = root;
+	planner->visited[root] = root_number;
+	while(stack_top > 0) {
+		s32 index = planner->stack[--stack_top];
+		RA_TocAsset* toc_asset = planner->toc_assets[index];
+		if(toc_asset != NULL) {
+			if(new_offsets) {
+				add_blocks(planner, 0, new_offsets[index], toc_asset->metadata.size);
+			} else {
+				add_blocks(planner, toc_asset->metadata.archive_index, toc_asset->metadata.offset, toc_asset->metadata.size);
+			}
+		}
+		RA_DependencyDagAsset* asset = &dag->assets[index];
+		for(u32 i = 0; i < asset->dependency_count; i++) {
+			s32 dependency = asset->dependencies[i];
+			if(planner->visited[dependency] != root_number) {
+				planner->visited[dependency] = root_number;
+				planner->stack[stack_top++] = dependency;
+			}
+		}
+	}
+	
+	if(planner->block_count == 0) {
+		return 0;
+	}
+	
+	qsort(planner->blocks, planner->block_count, sizeof(u64), compare_u64);
+	u32 unique_count = 1;
+	for(u32 i = 1; i < planner->block_count; i++) {
+		if(planner->blocks[i] != planner->blocks[i - 1]) {
+			unique_count++;
+		}
+	}
+	return unique_count;
+}
+
+static void add_blocks(Planner* planner, u64 archive, u64 offset, u32 size) {
+	u64 first = offset / planner->block_size;
+	u64 last = (offset + MAX(size, 1) - 1) / planner->block_size;
+	for(u64 block = first; block <= last; block++) {
+		if(planner->block_count >= planner->block_capacity) {
+			u32 new_capacity = MAX(planner->block_capacity * 2, 1024);
+			u64* new_blocks = RA_malloc(new_capacity * sizeof(u64));
+			if(new_blocks == NULL) {
+				fprintf(stderr, "Failed to allocate memory.\n");
+				exit(1);
+			}
+			if(planner->blocks) {
+				memcpy(new_blocks, planner->blocks, planner->block_count * sizeof(u64));
+				RA_free(planner->blocks);
+			}
+			planner->blocks = new_blocks;
+			planner->block_capacity = new_capacity;
+		}
+		// Archive indices are small, so pack them into the top bits.
+		planner->blocks[planner->block_count++] = (archive << 48) | block;
+	}
+}
+
+static int compare_u64(const void* lhs, const void* rhs) {
+	u64 lhs_value = *(const u64*) lhs;
+	u64 rhs_value = *(const u64*) rhs;
+	if(lhs_value < rhs_value) {
+		return -1;
+	} else if(lhs_value > rhs_value) {
+		return 1;
+	} else {
+		return 0;
+	}
+}
+
+static void print_help() {
+	puts("Estimate how many archive blocks need to be read to load each root asset and its dependencies, and plan an asset order that reduces that.");
+	puts("");
+	puts("usage: assetorder <dag file> <toc file> [--block-size <bytes>] [-o <order file>]");
+	puts("");
+	puts("The block size defaults to 256 KiB. If -o is passed, the planned order is written out as one asset path per line.");
+}
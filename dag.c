@@ -4,8 +4,11 @@
 static void list(const char* input_file);
 static void deps(const char* input_file);
 static void lookup(const char* input_file, const char* hash_str);
-static void rebuild(const char* input_file, const char* output_file);
+static void rdeps(const char* input_file, const char* hash_str);
+static void closure(const char* input_file, char** assets, s32 asset_count);
+static void rebuild(const char* input_file, const char* output_file, const char* option);
 static void print_help();
+static const char* name_or_placeholder(RA_DependencyDagView* view, u32 asset_index);
 
 int main(int argc, char** argv) {
 	if(argc == 3 && strcmp(argv[1], "list") == 0) {
@@ -14,8 +17,12 @@ int main(int argc, char** argv) {
 		deps(argv[2]);
 	} else if(argc == 4 && strcmp(argv[1], "lookup") == 0) {
 		lookup(argv[2], argv[3]);
-	} else if(argc == 4 && strcmp(argv[1], "rebuild") == 0) {
-		rebuild(argv[2], argv[3]);
+	} else if(argc == 4 && strcmp(argv[1], "rdeps") == 0) {
+		rdeps(argv[2], argv[3]);
+	} else if(argc >= 4 && strcmp(argv[1], "closure") == 0) {
+		closure(argv[2], &argv[3], argc - 3);
+	} else if((argc == 4 || argc == 5) && strcmp(argv[1], "rebuild") == 0) {
+		rebuild(argv[2], argv[3], argc == 5 ? argv[4] : NULL);
 	} else {
 		print_help();
 		return 1;
@@ -32,18 +39,17 @@ static void list(const char* input_file) {
 		exit(1);
 	}
 	
-	RA_DependencyDag dag;
-	if((result = RA_dag_parse(&dag, data, (u32) size)) != RA_SUCCESS) {
+	RA_DependencyDagView view;
+	if((result = RA_dag_view(&view, data, (u32) size)) != RA_SUCCESS) {
 		fprintf(stderr, "Failed to parse DAG file '%s' (%s).\n", input_file, result->message);
 		exit(1);
 	}
 	
-	for(u32 i = 0; i < dag.asset_count; i++) {
-		RA_DependencyDagAsset* asset = &dag.assets[i];
-		printf("%s\n", asset->name);
+	for(u32 i = 0; i < view.asset_count; i++) {
+		printf("%s\n", name_or_placeholder(&view, i));
 	}
 	
-	RA_dag_free(&dag, true);
+	RA_free(data);
 }
 
 static void deps(const char* input_file) {
@@ -56,22 +62,22 @@ static void deps(const char* input_file) {
 		exit(1);
 	}
 	
-	RA_DependencyDag dag;
-	if((result = RA_dag_parse(&dag, data, (u32) size)) != RA_SUCCESS) {
+	RA_DependencyDagView view;
+	if((result = RA_dag_view(&view, data, (u32) size)) != RA_SUCCESS) {
 		fprintf(stderr, "Failed to parse DAG file '%s' (%s).\n", input_file, result->message);
 		exit(1);
 	}
 	
-	for(u32 i = 0; i < dag.asset_count; i++) {
-		RA_DependencyDagAsset* asset = &dag.assets[i];
-		printf("%s\n", asset->name);
-		for(u32 j = 0; j < asset->dependency_count; j++) {
-			RA_DependencyDagAsset* dependency = &dag.assets[asset->dependencies[j]];
-			printf("\t%s\n", dependency->name);
+	for(u32 i = 0; i < view.asset_count; i++) {
+		printf("%s\n", name_or_placeholder(&view, i));
+		u32 dependency_count;
+		s32* dependencies = RA_dag_view_dependencies(&view, i, &dependency_count);
+		for(u32 j = 0; j < dependency_count; j++) {
+			printf("\t%s\n", name_or_placeholder(&view, (u32) dependencies[j]));
 		}
 	}
 	
-	RA_dag_free(&dag, true);
+	RA_free(data);
 }
 
 static void lookup(const char* input_file, const char* hash_str) {
@@ -84,6 +90,38 @@ static void lookup(const char* input_file, const char* hash_str) {
 		exit(1);
 	}
 	
+	RA_DependencyDagView view;
+	if((result = RA_dag_view(&view, data, (u32) size)) != RA_SUCCESS) {
+		fprintf(stderr, "Failed to parse DAG file '%s' (%s).\n", input_file, result->message);
+		exit(1);
+	}
+	
+	// Only one lookup is needed, so hashing the names until there's a match
+	// is quicker than building the lookup table.
+	u64 hash = strtoull(hash_str, NULL, 16);
+	u32 i = 0;
+	while(i < view.asset_count && RA_dag_view_name_crc(&view, i) != hash) {
+		i++;
+	}
+	if(i == view.asset_count) {
+		fprintf(stderr, "No asset with that hash.\n");
+		exit(1);
+	}
+	printf("%s\n", RA_dag_view_name(&view, i));
+	
+	RA_free(data);
+}
+
+static void rdeps(const char* input_file, const char* hash_str) {
+	RA_Result result;
+	
+	u8* data;
+	s64 size;
+	if((result = RA_file_read(input_file, &data, &size)) != RA_SUCCESS) {
+		fprintf(stderr, "Failed to read input file '%s'.\n", input_file);
+		exit(1);
+	}
+	
 	RA_DependencyDag dag;
 	if((result = RA_dag_parse(&dag, data, (u32) size)) != RA_SUCCESS) {
 		fprintf(stderr, "Failed to parse DAG file '%s' (%s).\n", input_file, result->message);
@@ -96,14 +134,93 @@ static void lookup(const char* input_file, const char* hash_str) {
 		fprintf(stderr, "No asset with that hash.\n");
 		exit(1);
 	}
+	
+	if((result = RA_dag_build_reverse_index(&dag)) != RA_SUCCESS) {
+		fprintf(stderr, "Failed to build reverse index (%s).\n", result->message);
+		exit(1);
+	}
+	
 	printf("%s\n", asset->name);
+	u32 dependent_count;
+	s32* dependents = RA_dag_lookup_dependents(&dag, (u32) (asset - dag.assets), &dependent_count);
+	for(u32 i = 0; i < dependent_count; i++) {
+		printf("\t%s\n", dag.assets[dependents[i]].name);
+	}
 	
 	RA_dag_free(&dag, true);
 }
 
-static void rebuild(const char* input_file, const char* output_file) {
+static void closure(const char* input_file, char** assets, s32 asset_count) {
 	RA_Result result;
 	
+	u8* data;
+	s64 size;
+	if((result = RA_file_read(input_file, &data, &size)) != RA_SUCCESS) {
+		fprintf(stderr, "Failed to read input file '%s'.\n", input_file);
+		exit(1);
+	}
+	
+	RA_DependencyDag dag;
+	if((result = RA_dag_parse(&dag, data, (u32) size)) != RA_SUCCESS) {
+		fprintf(stderr, "Failed to parse DAG file '%s' (%s).\n", input_file, result->message);
+		exit(1);
+	}
+	
+	s32* roots = RA_malloc(asset_count * sizeof(s32));
+	u64* reachable = RA_malloc(RA_DAG_BITSET_SIZE(dag.asset_count) * sizeof(u64));
+	if(roots == NULL || reachable == NULL) {
+		fprintf(stderr, "Failed to allocate memory.\n");
+		exit(1);
+	}
+	
+	for(s32 i = 0; i < asset_count; i++) {
+		// Treat arguments that look like a hash as a hash, and anything else as
+		// a path.
+		u64 hash;
+		if(strlen(assets[i]) == 16 && strspn(assets[i], "0123456789abcdefABCDEF") == 16) {
+			hash = strtoull(assets[i], NULL, 16);
+		} else {
+			hash = RA_crc64_path(assets[i]);
+		}
+		RA_DependencyDagAsset* asset = RA_dag_lookup_asset(&dag, hash);
+		if(asset == NULL) {
+			fprintf(stderr, "No asset '%s'.\n", assets[i]);
+			exit(1);
+		}
+		roots[i] = (s32) (asset - dag.assets);
+	}
+	
+	if((result = RA_dag_reachable(&dag, roots, asset_count, reachable)) != RA_SUCCESS) {
+		fprintf(stderr, "Failed to compute closure (%s).\n", result->message);
+		exit(1);
+	}
+	
+	for(u32 i = 0; i < dag.asset_count; i++) {
+		if(RA_DAG_BITSET_TEST(reachable, i)) {
+			printf("%s\n", dag.assets[i].name);
+		}
+	}
+	
+	RA_free(reachable);
+	RA_free(roots);
+	RA_dag_free(&dag, true);
+}
+
+static void rebuild(const char* input_file, const char* output_file, const char* option) {
+	RA_Result result;
+	
+	u32 writer_flags = 0;
+	if(option != NULL) {
+		if(strcmp(option, "--deduplicate-strings") == 0) {
+			writer_flags = RA_DAT_WRITER_DEDUPLICATE_STRINGS;
+		} else if(strcmp(option, "--merge-string-suffixes") == 0) {
+			writer_flags = RA_DAT_WRITER_MERGE_STRING_SUFFIXES;
+		} else {
+			fprintf(stderr, "Unknown option '%s'.\n", option);
+			exit(1);
+		}
+	}
+	
 	u8* in_data;
 	s64 in_size;
 	if((result = RA_file_read(input_file, &in_data, &in_size)) != RA_SUCCESS) {
@@ -119,7 +236,8 @@ static void rebuild(const char* input_file, const char* output_file) {
 	
 	u8* out_data;
 	s64 out_size;
-	if((result = RA_dag_build(&dag, &out_data, &out_size)) != RA_SUCCESS) {
+	u32 string_bytes_saved;
+	if((result = RA_dag_build(&dag, &out_data, &out_size, writer_flags, &string_bytes_saved)) != RA_SUCCESS) {
 		fprintf(stderr, "Failed to rebuild DAG file '%s' (%s).\n", output_file, result->message);
 		exit(1);
 	}
@@ -129,6 +247,10 @@ static void rebuild(const char* input_file, const char* output_file) {
 		exit(1);
 	}
 	
+	if(writer_flags != 0) {
+		printf("Saved %u bytes by sharing strings.\n", string_bytes_saved);
+	}
+	
 	RA_dag_free(&dag, true);
 }
 
@@ -139,4 +261,12 @@ static void print_help() {
 	puts("  list <input file> -- List all asset file paths, one per line.");
 	puts("  deps <input file> -- List all asset file paths, and their dependencies.");
 	puts("  lookup <input file> <hash> -- Lookup an asset by its hash.");
+	puts("  rdeps <input file> <hash> -- List all the assets that depend on an asset.");
+	puts("  closure <input file> <asset path|hash>... -- List all the assets needed to load the given assets.");
+	puts("  rebuild <input file> <output file> [--deduplicate-strings|--merge-string-suffixes] -- Parse and rebuild a DAG file.");
+}
+
+static const char* name_or_placeholder(RA_DependencyDagView* view, u32 asset_index) {
+	const char* name = RA_dag_view_name(view, asset_index);
+	return name ? name : "(bad asset)";
 }
@@ -51,6 +51,11 @@ int main(int argc, char** argv) {
 	RA_Archive archive;
 	s32 current_archive_index = -1;
 	
+	// The asset data is only needed until it's written out, so reuse the same
+	// memory for every asset.
+	RA_Arena scratch;
+	RA_arena_create(&scratch);
+	
 	// Extract all the files.
 	for(u32 i = 0; i < toc.asset_count; i++) {
 		RA_TocAsset* toc_asset = &toc.assets[i];
@@ -97,7 +102,8 @@ int main(int argc, char** argv) {
 		if(toc_asset->has_header) {
 			data_offset += sizeof(RA_TocAssetHeader);
 		}
-		u8* data = RA_calloc(1, data_offset + toc_asset->metadata.size);
+		RA_arena_reset(&scratch);
+		u8* data = RA_arena_calloc(&scratch, 1, data_offset + toc_asset->metadata.size);
 		u32 size = data_offset + toc_asset->metadata.size;
 		if(toc_asset->has_header) {
 			memcpy(data, &toc_asset->header, sizeof(RA_TocAssetHeader));
@@ -133,9 +139,9 @@ int main(int argc, char** argv) {
 			fprintf(stderr, "error: Failed to write file '%s' (%s).\n", out_path, result->message);
 			return 1;
 		}
-		
-		RA_free(data);
 	}
+	
+	RA_arena_destroy(&scratch);
 }
 
 static void parse_dag_and_toc(RA_DependencyDag* dag, RA_TableOfContents* toc, const char* game_dir) {
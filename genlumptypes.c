@@ -1,8 +1,22 @@
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include "crc/crc.h"
 
+#define MAX_LUMP_TYPES 255
+#define MAX_HASH_BITS 12
+#define MAX_HASH_ATTEMPTS (1 << 20)
+
+typedef struct {
+	char identifier[128];
+	char name[128];
+	unsigned int crc;
+} LumpType;
+
+static int find_perfect_hash(unsigned int* keys, int key_count, int* bits_dest, unsigned int* multiplier_dest, unsigned char* table_dest);
+static void write_hash_table(FILE* out_file, const char* prefix, int bits, unsigned int multiplier, unsigned char* table);
+
 int main(int argc, char** argv) {
 	if(argc != 1 && argc != 2) {
 		fprintf(stderr, "usage: ./genlumptypes [lump_types.txt]");
@@ -26,13 +40,18 @@ int main(int argc, char** argv) {
 	char* extension = strrchr(out_path, '.');
 	if(extension == NULL || extension[1] == '\0') {
 		fprintf(stderr, "Failed to parse input path.\n");
+		return 1;
 	}
 	extension[1] = 'h';
 	extension[2] = '\0';
 	
-	FILE* out_file = fopen(out_path, "w");
+	// The hash tables are written to e.g. lump_types_hash.h next to the main
+	// output file.
+	char hash_path[256];
+	snprintf(hash_path, sizeof(hash_path), "%.*s_hash.h", (int) (extension - out_path), out_path);
 	
-	fprintf(out_file, "// This file is generated from lump_types.txt by genlumptypes.\n");
+	static LumpType lump_types[MAX_LUMP_TYPES];
+	int lump_type_count = 0;
 	
 	char line[1024];
 	while(fgets(line, 1024, in_file)) {
@@ -41,18 +60,134 @@ int main(int argc, char** argv) {
 			continue;
 		}
 		
+		if(lump_type_count >= MAX_LUMP_TYPES) {
+			fprintf(stderr, "Too many lump types.\n");
+			return 1;
+		}
+		LumpType* lump_type = &lump_types[lump_type_count++];
+		
 		char macro[128];
-		char identifier[128];
 		char name[128];
-		sscanf(line, "%127s %127s %[^\n]\n", macro, identifier, name);
+		sscanf(line, "%127s %127s %[^\n]\n", macro, lump_type->identifier, name);
 		
 		if(strcmp(macro, "LUMP_TYPE") == 0) {
-			fprintf(out_file, "LUMP_TYPE(%s, 0x%x, \"%s\")\n", identifier, RA_crc32_string(name), name);
+			strcpy(lump_type->name, name);
+			lump_type->crc = RA_crc32_string(name);
 		} else if(strcmp(macro, "LUMP_TYPE_FAKE_NAME") == 0) {
-			fprintf(out_file, "LUMP_TYPE(%s, %s, \"%s\")\n", identifier, name, identifier);
+			strcpy(lump_type->name, lump_type->identifier);
+			lump_type->crc = (unsigned int) strtoul(name, NULL, 16);
 		} else {
 			fprintf(stderr, "Failed to parse lump types file.\n");
 			return 1;
 		}
 	}
+	
+	fclose(in_file);
+	
+	FILE* out_file = fopen(out_path, "w");
+	if(!out_file) {
+		fprintf(stderr, "Failed to open output file.\n");
+		return 1;
+	}
+	
+	fprintf(out_file, "// This file is generated from lump_types.txt by genlumptypes.\n");
+	for(int i = 0; i < lump_type_count; i++) {
+		fprintf(out_file, "LUMP_TYPE(%s, 0x%x, \"%s\")\n", lump_types[i].identifier, lump_types[i].crc, lump_types[i].name);
+	}
+	
+	fclose(out_file);
+	
+	// Generate perfect hash tables so that lump types can be looked up by CRC
+	// or by name without searching. The name table is keyed on the CRC of the
+	// name, which is the same as the lump CRC except for fake names.
+	static unsigned int crc_keys[MAX_LUMP_TYPES];
+	static unsigned int name_keys[MAX_LUMP_TYPES];
+	for(int i = 0; i < lump_type_count; i++) {
+		crc_keys[i] = lump_types[i].crc;
+		name_keys[i] = RA_crc32_string(lump_types[i].name);
+	}
+	
+	int crc_bits;
+	unsigned int crc_multiplier;
+	static unsigned char crc_table[1 << MAX_HASH_BITS];
+	if(!find_perfect_hash(crc_keys, lump_type_count, &crc_bits, &crc_multiplier, crc_table)) {
+		fprintf(stderr, "Failed to find a perfect hash for the lump CRCs (duplicate lump type?).\n");
+		return 1;
+	}
+	
+	int name_bits;
+	unsigned int name_multiplier;
+	static unsigned char name_table[1 << MAX_HASH_BITS];
+	if(!find_perfect_hash(name_keys, lump_type_count, &name_bits, &name_multiplier, name_table)) {
+		fprintf(stderr, "Failed to find a perfect hash for the lump names (duplicate lump type?).\n");
+		return 1;
+	}
+	
+	FILE* hash_file = fopen(hash_path, "w");
+	if(!hash_file) {
+		fprintf(stderr, "Failed to open hash table output file.\n");
+		return 1;
+	}
+	
+	fprintf(hash_file, "// This file is generated from lump_types.txt by genlumptypes.\n");
+	fprintf(hash_file, "// Indices into the lump_types array, 0xff for empty slots.\n");
+	write_hash_table(hash_file, "CRC", crc_bits, crc_multiplier, crc_table);
+	write_hash_table(hash_file, "NAME", name_bits, name_multiplier, name_table);
+	
+	fclose(hash_file);
+	
+	return 0;
+}
+
+static int find_perfect_hash(unsigned int* keys, int key_count, int* bits_dest, unsigned int* multiplier_dest, unsigned char* table_dest) {
+	// Deterministic so that regenerating the tables produces the same output.
+	unsigned int state = 1;
+	for(int bits = 1; bits <= MAX_HASH_BITS; bits++) {
+		if((1 << bits) < key_count) {
+			continue;
+		}
+		for(int attempt = 0; attempt < MAX_HASH_ATTEMPTS; attempt++) {
+			state = state * 1664525 + 1013904223;
+			unsigned int multiplier = state | 1;
+			
+			memset(table_dest, 0xff, 1 << bits);
+			int i;
+			for(i = 0; i < key_count; i++) {
+				unsigned int slot = (keys[i] * multiplier) >> (32 - bits);
+				if(table_dest[slot] != 0xff) {
+					break;
+				}
+				table_dest[slot] = (unsigned char) i;
+			}
+			
+			if(i == key_count) {
+				*bits_dest = bits;
+				*multiplier_dest = multiplier;
+				return 1;
+			}
+		}
+	}
+	return 0;
+}
+
+static void write_hash_table(FILE* out_file, const char* prefix, int bits, unsigned int multiplier, unsigned char* table) {
+	fprintf(out_file, "#define LUMP_TYPE_%s_HASH_MULTIPLIER 0x%xu\n", prefix, multiplier);
+	fprintf(out_file, "#define LUMP_TYPE_%s_HASH_SHIFT %d\n", prefix, 32 - bits);
+	fprintf(out_file, "#define LUMP_TYPE_%s_HASH_SIZE %d\n", prefix, 1 << bits);
+	fprintf(out_file, "LUMP_TYPE_%s_HASH_TABLE(\n", prefix);
+	for(int i = 0; i < (1 << bits); i++) {
+		if(i % 16 == 0) {
+			fprintf(out_file, "\t");
+		}
+		fprintf(out_file, "0x%02x", table[i]);
+		if(i + 1 < (1 << bits)) {
+			fprintf(out_file, ",");
+		}
+		if(i % 16 == 15 || i + 1 == (1 << bits)) {
+			fprintf(out_file, "\n");
+		} else {
+			fprintf(out_file, " ");
+		}
+	}
+	fprintf(out_file, ")\n");
 }
@@ -34,6 +34,8 @@ b8 GUI_settings_draw(Settings* settings, f32 window_width, f32 window_height) {
 			igPopStyleColor(1);
 		}
 		
+		igCheckbox("Compress Mod Cache", &settings_scratch.compress_mod_cache);
+		
 		igBeginDisabled(settings_scratch.game_dir_valid == false);
 		
 		f32 button_height = igGetFont()->FontSize + igGetStyle()->FramePadding.y * 2.f;
@@ -80,6 +82,11 @@ RA_Result GUI_settings_read(Settings* settings, const char* path) {
 		settings->game_dir_valid = is_valid_game_dir(settings->game_dir);
 	}
 	
+	json_object* compress_mod_cache_json = json_object_object_get(root, "compress_mod_cache");
+	if(compress_mod_cache_json) {
+		settings->compress_mod_cache = json_object_get_boolean(compress_mod_cache_json);
+	}
+	
 	json_object_put(root);
 	return RA_SUCCESS;
 }
@@ -92,6 +99,9 @@ RA_Result GUI_settings_write(Settings* settings, const char* path) {
 	json_object* game_dir = json_object_new_string(settings->game_dir);
 	json_object_object_add(root, "game_dir", game_dir);
 	
+	json_object* compress_mod_cache = json_object_new_boolean(settings->compress_mod_cache);
+	json_object_object_add(root, "compress_mod_cache", compress_mod_cache);
+	
 	const char* string = json_object_to_json_string(root);
 	if((result = RA_file_write(path, (u8*) string, strlen(string))) != RA_SUCCESS) {
 		return result;
@@ -6,6 +6,7 @@
 typedef struct {
 	b8 game_dir_valid;
 	char game_dir[RA_MAX_PATH];
+	b8 compress_mod_cache;
 } Settings;
 
 void GUI_settings_open(Settings* settings);
@@ -2,11 +2,13 @@
 #include <filesystem>
 
 #include <libra/dat_container.h>
+#include <libra/sweep.h>
 #include <libra/texture.h>
 
 namespace fs = std::filesystem;
 
-static RA_Result process_file(const char* name, bool print_lumps);
+static RA_Result process_dir_file(RA_SweepJob* job, const char* path, void* user);
+static RA_Result process_file(RA_SweepJob* job, const char* path, bool print_lumps);
 
 static enum {
 	SORT_CRC,
@@ -14,11 +16,12 @@ static enum {
 	SORT_SIZE
 } sort_mode;
 static s32 header_offset = 0;
+static s32 thread_count = 1;
 
 int main(int argc, char** argv) {
 	if(argc < 2) {
 		fprintf(stderr, "igfile -- https://github.com/chaoticgd/ripped_apart\n");
-		fprintf(stderr, "usage: %s [-sc|-so|-ss] [-h <header offset>] <input paths>\n", argv[0]);
+		fprintf(stderr, "usage: %s [-sc|-so|-ss] [-h <header offset>] [-j <threads>] <input paths>\n", argv[0]);
 		return 1;
 	}
 	
@@ -46,12 +49,27 @@ int main(int argc, char** argv) {
 			header_offset = atoi(argv[++i]);
 		}
 		
+		if(strcmp(argv[i], "-j") == 0) {
+			if(i + 1 >= argc) {
+				fprintf(stderr, "error: Missing thread count argument.\n");
+				return 1;
+			}
+			thread_count = atoi(argv[++i]);
+			continue;
+		}
+		
 		if(fs::is_directory(argv[i])) {
-			for(const auto& dir_entry : fs::recursive_directory_iterator(argv[i])) {
-				process_file(dir_entry.path().string().c_str(), false);
+			RA_SweepOptions options = {};
+			options.thread_count = thread_count;
+			options.recursive = true;
+			options.ordered = true;
+			options.process = process_dir_file;
+			RA_Result result = RA_sweep(argv[i], &options);
+			if(result != NULL) {
+				fprintf(stderr, "error: Failed to enumerate directory (%s).\n", result->message);
 			}
 		} else {
-			RA_Result result = process_file(argv[i], true);
+			RA_Result result = process_file(NULL, argv[i], true);
 			if(result != NULL) {
 				fprintf(stderr, "error: Failed to parse DAT1 header (%s).\n", result->message);
 			}
@@ -62,7 +80,12 @@ int main(int argc, char** argv) {
 static int sort_offset(const void* lhs, const void* rhs) { return ((RA_DatLump*) lhs)->offset > ((RA_DatLump*) rhs)->offset; }
 static int sort_size(const void* lhs, const void* rhs) { return ((RA_DatLump*) lhs)->size > ((RA_DatLump*) rhs)->size; }
 
-static RA_Result process_file(const char* path, bool print_lumps) {
+static RA_Result process_dir_file(RA_SweepJob* job, const char* path, void* user) {
+	process_file(job, path, false);
+	return NULL;
+}
+
+static RA_Result process_file(RA_SweepJob* job, const char* path, bool print_lumps) {
 	RA_Result result;
 	
 	RA_DatFile dat;
@@ -70,16 +93,16 @@ static RA_Result process_file(const char* path, bool print_lumps) {
 		return result;
 	}
 	
-	printf("%s", path);
+	RA_sweep_printf(job, "%s", path);
 	
 	if(dat.asset_type_crc == RA_ASSET_TYPE_TEXTURE) {
 		verify(dat.lump_count > 0 && dat.lumps[0].type_crc == 0x4ede3593, "error: Bad lumps.");
 		RA_TextureHeader* tex_header = (RA_TextureHeader*) dat.lumps[0].data;
 		const char* format = RA_texture_format_to_string(tex_header->format);
-		printf(" texture format=%s width=%hd height=%hd", format, tex_header->width, tex_header->height);
+		RA_sweep_printf(job, " texture format=%s width=%hd height=%hd", format, tex_header->width, tex_header->height);
 	}
 	
-	printf("\n");
+	RA_sweep_printf(job, "\n");
 	
 	if(print_lumps) {
 		switch(sort_mode) {
@@ -97,5 +120,6 @@ static RA_Result process_file(const char* path, bool print_lumps) {
 		}
 	}
 	
+	RA_dat_free(&dat, FREE_FILE_DATA);
 	return NULL;
 }
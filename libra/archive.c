@@ -2,8 +2,31 @@
 
 #include <lz4.h>
 #include "gdeflate_wrapper.h"
+#include "platform.h"
+
+// How many blocks are compressed at once per thread.
+#define BLOCKS_PER_THREAD 4
+
+struct t_RA_ArchiveWriter {
+	FILE* file;
+	RA_ArchiveBlockHeader* blocks;
+	u32 block_count;
+	u32 max_block_count;
+	u32 data_begin;
+	s32 thread_count;
+	u8* input; // The blocks that haven't been compressed yet.
+	u32 input_size;
+	u32 batch_block_count;
+	u8* output; // One slot per block in the batch.
+	u32* output_sizes;
+	u32 output_slot_size;
+	u64 decompressed_offset; // Of the start of the batch.
+	u64 compressed_offset; // Where the next block will be written.
+};
 
 static RA_Result load_dsar_block(RA_Archive* archive, RA_ArchiveBlock* block);
+static RA_Result flush_batch(RA_ArchiveWriter* writer);
+static void compress_blocks(u32 begin, u32 end, void* user);
 
 RA_Result RA_archive_open(RA_Archive* archive, const char* path) {
 	memset(archive, 0, sizeof(RA_Archive));
@@ -132,6 +155,7 @@ static RA_Result load_dsar_block(RA_Archive* archive, RA_ArchiveBlock* block) {
 			if(!gdeflate_decompress(block->decompressed_data, block->header.decompressed_size, compressed_data, compressed_size, 8)) {
 				RA_free(compressed_data);
 				RA_free(block->decompressed_data);
+				block->decompressed_data = NULL;
 				return RA_FAILURE("failed to decompress gdeflate block");
 			}
 			block->decompressed_size = block->header.decompressed_size;
@@ -142,6 +166,7 @@ static RA_Result load_dsar_block(RA_Archive* archive, RA_ArchiveBlock* block) {
 			if(bytes_written != block->header.decompressed_size) {
 				RA_free(compressed_data);
 				RA_free(block->decompressed_data);
+				block->decompressed_data = NULL;
 				return RA_FAILURE("failed to decompress lz4 block");
 			}
 			block->decompressed_size = block->header.decompressed_size;
@@ -149,6 +174,7 @@ static RA_Result load_dsar_block(RA_Archive* archive, RA_ArchiveBlock* block) {
 		}
 		default: {
 			RA_free(block->decompressed_data);
+			block->decompressed_data = NULL;
 			RA_free(compressed_data);
 			return RA_FAILURE("unknown compression mode %hhd", block->header.compression_mode);
 		}
@@ -158,3 +184,150 @@ static RA_Result load_dsar_block(RA_Archive* archive, RA_ArchiveBlock* block) {
 	
 	return RA_SUCCESS;
 }
+
+// *****************************************************************************
+
+RA_ArchiveWriter* RA_archive_writer_begin(FILE* file, s64 max_size, s32 thread_count) {
+	RA_ArchiveWriter* writer = RA_calloc(1, sizeof(RA_ArchiveWriter));
+	if(writer == NULL) {
+		return NULL;
+	}
+	writer->file = file;
+	writer->max_block_count = (u32) ((max_size + RA_ARCHIVE_WRITER_BLOCK_SIZE - 1) / RA_ARCHIVE_WRITER_BLOCK_SIZE);
+	writer->data_begin = (u32) ALIGN(sizeof(RA_ArchiveHeader) + writer->max_block_count * sizeof(RA_ArchiveBlockHeader), 0x10);
+	// The batch only needs to be big enough to keep the threads busy, which
+	// also limits how much memory is buffered.
+	writer->thread_count = thread_count > 0 ? thread_count : RA_processor_count();
+	writer->batch_block_count = (u32) writer->thread_count * BLOCKS_PER_THREAD;
+	writer->output_slot_size = (u32) LZ4_compressBound(RA_ARCHIVE_WRITER_BLOCK_SIZE);
+	writer->compressed_offset = writer->data_begin;
+	
+	writer->blocks = RA_calloc(MAX(writer->max_block_count, 1), sizeof(RA_ArchiveBlockHeader));
+	writer->input = RA_malloc(writer->batch_block_count * RA_ARCHIVE_WRITER_BLOCK_SIZE);
+	writer->output = RA_malloc(writer->batch_block_count * (s64) writer->output_slot_size);
+	writer->output_sizes = RA_malloc(writer->batch_block_count * sizeof(u32));
+	if(writer->blocks == NULL || writer->input == NULL || writer->output == NULL || writer->output_sizes == NULL) {
+		RA_archive_writer_abort(writer);
+		return NULL;
+	}
+	
+	return writer;
+}
+
+RA_Result RA_archive_writer_write(RA_ArchiveWriter* writer, const void* data, s64 size) {
+	RA_Result result;
+	
+	u32 batch_size = writer->batch_block_count * RA_ARCHIVE_WRITER_BLOCK_SIZE;
+	const u8* src = data;
+	while(size > 0) {
+		u32 copy_size = (u32) MIN(size, batch_size - writer->input_size);
+		memcpy(writer->input + writer->input_size, src, copy_size);
+		writer->input_size += copy_size;
+		src += copy_size;
+		size -= copy_size;
+		if(writer->input_size == batch_size && (result = flush_batch(writer)) != RA_SUCCESS) {
+			return result;
+		}
+	}
+	
+	return RA_SUCCESS;
+}
+
+s64 RA_archive_writer_offset(RA_ArchiveWriter* writer) {
+	return writer->decompressed_offset + writer->input_size;
+}
+
+RA_Result RA_archive_writer_finish(RA_ArchiveWriter* writer) {
+	RA_Result result;
+	
+	if(writer->input_size > 0 && (result = flush_batch(writer)) != RA_SUCCESS) {
+		RA_archive_writer_abort(writer);
+		return result;
+	}
+	
+	RA_ArchiveHeader header = {0};
+	header.magic = FOURCC("DSAR");
+	header.version = 0x10003;
+	header.block_count = writer->block_count;
+	header.data_begin = writer->data_begin;
+	header.unknown_10 = writer->compressed_offset;
+	
+	// The block headers that were reserved but not used are left as padding.
+	if(fseek(writer->file, 0, SEEK_SET) != 0
+		|| fwrite(&header, sizeof(RA_ArchiveHeader), 1, writer->file) != 1
+		|| (writer->block_count > 0 && fwrite(writer->blocks, writer->block_count * sizeof(RA_ArchiveBlockHeader), 1, writer->file) != 1)
+		|| fseek(writer->file, writer->compressed_offset, SEEK_SET) != 0) {
+		RA_archive_writer_abort(writer);
+		return RA_FAILURE("cannot write archive header");
+	}
+	
+	RA_archive_writer_abort(writer);
+	return RA_SUCCESS;
+}
+
+void RA_archive_writer_abort(RA_ArchiveWriter* writer) {
+	if(writer->blocks) {
+		RA_free(writer->blocks);
+	}
+	if(writer->input) {
+		RA_free(writer->input);
+	}
+	if(writer->output) {
+		RA_free(writer->output);
+	}
+	if(writer->output_sizes) {
+		RA_free(writer->output_sizes);
+	}
+	RA_free(writer);
+}
+
+static RA_Result flush_batch(RA_ArchiveWriter* writer) {
+	u32 block_count = (writer->input_size + RA_ARCHIVE_WRITER_BLOCK_SIZE - 1) / RA_ARCHIVE_WRITER_BLOCK_SIZE;
+	if(writer->block_count + block_count > writer->max_block_count) {
+		return RA_FAILURE("more data written to archive than was reserved for");
+	}
+	
+	if(writer->thread_count > 1) {
+		RA_parallel_for(block_count, BLOCKS_PER_THREAD, compress_blocks, writer);
+	} else {
+		compress_blocks(0, block_count, writer);
+	}
+	
+	// Write the blocks out in order, so they can be read back sequentially.
+	if(fseek(writer->file, writer->compressed_offset, SEEK_SET) != 0) {
+		return RA_FAILURE("cannot seek in archive");
+	}
+	for(u32 i = 0; i < block_count; i++) {
+		u32 decompressed_size = MIN(writer->input_size - i * RA_ARCHIVE_WRITER_BLOCK_SIZE, RA_ARCHIVE_WRITER_BLOCK_SIZE);
+		u32 compressed_size = writer->output_sizes[i];
+		if(compressed_size == 0) {
+			return RA_FAILURE("failed to compress lz4 block");
+		}
+		if(fwrite(writer->output + i * (s64) writer->output_slot_size, compressed_size, 1, writer->file) != 1) {
+			return RA_FAILURE("cannot write block");
+		}
+		
+		RA_ArchiveBlockHeader* block = &writer->blocks[writer->block_count++];
+		block->decompressed_offset = writer->decompressed_offset + i * RA_ARCHIVE_WRITER_BLOCK_SIZE;
+		block->compressed_offset = writer->compressed_offset;
+		block->decompressed_size = decompressed_size;
+		block->compressed_size = compressed_size;
+		block->compression_mode = RA_ARCHIVE_COMPRESSION_LZ4;
+		writer->compressed_offset += compressed_size;
+	}
+	
+	writer->decompressed_offset += writer->input_size;
+	writer->input_size = 0;
+	
+	return RA_SUCCESS;
+}
+
+static void compress_blocks(u32 begin, u32 end, void* user) {
+	RA_ArchiveWriter* writer = user;
+	for(u32 i = begin; i < end; i++) {
+		u32 offset = i * RA_ARCHIVE_WRITER_BLOCK_SIZE;
+		u32 size = MIN(writer->input_size - offset, RA_ARCHIVE_WRITER_BLOCK_SIZE);
+		char* dest = (char*) writer->output + i * (s64) writer->output_slot_size;
+		writer->output_sizes[i] = (u32) LZ4_compress_default((char*) writer->input + offset, dest, (s32) size, (s32) writer->output_slot_size);
+	}
+}
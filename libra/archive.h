@@ -44,4 +44,24 @@ RA_Result RA_archive_close(RA_Archive* archive);
 s64 RA_archive_get_decompressed_size(RA_Archive* archive);
 RA_Result RA_archive_read(RA_Archive* archive, u32 offset, u32 size, u8* data_dest);
 
+// Writer
+
+// Data written to a DSAR archive is split up into blocks of this size, which
+// are compressed with LZ4 on multiple threads.
+#define RA_ARCHIVE_WRITER_BLOCK_SIZE (256 * 1024)
+
+struct t_RA_ArchiveWriter;
+typedef struct t_RA_ArchiveWriter RA_ArchiveWriter;
+
+// The file must be empty. Space for the block headers is reserved up front,
+// so max_size must be at least the total size of the data to be written. The
+// thread count is 0 for one per processor, or 1 to compress everything on the
+// calling thread, which is what callers that are already running on a worker
+// thread should pass unless they have a share of the processors to use.
+RA_ArchiveWriter* RA_archive_writer_begin(FILE* file, s64 max_size, s32 thread_count);
+RA_Result RA_archive_writer_write(RA_ArchiveWriter* writer, const void* data, s64 size);
+s64 RA_archive_writer_offset(RA_ArchiveWriter* writer); // Decompressed offset of the next byte to be written.
+RA_Result RA_archive_writer_finish(RA_ArchiveWriter* writer); // Write out the headers. Doesn't close the file.
+void RA_archive_writer_abort(RA_ArchiveWriter* writer);
+
 #endif
@@ -1,11 +1,21 @@
 #include "arena.h"
 
+#include "platform.h"
+
+// Commit at least this much at a time, to cut down on system calls.
+#define MIN_COMMIT_SIZE (64 * 1024)
+
+static void free_blocks(RA_ArenaBlock* block);
+
 void RA_arena_create(RA_Arena* arena) {
 	memset(arena, 0, sizeof(RA_Arena));
 }
 
 void RA_arena_destroy(RA_Arena* arena) {
-	RA_ArenaBlock* block = arena->head;
+	free_blocks(arena->head);
+}
+
+static void free_blocks(RA_ArenaBlock* block) {
 	while(block != NULL) {
 		RA_ArenaBlock* next = block->next;
 		RA_free(block);
@@ -28,6 +38,16 @@ void* RA_arena_alloc_aligned(RA_Arena* arena, s64 size, s64 alignment) {
 		offset = 0;
 	} else if(offset + size > arena->tail->capacity) {
 		RA_ArenaBlock* prev = arena->tail;
+		RA_ArenaBlock* spare = prev->next;
+		if(spare != NULL && spare->capacity >= (u64) size) {
+			// Reuse a block left over from before the arena was rewound.
+			arena->tail = spare;
+			arena->top = size;
+			spare->top = size;
+			return spare->data;
+		}
+		free_blocks(spare);
+		prev->next = NULL;
 		s64 capacity = MAX(size, prev->capacity * 2);
 		RA_ArenaBlock* temp = RA_malloc(sizeof(RA_ArenaBlock) + capacity);
 		if(temp == NULL) {
@@ -70,7 +90,91 @@ s64 RA_arena_copy(RA_Arena* arena, u8* data_dest, s64 max_size) {
 		bytes_copied += block->top;
 		data_dest += block->top;
 		max_size -= block->top;
+		if(block == arena->tail) {
+			// Blocks past the tail are left over from before a rewind.
+			break;
+		}
 		block = block->next;
 	}
 	return bytes_copied;
 }
+
+RA_ArenaMark RA_arena_mark(RA_Arena* arena) {
+	RA_ArenaMark mark;
+	mark.block = arena->tail;
+	mark.top = arena->top;
+	return mark;
+}
+
+void RA_arena_rewind(RA_Arena* arena, RA_ArenaMark mark) {
+	if(arena->head == NULL) {
+		return;
+	}
+	// A NULL block means the mark was taken before anything was allocated.
+	arena->tail = mark.block != NULL ? mark.block : arena->head;
+	arena->top = mark.block != NULL ? mark.top : 0;
+	arena->tail->top = arena->top;
+}
+
+void RA_arena_reset(RA_Arena* arena) {
+	RA_ArenaBlock* largest = arena->head;
+	for(RA_ArenaBlock* block = arena->head; block != NULL; block = block->next) {
+		if(block->capacity > largest->capacity) {
+			largest = block;
+		}
+	}
+	if(largest == NULL) {
+		return;
+	}
+	if(largest->prev != NULL) {
+		largest->prev->next = NULL;
+		free_blocks(arena->head);
+	}
+	free_blocks(largest->next);
+	largest->prev = NULL;
+	largest->next = NULL;
+	largest->top = 0;
+	arena->head = largest;
+	arena->tail = largest;
+	arena->top = 0;
+}
+
+RA_Result RA_contiguous_arena_create(RA_ContiguousArena* arena, s64 max_size) {
+	memset(arena, 0, sizeof(RA_ContiguousArena));
+	s64 reserved = ALIGN(MAX(max_size, 1), RA_virtual_page_size());
+	arena->data = RA_virtual_reserve(reserved);
+	if(arena->data == NULL) {
+		return RA_FAILURE("cannot reserve %lld bytes of address space", (long long) reserved);
+	}
+	arena->reserved = reserved;
+	return RA_SUCCESS;
+}
+
+void RA_contiguous_arena_destroy(RA_ContiguousArena* arena) {
+	if(arena->data) {
+		RA_virtual_release(arena->data, arena->reserved);
+	}
+	memset(arena, 0, sizeof(RA_ContiguousArena));
+}
+
+void* RA_contiguous_arena_alloc_aligned(RA_ContiguousArena* arena, s64 size, s64 alignment) {
+	u64 offset = ALIGN(arena->top, alignment);
+	if(offset + size > arena->reserved) {
+		return NULL;
+	}
+	if(offset + size > arena->committed) {
+		// Grow geometrically so that the number of commits is logarithmic.
+		u64 committed = MAX(offset + size, MAX(arena->committed * 2, MIN_COMMIT_SIZE));
+		committed = MIN(ALIGN(committed, (u64) RA_virtual_page_size()), arena->reserved);
+		if(RA_virtual_commit(arena->data + arena->committed, committed - arena->committed) != RA_SUCCESS) {
+			return NULL;
+		}
+		arena->committed = committed;
+	}
+	arena->top = offset + size;
+	return arena->data + offset;
+}
+
+void* RA_contiguous_arena_alloc(RA_ContiguousArena* arena, s64 size) {
+	return RA_contiguous_arena_alloc_aligned(arena, size, 8);
+}
@@ -17,6 +17,12 @@ typedef struct {
 	u64 top;
 } RA_Arena;
 
+// A position in an arena that it can later be rewound to.
+typedef struct {
+	RA_ArenaBlock* block;
+	u64 top;
+} RA_ArenaMark;
+
 void RA_arena_create(RA_Arena* arena);
 void RA_arena_destroy(RA_Arena* arena);
 void* RA_arena_alloc_aligned(RA_Arena* arena, s64 size, s64 alignment);
@@ -24,4 +30,27 @@ void* RA_arena_alloc(RA_Arena* arena, s64 size);
 void* RA_arena_calloc(RA_Arena* arena, s64 element_count, s64 element_size);
 s64 RA_arena_copy(RA_Arena* arena, u8* data_dest, s64 max_size);
 
+// Rewinding frees everything allocated since the mark was taken, but keeps the
+// blocks around so that they can be reused by later allocations. Resetting
+// frees everything and keeps only the largest block.
+RA_ArenaMark RA_arena_mark(RA_Arena* arena);
+void RA_arena_rewind(RA_Arena* arena, RA_ArenaMark mark);
+void RA_arena_reset(RA_Arena* arena);
+
+// An arena that reserves a range of address space up front and commits pages
+// as it grows, so everything allocated from it is in one contiguous region
+// starting at data that never moves. The memory isn't from RA_malloc, so it
+// must not be passed to RA_free.
+typedef struct {
+	u8* data;
+	u64 top;
+	u64 committed;
+	u64 reserved;
+} RA_ContiguousArena;
+
+RA_Result RA_contiguous_arena_create(RA_ContiguousArena* arena, s64 max_size);
+void RA_contiguous_arena_destroy(RA_ContiguousArena* arena);
+void* RA_contiguous_arena_alloc_aligned(RA_ContiguousArena* arena, s64 size, s64 alignment);
+void* RA_contiguous_arena_alloc(RA_ContiguousArena* arena, s64 size);
+
 #endif
@@ -0,0 +1,284 @@
+#include "dag_schedule.h"
+
+#include "platform.h"
+
+// The pending count for assets that aren't in the set.
+#define NOT_SCHEDULED UINT32_MAX
+
+struct t_RA_DagJob {
+	RA_DagScheduleResults* results;
+	RA_Arena* arena;
+	s32 asset_index;
+};
+
+// The worker threads are started once and then woken up for each wave. The
+// calling thread works on each wave too, and then waits for the others.
+typedef struct {
+	RA_DagScheduleOptions* options;
+	RA_DagScheduleResults* results;
+	const s32* assets; // The current wave.
+	u32 asset_count;
+	u32 next; // Index of the next asset to be picked up by a worker.
+	u32 wave_index; // Bumped to wake up the workers for a new wave.
+	u32 running_count; // Worker threads still working on the current wave.
+	b8 finished;
+	RA_Mutex* mutex;
+	RA_CondVar* wave_started;
+	RA_CondVar* wave_done;
+	b8 failed;
+	char error_message[1024];
+} Schedule;
+
+typedef struct {
+	Schedule* schedule;
+	RA_Arena* arena;
+} Worker;
+
+static void worker_thread(void* user);
+static void process_wave(Schedule* schedule, RA_Arena* arena);
+
+RA_Result RA_dag_schedule(RA_DependencyDag* dag, const s32* assets, u32 asset_count, RA_DagScheduleOptions* options, RA_DagScheduleResults* results_dest) {
+	RA_Result result;
+	
+	memset(results_dest, 0, sizeof(RA_DagScheduleResults));
+	
+	if(dag->dependent_offsets == NULL && (result = RA_dag_build_reverse_index(dag)) != RA_SUCCESS) {
+		return result;
+	}
+	
+	s32 thread_count = options->thread_count > 0 ? options->thread_count : RA_processor_count();
+	
+	results_dest->results = RA_calloc(MAX(dag->asset_count, 1), sizeof(void*));
+	results_dest->asset_count = dag->asset_count;
+	results_dest->arenas = RA_calloc(thread_count, sizeof(RA_Arena));
+	results_dest->arena_count = thread_count;
+	u32* pending = RA_malloc(MAX(dag->asset_count, 1) * sizeof(u32));
+	s32* waves = RA_malloc(MAX(asset_count, 1) * sizeof(s32)); // All the waves, one after the other.
+	Worker* workers = RA_calloc(thread_count, sizeof(Worker));
+	RA_Thread** threads = RA_calloc(thread_count, sizeof(RA_Thread*));
+	s32 threads_started = 0;
+	Schedule schedule = {0};
+	schedule.options = options;
+	schedule.results = results_dest;
+	schedule.mutex = RA_mutex_create();
+	schedule.wave_started = RA_condvar_create();
+	schedule.wave_done = RA_condvar_create();
+	if(results_dest->results == NULL || results_dest->arenas == NULL || pending == NULL || waves == NULL
+		|| workers == NULL || threads == NULL || schedule.mutex == NULL || schedule.wave_started == NULL || schedule.wave_done == NULL) {
+		result = RA_FAILURE("cannot allocate schedule");
+		goto cleanup;
+	}
+	for(s32 i = 0; i < thread_count; i++) {
+		RA_arena_create(&results_dest->arenas[i]);
+		workers[i].schedule = &schedule;
+		workers[i].arena = &results_dest->arenas[i];
+	}
+	
+	// Count how many dependencies each asset is waiting on, ignoring the ones
+	// outside of the set. The waves array is used to hold the set for now.
+	memset(pending, 0xff, dag->asset_count * sizeof(u32));
+	u32 scheduled_count = 0;
+	for(u32 i = 0; i < asset_count; i++) {
+		if(assets[i] < 0 || assets[i] >= dag->asset_count) {
+			result = RA_FAILURE("asset index out of range");
+			goto cleanup;
+		}
+		if(pending[assets[i]] == NOT_SCHEDULED) {
+			pending[assets[i]] = 0;
+			waves[scheduled_count++] = assets[i];
+		}
+	}
+	for(u32 i = 0; i < scheduled_count; i++) {
+		RA_DependencyDagAsset* asset = &dag->assets[waves[i]];
+		for(u32 j = 0; j < asset->dependency_count; j++) {
+			if(pending[asset->dependencies[j]] != NOT_SCHEDULED) {
+				pending[waves[i]]++;
+			}
+		}
+	}
+	
+	// The first wave is everything that isn't waiting on anything. The rest of
+	// the set can be overwritten, since every asset will be added back in a
+	// later wave once it stops waiting.
+	u32 wave_end = 0;
+	for(u32 i = 0; i < scheduled_count; i++) {
+		if(pending[waves[i]] == 0) {
+			waves[wave_end++] = waves[i];
+		}
+	}
+	
+	// The calling thread is the first worker. If some of the threads can't be
+	// started, the rest of them just get more work each.
+	for(threads_started = 0; threads_started < thread_count - 1; threads_started++) {
+		if(RA_thread_create(&threads[threads_started], worker_thread, &workers[threads_started + 1]) != RA_SUCCESS) {
+			break;
+		}
+	}
+	
+	u32 wave_begin = 0;
+	while(wave_begin < wave_end) {
+		RA_mutex_lock(schedule.mutex);
+		schedule.assets = &waves[wave_begin];
+		schedule.asset_count = wave_end - wave_begin;
+		schedule.next = 0;
+		// Waking the other threads up for a single asset isn't worth it.
+		if(schedule.asset_count > 1 && threads_started > 0) {
+			schedule.wave_index++;
+			schedule.running_count = threads_started;
+			RA_condvar_broadcast(schedule.wave_started);
+		}
+		RA_mutex_unlock(schedule.mutex);
+		
+		process_wave(&schedule, workers[0].arena);
+		
+		RA_mutex_lock(schedule.mutex);
+		while(schedule.running_count > 0) {
+			RA_condvar_wait(schedule.wave_done, schedule.mutex);
+		}
+		RA_mutex_unlock(schedule.mutex);
+		results_dest->wave_count++;
+		
+		if(schedule.failed) {
+			result = RA_FAILURE("%s", schedule.error_message);
+			goto cleanup;
+		}
+		
+		// Anything that was only waiting on this wave goes in the next one.
+		u32 next_wave_end = wave_end;
+		for(u32 i = wave_begin; i < wave_end; i++) {
+			u32 dependent_count;
+			s32* dependents = RA_dag_lookup_dependents(dag, (u32) waves[i], &dependent_count);
+			for(u32 j = 0; j < dependent_count; j++) {
+				s32 dependent = dependents[j];
+				if(pending[dependent] != NOT_SCHEDULED && --pending[dependent] == 0) {
+					waves[next_wave_end++] = dependent;
+				}
+			}
+		}
+		wave_begin = wave_end;
+		wave_end = next_wave_end;
+	}
+	
+	if(wave_end < scheduled_count) {
+		result = RA_FAILURE("dependency cycle involving %u assets", scheduled_count - wave_end);
+		goto cleanup;
+	}
+	
+	result = RA_SUCCESS;
+	
+cleanup:
+	if(threads_started > 0) {
+		RA_mutex_lock(schedule.mutex);
+		schedule.finished = true;
+		RA_condvar_broadcast(schedule.wave_started);
+		RA_mutex_unlock(schedule.mutex);
+		for(s32 i = 0; i < threads_started; i++) {
+			RA_thread_join(threads[i]);
+		}
+	}
+	if(schedule.wave_done) {
+		RA_condvar_destroy(schedule.wave_done);
+	}
+	if(schedule.wave_started) {
+		RA_condvar_destroy(schedule.wave_started);
+	}
+	if(schedule.mutex) {
+		RA_mutex_destroy(schedule.mutex);
+	}
+	if(threads) {
+		RA_free(threads);
+	}
+	if(workers) {
+		RA_free(workers);
+	}
+	if(waves) {
+		RA_free(waves);
+	}
+	if(pending) {
+		RA_free(pending);
+	}
+	if(result != RA_SUCCESS) {
+		RA_dag_schedule_free(results_dest);
+	}
+	return result;
+}
+
+static void worker_thread(void* user) {
+	Worker* worker = user;
+	Schedule* schedule = worker->schedule;
+	
+	u32 wave_index = 0;
+	RA_mutex_lock(schedule->mutex);
+	for(;;) {
+		while(schedule->wave_index == wave_index && !schedule->finished) {
+			RA_condvar_wait(schedule->wave_started, schedule->mutex);
+		}
+		if(schedule->finished) {
+			break;
+		}
+		wave_index = schedule->wave_index;
+		RA_mutex_unlock(schedule->mutex);
+		
+		process_wave(schedule, worker->arena);
+		
+		RA_mutex_lock(schedule->mutex);
+		if(--schedule->running_count == 0) {
+			RA_condvar_signal(schedule->wave_done);
+		}
+	}
+	RA_mutex_unlock(schedule->mutex);
+}
+
+static void process_wave(Schedule* schedule, RA_Arena* arena) {
+	RA_DagJob job;
+	job.results = schedule->results;
+	job.arena = arena;
+	
+	// Hand out the assets one at a time, since some may take much longer to
+	// process than others.
+	for(;;) {
+		u32 index = RA_atomic_fetch_add_u32(&schedule->next, 1);
+		if(index >= schedule->asset_count) {
+			break;
+		}
+		job.asset_index = schedule->assets[index];
+		RA_Result result = schedule->options->process(&job, job.asset_index, schedule->options->user);
+		if(result != RA_SUCCESS) {
+			// The error message is thread local, so copy it out.
+			RA_mutex_lock(schedule->mutex);
+			if(!schedule->failed) {
+				RA_string_copy(schedule->error_message, result->message, sizeof(schedule->error_message));
+				schedule->failed = true;
+			}
+			RA_mutex_unlock(schedule->mutex);
+		}
+	}
+}
+
+void RA_dag_schedule_free(RA_DagScheduleResults* results) {
+	if(results->results) {
+		RA_free(results->results);
+	}
+	if(results->arenas) {
+		for(u32 i = 0; i < results->arena_count; i++) {
+			RA_arena_destroy(&results->arenas[i]);
+		}
+		RA_free(results->arenas);
+	}
+	memset(results, 0, sizeof(RA_DagScheduleResults));
+}
+
+void* RA_dag_job_alloc(RA_DagJob* job, s64 size) {
+	return RA_arena_alloc(job->arena, size);
+}
+
+void RA_dag_job_set_result(RA_DagJob* job, void* result) {
+	job->results->results[job->asset_index] = result;
+}
+
+void* RA_dag_job_result(RA_DagJob* job, s32 asset_index) {
+	if(asset_index < 0 || asset_index >= job->results->asset_count) {
+		return NULL;
+	}
+	return job->results->results[asset_index];
+}
@@ -0,0 +1,50 @@
+#ifndef LIBRA_DAG_SCHEDULE_H
+#define LIBRA_DAG_SCHEDULE_H
+
+#include "dependency_dag.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Process a set of assets from a DAG on multiple threads, where each asset is
+// only processed once all of its dependencies in the set have been. The set is
+// split up into waves, where every asset in a wave only depends on assets in
+// earlier waves, and each wave is shared out between the worker threads. The
+// threads are started once and kept for every wave, and the calling thread is
+// one of them. Dependencies that aren't in the set are ignored.
+
+struct t_RA_DagJob;
+typedef struct t_RA_DagJob RA_DagJob;
+
+typedef RA_Result RA_DagJobFunc(RA_DagJob* job, s32 asset_index, void* user);
+
+typedef struct {
+	s32 thread_count; // 0 for one per processor, 1 to do everything on the calling thread.
+	RA_DagJobFunc* process; // Called on a worker thread.
+	void* user;
+} RA_DagScheduleOptions;
+
+typedef struct {
+	void** results; // Indexed by asset index. NULL if an asset wasn't processed or didn't set a result.
+	u32 asset_count;
+	u32 wave_count;
+	RA_Arena* arenas; // One per worker thread.
+	u32 arena_count;
+} RA_DagScheduleResults;
+
+// Builds the reverse index if it hasn't been built already. Fails if there's
+// a dependency cycle in the set, or if processing an asset fails, in which case
+// no more waves are started.
+RA_Result RA_dag_schedule(RA_DependencyDag* dag, const s32* assets, u32 asset_count, RA_DagScheduleOptions* options, RA_DagScheduleResults* results_dest);
+void RA_dag_schedule_free(RA_DagScheduleResults* results);
+
+void* RA_dag_job_alloc(RA_DagJob* job, s64 size);     // Allocate memory that lives as long as the results.
+void RA_dag_job_set_result(RA_DagJob* job, void* result);
+void* RA_dag_job_result(RA_DagJob* job, s32 asset_index); // Get the result for a dependency that has already been processed.
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
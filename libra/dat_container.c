@@ -165,11 +165,70 @@ RA_DatLump* RA_dat_lookup_lump(RA_DatFile* dat, u32 name_crc) {
 	return NULL;
 }
 
+RA_Result RA_dat_peek_lump(RA_DatLump* dest, u8* data, u32 size, u32 file_size, u32 bytes_before_magic, u32 type_crc) {
+	memset(dest, 0, sizeof(RA_DatLump));
+	
+	if((u64) bytes_before_magic + sizeof(DatHeader) > size) {
+		return RA_FAILURE("not enough space for header");
+	}
+	
+	DatHeader* header = (DatHeader*) &data[bytes_before_magic];
+	if(header->magic != FOURCC("1TAD")) {
+		return RA_FAILURE("bad magic bytes");
+	}
+	if(header->lump_count <= 0) {
+		return RA_FAILURE("lump count is zero");
+	}
+	if(header->lump_count > 1000) {
+		return RA_FAILURE("lump count is too high");
+	}
+	if((u64) bytes_before_magic + sizeof(DatHeader) + header->lump_count * sizeof(LumpHeader) > size) {
+		return RA_FAILURE("not enough space for lump headers");
+	}
+	
+	for(s32 i = 0; i < header->lump_count; i++) {
+		LumpHeader* lump = &header->lumps[i];
+		if(lump->type_crc == type_crc) {
+			if((u64) bytes_before_magic + lump->offset + lump->size > file_size) {
+				return RA_FAILURE("lump past end of file");
+			}
+			if(lump->size > 256 * 1024 * 1024) {
+				return RA_FAILURE("lump too big");
+			}
+			dest->type_crc = lump->type_crc;
+			dest->offset = lump->offset;
+			dest->size = lump->size;
+			if((u64) bytes_before_magic + lump->offset + lump->size <= size) {
+				dest->data = data + bytes_before_magic + lump->offset;
+			}
+			return RA_SUCCESS;
+		}
+	}
+	
+	return RA_FAILURE("missing lump");
+}
+
 // Writing
 
+typedef struct {
+	const char* string;
+	u32 size;
+} DirectString;
+
+typedef struct {
+	const char* string;
+	u32 size;
+	u32 offset;
+	u64 hash;
+} StringTableEntry;
+
+// Sizes and offsets in the header are 32 bits, so nothing written can be any
+// bigger than this.
+#define MAX_WRITER_SIZE ((s64) UINT32_MAX)
+
 struct t_RA_DatWriter {
-	RA_Arena prologue;
-	RA_Arena lumps;
+	RA_ContiguousArena prologue;
+	RA_ContiguousArena lumps;
 	u32 bytes_before_magic;
 	u32 prologue_size;
 	u32 lumps_size;
@@ -178,40 +237,70 @@ struct t_RA_DatWriter {
 	u16 shader_count;
 	b8 write_lump_called;
 	b8 write_string_called;
+	u32 flags;
+	// Strings already written, if deduplication is enabled. Open addressing.
+	StringTableEntry* string_table;
+	u32 string_table_capacity;
+	u32 string_table_count;
+	u32 string_bytes_saved;
+	// Direct mode only.
+	b8 direct;
+	b8 owns_output;
+	RA_Arena strings;
+	u8* output;
+	u32* lump_offsets;
 };
 
-RA_DatWriter* RA_dat_writer_begin(u32 asset_type_crc, u32 bytes_before_magic) {
+static RA_DatWriter* begin(u32 asset_type_crc, u32 bytes_before_magic, b8 direct) {
 	RA_DatWriter* writer = RA_calloc(1, sizeof(RA_DatWriter));
 	if(writer == NULL) {
 		return NULL;
 	}
-	RA_arena_create(&writer->prologue);
-	RA_arena_create(&writer->lumps);
-	if(RA_arena_alloc_aligned(&writer->prologue, bytes_before_magic + sizeof(DatHeader), 1) == NULL) {
+	RA_arena_create(&writer->strings);
+	if(RA_contiguous_arena_create(&writer->prologue, MAX_WRITER_SIZE) != RA_SUCCESS) {
+		RA_free(writer);
+		return NULL;
+	}
+	if(RA_contiguous_arena_create(&writer->lumps, MAX_WRITER_SIZE) != RA_SUCCESS) {
+		RA_contiguous_arena_destroy(&writer->prologue);
+		RA_free(writer);
+		return NULL;
+	}
+	if(RA_contiguous_arena_alloc_aligned(&writer->prologue, bytes_before_magic + sizeof(DatHeader), 1) == NULL) {
+		RA_contiguous_arena_destroy(&writer->prologue);
+		RA_contiguous_arena_destroy(&writer->lumps);
+		RA_free(writer);
 		return NULL;
 	}
 	writer->bytes_before_magic = bytes_before_magic;
 	writer->prologue_size = bytes_before_magic + sizeof(DatHeader);
 	writer->asset_type_crc = asset_type_crc;
+	writer->direct = direct;
 	return writer;
 }
 
-void* RA_dat_writer_lump(RA_DatWriter* writer, u32 type_crc, s64 size) {
+RA_DatWriter* RA_dat_writer_begin(u32 asset_type_crc, u32 bytes_before_magic) {
+	return begin(asset_type_crc, bytes_before_magic, false);
+}
+
+RA_DatWriter* RA_dat_writer_begin_direct(u32 asset_type_crc, u32 bytes_before_magic) {
+	return begin(asset_type_crc, bytes_before_magic, true);
+}
+
+static LumpHeader* add_lump_header(RA_DatWriter* writer, u32 type_crc, s64 size, u32* padding_size_dest) {
 	if(writer->write_string_called) {
 		fprintf(stderr, "RA_dat_writer_lump: Called after RA_dat_writer_string!\n");
 		abort();
 	}
+	*padding_size_dest = 0;
 	if(writer->lumps_size % 0x10 != 0) {
-		u32 padding_size = 0x10 - writer->lumps_size % 0x10;
-		if(RA_arena_alloc_aligned(&writer->lumps, padding_size, 1) == NULL) {
-			return NULL;
-		}
-		writer->lumps_size += padding_size;
+		*padding_size_dest = 0x10 - writer->lumps_size % 0x10;
 	}
-	LumpHeader* header = RA_arena_alloc_aligned(&writer->prologue, sizeof(LumpHeader), 1);
+	LumpHeader* header = RA_contiguous_arena_alloc_aligned(&writer->prologue, sizeof(LumpHeader), 1);
 	if(header == NULL) {
 		return NULL;
 	}
+	writer->lumps_size += *padding_size_dest;
 	header->type_crc = type_crc;
 	header->offset = writer->lumps_size;
 	header->size = size;
@@ -219,22 +308,226 @@ void* RA_dat_writer_lump(RA_DatWriter* writer, u32 type_crc, s64 size) {
 	writer->lumps_size += size;
 	writer->lump_count++;
 	writer->write_lump_called = true;
-	return RA_arena_alloc(&writer->lumps, size);
+	return header;
+}
+
+void* RA_dat_writer_lump(RA_DatWriter* writer, u32 type_crc, s64 size) {
+	if(writer->direct) {
+		fprintf(stderr, "RA_dat_writer_lump: Called on a direct writer!\n");
+		abort();
+	}
+	u32 padding_size;
+	if(add_lump_header(writer, type_crc, size, &padding_size) == NULL) {
+		return NULL;
+	}
+	if(padding_size > 0 && RA_contiguous_arena_alloc_aligned(&writer->lumps, padding_size, 1) == NULL) {
+		return NULL;
+	}
+	return RA_contiguous_arena_alloc(&writer->lumps, size);
+}
+
+s32 RA_dat_writer_declare_lump(RA_DatWriter* writer, u32 type_crc, s64 size) {
+	if(!writer->direct) {
+		fprintf(stderr, "RA_dat_writer_declare_lump: Called on a writer that isn't direct!\n");
+		abort();
+	}
+	u32 padding_size;
+	if(add_lump_header(writer, type_crc, size, &padding_size) == NULL) {
+		return -1;
+	}
+	return writer->lump_count - 1;
+}
+
+void RA_dat_writer_set_flags(RA_DatWriter* writer, u32 flags) {
+	if(writer->write_string_called) {
+		fprintf(stderr, "RA_dat_writer_set_flags: Called after RA_dat_writer_string!\n");
+		abort();
+	}
+	if(flags & RA_DAT_WRITER_MERGE_STRING_SUFFIXES) {
+		flags |= RA_DAT_WRITER_DEDUPLICATE_STRINGS;
+	}
+	writer->flags = flags;
+}
+
+static u64 hash_string(const char* string, u32 size) {
+	// FNV-1a.
+	u64 hash = 0xcbf29ce484222325;
+	for(u32 i = 0; i < size; i++) {
+		hash ^= (u8) string[i];
+		hash *= 0x100000001b3;
+	}
+	return hash;
+}
+
+static u32 lookup_string(RA_DatWriter* writer, const char* string, u32 size, u64 hash) {
+	if(writer->string_table_capacity == 0) {
+		return 0;
+	}
+	u32 mask = writer->string_table_capacity - 1;
+	for(u32 slot = hash & mask;; slot = (slot + 1) & mask) {
+		StringTableEntry* entry = &writer->string_table[slot];
+		if(entry->string == NULL) {
+			return 0;
+		}
+		if(entry->hash == hash && entry->size == size && memcmp(entry->string, string, size) == 0) {
+			return entry->offset;
+		}
+	}
+}
+
+static b8 insert_string(RA_DatWriter* writer, const char* string, u32 size, u64 hash, u32 offset) {
+	if((writer->string_table_count + 1) * 2 > writer->string_table_capacity) {
+		u32 new_capacity = MAX(writer->string_table_capacity * 2, 1024);
+		StringTableEntry* new_table = RA_calloc(new_capacity, sizeof(StringTableEntry));
+		if(new_table == NULL) {
+			return false;
+		}
+		for(u32 i = 0; i < writer->string_table_capacity; i++) {
+			StringTableEntry* entry = &writer->string_table[i];
+			if(entry->string != NULL) {
+				u32 slot = entry->hash & (new_capacity - 1);
+				while(new_table[slot].string != NULL) {
+					slot = (slot + 1) & (new_capacity - 1);
+				}
+				new_table[slot] = *entry;
+			}
+		}
+		if(writer->string_table) {
+			RA_free(writer->string_table);
+		}
+		writer->string_table = new_table;
+		writer->string_table_capacity = new_capacity;
+	}
+	u32 mask = writer->string_table_capacity - 1;
+	u32 slot = hash & mask;
+	while(writer->string_table[slot].string != NULL) {
+		slot = (slot + 1) & mask;
+	}
+	StringTableEntry* entry = &writer->string_table[slot];
+	entry->string = string;
+	entry->size = size;
+	entry->offset = offset;
+	entry->hash = hash;
+	writer->string_table_count++;
+	return true;
 }
 
 u32 RA_dat_writer_string(RA_DatWriter* writer, const char* string) {
 	u32 string_size = strlen(string) + 1;
-	char* allocation = RA_arena_alloc_aligned(&writer->prologue, string_size, 1);
-	if(allocation == NULL) {
-		return 0;
+	u64 hash = 0;
+	if(writer->flags & RA_DAT_WRITER_DEDUPLICATE_STRINGS) {
+		hash = hash_string(string, string_size);
+		u32 existing_offset = lookup_string(writer, string, string_size, hash);
+		if(existing_offset != 0) {
+			writer->string_bytes_saved += string_size;
+			writer->write_string_called = true;
+			return existing_offset;
+		}
+	}
+	const char* stored_string;
+	if(writer->direct) {
+		if(writer->output != NULL) {
+			fprintf(stderr, "RA_dat_writer_string: Called after RA_dat_writer_allocate!\n");
+			abort();
+		}
+		// Don't copy the string yet, just remember where it is.
+		DirectString* reference = RA_arena_alloc(&writer->strings, sizeof(DirectString));
+		if(reference == NULL) {
+			return 0;
+		}
+		reference->string = string;
+		reference->size = string_size;
+		stored_string = string;
+	} else {
+		char* allocation = RA_contiguous_arena_alloc_aligned(&writer->prologue, string_size, 1);
+		if(allocation == NULL) {
+			return 0;
+		}
+		memcpy(allocation, string, string_size);
+		stored_string = allocation;
 	}
-	strcpy(allocation, string);
 	u32 offset = writer->prologue_size;
 	writer->prologue_size += string_size;
 	writer->write_string_called = true;
+	if(writer->flags & RA_DAT_WRITER_DEDUPLICATE_STRINGS) {
+		if(!insert_string(writer, stored_string, string_size, hash, offset)) {
+			return 0;
+		}
+	}
+	if(writer->flags & RA_DAT_WRITER_MERGE_STRING_SUFFIXES) {
+		// Make the parts of the path after each slash available to later
+		// strings. Shared prefixes aren't possible since the strings are null
+		// terminated.
+		for(u32 i = 0; i + 1 < string_size; i++) {
+			if(stored_string[i] == '/' || stored_string[i] == '\\') {
+				const char* suffix = stored_string + i + 1;
+				u32 suffix_size = string_size - i - 1;
+				u64 suffix_hash = hash_string(suffix, suffix_size);
+				if(lookup_string(writer, suffix, suffix_size, suffix_hash) == 0) {
+					if(!insert_string(writer, suffix, suffix_size, suffix_hash, offset + i + 1)) {
+						return 0;
+					}
+				}
+			}
+		}
+	}
 	return offset;
 }
 
+u32 RA_dat_writer_string_block(RA_DatWriter* writer, const char* data, u32 size) {
+	if(writer->direct) {
+		if(writer->output != NULL) {
+			fprintf(stderr, "RA_dat_writer_string_block: Called after RA_dat_writer_allocate!\n");
+			abort();
+		}
+		DirectString* reference = RA_arena_alloc(&writer->strings, sizeof(DirectString));
+		if(reference == NULL) {
+			return 0;
+		}
+		reference->string = data;
+		reference->size = size;
+	} else {
+		char* allocation = RA_contiguous_arena_alloc_aligned(&writer->prologue, size, 1);
+		if(allocation == NULL) {
+			return 0;
+		}
+		memcpy(allocation, data, size);
+	}
+	u32 offset = writer->prologue_size;
+	writer->prologue_size += size;
+	writer->write_string_called = true;
+	return offset;
+}
+
+u32 RA_dat_writer_next_string_offset(RA_DatWriter* writer) {
+	return writer->prologue_size;
+}
+
+u32 RA_dat_writer_string_bytes_saved(RA_DatWriter* writer) {
+	return writer->string_bytes_saved;
+}
+
+static u32 prologue_padding_size(RA_DatWriter* writer) {
+	if(writer->prologue_size % 0x10 != 0) {
+		return 0x10 - (writer->prologue_size - writer->bytes_before_magic) % 0x10;
+	}
+	return 0;
+}
+
+s64 RA_dat_writer_size(RA_DatWriter* writer) {
+	return writer->prologue_size + prologue_padding_size(writer) + writer->lumps_size;
+}
+
+static void destroy(RA_DatWriter* writer) {
+	RA_contiguous_arena_destroy(&writer->prologue);
+	RA_contiguous_arena_destroy(&writer->lumps);
+	RA_arena_destroy(&writer->strings);
+	if(writer->string_table) {
+		RA_free(writer->string_table);
+	}
+	RA_free(writer);
+}
+
 static int compare_lumps(const void* lhs, const void* rhs) {
 	u32 lhs_type = ((LumpHeader*) lhs)->type_crc;
 	u32 rhs_type = ((LumpHeader*) rhs)->type_crc;
@@ -247,47 +540,139 @@ static int compare_lumps(const void* lhs, const void* rhs) {
 	}
 }
 
+static void fill_in_header(RA_DatWriter* writer, u8* data, s64 size, u32 lumps_begin) {
+	DatHeader* header = (DatHeader*) (data + writer->bytes_before_magic);
+	header->magic = FOURCC("1TAD");
+	header->asset_type_crc = writer->asset_type_crc;
+	header->file_size = size - writer->bytes_before_magic;
+	header->lump_count = writer->lump_count;
+	header->shader_count = writer->shader_count;
+	for(u32 i = 0; i < header->lump_count; i++) {
+		header->lumps[i].offset += lumps_begin - writer->bytes_before_magic;
+	}
+	qsort(header->lumps, header->lump_count, sizeof(LumpHeader), compare_lumps);
+}
+
+RA_Result RA_dat_writer_allocate(RA_DatWriter* writer, u8* buffer) {
+	if(!writer->direct || writer->output != NULL) {
+		return RA_FAILURE("writer is not a direct writer or is already allocated");
+	}
+	
+	u32 strings_begin = writer->bytes_before_magic + sizeof(DatHeader) + writer->lump_count * sizeof(LumpHeader);
+	u32 strings_end = writer->prologue_size;
+	u32 lumps_begin = writer->prologue_size + prologue_padding_size(writer);
+	s64 size = RA_dat_writer_size(writer);
+	
+	// Zero everything up front so that the padding and any lumps that the
+	// caller doesn't fill in are deterministic.
+	if(buffer == NULL) {
+		buffer = RA_calloc(1, size);
+		if(buffer == NULL) {
+			return RA_FAILURE("cannot allocate output");
+		}
+		writer->owns_output = true;
+	} else {
+		memset(buffer, 0, size);
+	}
+	
+	// Copy in the headers.
+	if(writer->prologue.top < strings_begin) {
+		if(writer->owns_output) {
+			RA_free(buffer);
+		}
+		return RA_FAILURE("prologue size mismatch");
+	}
+	memcpy(buffer, writer->prologue.data, strings_begin);
+	memset(buffer, 0, writer->bytes_before_magic + sizeof(DatHeader));
+	
+	// Remember where the lumps are before the headers get sorted. The lumps
+	// arena is otherwise unused in direct mode.
+	DatHeader* header = (DatHeader*) (buffer + writer->bytes_before_magic);
+	writer->lump_offsets = RA_contiguous_arena_alloc(&writer->lumps, writer->lump_count * sizeof(u32));
+	if(writer->lump_offsets == NULL) {
+		if(writer->owns_output) {
+			RA_free(buffer);
+		}
+		return RA_FAILURE("cannot allocate lump offsets");
+	}
+	for(u32 i = 0; i < writer->lump_count; i++) {
+		writer->lump_offsets[i] = lumps_begin + header->lumps[i].offset;
+	}
+	
+	// Copy in the strings.
+	u8* string_dest = buffer + strings_begin;
+	for(RA_ArenaBlock* block = writer->strings.head; block != NULL; block = block->next) {
+		DirectString* strings = (DirectString*) block->data;
+		for(u64 i = 0; i < block->top / sizeof(DirectString); i++) {
+			memcpy(string_dest, strings[i].string, strings[i].size);
+			string_dest += strings[i].size;
+		}
+		if(block == writer->strings.tail) {
+			break;
+		}
+	}
+	if(string_dest != buffer + strings_end) {
+		if(writer->owns_output) {
+			RA_free(buffer);
+		}
+		return RA_FAILURE("strings size mismatch");
+	}
+	
+	fill_in_header(writer, buffer, size, lumps_begin);
+	
+	writer->output = buffer;
+	return RA_SUCCESS;
+}
+
+void* RA_dat_writer_lump_data(RA_DatWriter* writer, s32 lump) {
+	if(writer->output == NULL || lump < 0 || lump >= writer->lump_count) {
+		return NULL;
+	}
+	return writer->output + writer->lump_offsets[lump];
+}
+
 RA_Result RA_dat_writer_finish(RA_DatWriter* writer, u8** data_dest, s64* size_dest) {
-	if(writer->prologue_size % 0x10 != 0) {
-		u32 padding_size = 0x10 - (writer->prologue_size - writer->bytes_before_magic) % 0x10;
-		if(RA_arena_alloc_aligned(&writer->prologue, padding_size, 1) == NULL) {
+	if(writer->direct) {
+		if(writer->output == NULL) {
+			return RA_FAILURE("RA_dat_writer_allocate not called");
+		}
+		*data_dest = writer->output;
+		*size_dest = RA_dat_writer_size(writer);
+		destroy(writer);
+		return RA_SUCCESS;
+	}
+	
+	u32 padding_size = prologue_padding_size(writer);
+	if(padding_size > 0) {
+		if(RA_contiguous_arena_alloc_aligned(&writer->prologue, padding_size, 1) == NULL) {
 			return RA_FAILURE("cannot allocate padding");
 		}
 		writer->prologue_size += padding_size;
 	}
+	if(writer->prologue.top != writer->prologue_size) {
+		return RA_FAILURE("prologue size mismatch (%u, expected %u)", (u32) writer->prologue.top, writer->prologue_size);
+	}
+	if(writer->lumps.top != writer->lumps_size) {
+		return RA_FAILURE("lump size mismatch (%u, expected %u)", (u32) writer->lumps.top, writer->lumps_size);
+	}
 	*size_dest = writer->prologue_size + writer->lumps_size;
 	*data_dest = RA_malloc(*size_dest);
 	if(*data_dest == NULL) {
 		return RA_FAILURE("cannot allocate output");
 	}
-	s64 prologue_size = RA_arena_copy(&writer->prologue, *data_dest, *size_dest);
-	if(prologue_size != writer->prologue_size) {
-		return RA_FAILURE("prologue size mismatch (%u, expected %u)", (u32) prologue_size, writer->prologue_size);
-	}
-	s64 lumps_size = RA_arena_copy(&writer->lumps, *data_dest + prologue_size, *size_dest - prologue_size);
-	if(lumps_size != writer->lumps_size) {
-		return RA_FAILURE("lump size mismatch (%u, expected %u)", (u32) lumps_size, writer->lumps_size);
-	}
-	RA_arena_destroy(&writer->prologue);
-	RA_arena_destroy(&writer->lumps);
-	DatHeader* header = (DatHeader*) (*data_dest + writer->bytes_before_magic);
-	header->magic = FOURCC("1TAD");
-	header->asset_type_crc = writer->asset_type_crc;
-	header->file_size = *size_dest - writer->bytes_before_magic;
-	header->lump_count = writer->lump_count;
-	header->shader_count = writer->shader_count;
-	for(u32 i = 0; i < header->lump_count; i++) {
-		header->lumps[i].offset += writer->prologue_size - writer->bytes_before_magic;
-	}
-	qsort(header->lumps, header->lump_count, sizeof(LumpHeader), compare_lumps);
-	RA_free(writer);
+	// Both arenas are contiguous, so each one can be copied in one go.
+	memcpy(*data_dest, writer->prologue.data, writer->prologue_size);
+	memcpy(*data_dest + writer->prologue_size, writer->lumps.data, writer->lumps_size);
+	fill_in_header(writer, *data_dest, *size_dest, writer->prologue_size);
+	destroy(writer);
 	return RA_SUCCESS;
 }
 
 void RA_dat_writer_abort(RA_DatWriter* writer) {
-	RA_arena_destroy(&writer->prologue);
-	RA_arena_destroy(&writer->lumps);
-	RA_free(writer);
+	if(writer->owns_output) {
+		RA_free(writer->output);
+	}
+	destroy(writer);
 }
 
 // Lump type information
@@ -299,15 +684,41 @@ RA_LumpType lump_types[] = {
 };
 s32 lump_type_count = ARRAY_SIZE(lump_types);
 
-const char* RA_dat_lump_type_name(u32 type_crc) {
-	for(s32 i = 0; i < lump_type_count; i++) {
-		if(lump_types[i].crc == type_crc) {
-			return lump_types[i].name;
-		}
+// Perfect hash tables generated by genlumptypes, so each lookup only has to
+// check a single slot.
+#define LUMP_TYPE_CRC_HASH_TABLE(...) static const u8 lump_type_crc_hash_table[LUMP_TYPE_CRC_HASH_SIZE] = {__VA_ARGS__};
+#define LUMP_TYPE_NAME_HASH_TABLE(...) static const u8 lump_type_name_hash_table[LUMP_TYPE_NAME_HASH_SIZE] = {__VA_ARGS__};
+#include "lump_types_hash.h"
+#undef LUMP_TYPE_CRC_HASH_TABLE
+#undef LUMP_TYPE_NAME_HASH_TABLE
+
+RA_LumpType* RA_dat_lookup_lump_type(u32 type_crc) {
+	u32 slot = (u32) (type_crc * LUMP_TYPE_CRC_HASH_MULTIPLIER) >> LUMP_TYPE_CRC_HASH_SHIFT;
+	u8 index = lump_type_crc_hash_table[slot];
+	if(index < lump_type_count && lump_types[index].crc == type_crc) {
+		return &lump_types[index];
 	}
 	return NULL;
 }
 
+RA_LumpType* RA_dat_lookup_lump_type_by_name(const char* name) {
+	u32 name_crc = RA_crc32_string(name);
+	u32 slot = (u32) (name_crc * LUMP_TYPE_NAME_HASH_MULTIPLIER) >> LUMP_TYPE_NAME_HASH_SHIFT;
+	u8 index = lump_type_name_hash_table[slot];
+	if(index < lump_type_count && strcmp(lump_types[index].name, name) == 0) {
+		return &lump_types[index];
+	}
+	return NULL;
+}
+
+const char* RA_dat_lump_type_name(u32 type_crc) {
+	RA_LumpType* lump_type = RA_dat_lookup_lump_type(type_crc);
+	if(lump_type == NULL) {
+		return NULL;
+	}
+	return lump_type->name;
+}
+
 // Testing
 
 RA_Result RA_dat_test(const u8* original, u32 original_size, const u8* repacked, u32 repacked_size, b8 print_hex_dump_on_failure) {
@@ -342,13 +753,7 @@ RA_Result RA_dat_test(const u8* original, u32 original_size, const u8* repacked,
 		const u8* original_data = &original[original_lump->offset];
 		const u8* repacked_data = &repacked[repacked_lump->offset];
 		
-		RA_LumpType* lump_type = NULL;
-		for(u32 j = 0; j < lump_type_count; j++) {
-			if(lump_types[j].crc == original_lump->type_crc) {
-				lump_type = &lump_types[j];
-				break;
-			}
-		}
+		RA_LumpType* lump_type = RA_dat_lookup_lump_type(original_lump->type_crc);
 		
 		char context[256];
 		if(lump_type != NULL) {
@@ -33,6 +33,15 @@ RA_Result RA_dat_free(RA_DatFile* dat, ShouldFreeFileData free_file_data);
 
 RA_DatLump* RA_dat_lookup_lump(RA_DatFile* dat, u32 name_crc);
 
+// Find a single lump by only looking at the DAT header and lump headers, so
+// that it can be done on the start of a file without reading all of it. The
+// lump is checked against file_size, the size of the whole file, and its data
+// pointer is NULL unless it's inside the first size bytes.
+RA_Result RA_dat_peek_lump(RA_DatLump* dest, u8* data, u32 size, u32 file_size, u32 bytes_before_magic, u32 type_crc);
+
+// Enough for the DAT header and lump headers of any file that can be parsed.
+#define RA_DAT_MAX_HEADER_SIZE (0x10 + 1000 * 0xc)
+
 // Writer
 
 struct t_RA_DatWriter;
@@ -41,9 +50,32 @@ typedef struct t_RA_DatWriter RA_DatWriter;
 RA_DatWriter* RA_dat_writer_begin(u32 asset_type_crc, u32 bytes_before_magic);   // Begin writing. Call this first.
 void* RA_dat_writer_lump(RA_DatWriter* writer, u32 type_crc, s64 size);          // Allocate memory for a lump. Call this second.
 u32 RA_dat_writer_string(RA_DatWriter* writer, const char* string);              // Allocate a string. Call this third.
+u32 RA_dat_writer_string_block(RA_DatWriter* writer, const char* data, u32 size); // Copy already laid out strings verbatim. Never shared.
+u32 RA_dat_writer_next_string_offset(RA_DatWriter* writer);                       // Offset the next string will be written at.
 RA_Result RA_dat_writer_finish(RA_DatWriter* writer, u8** data_dest, s64* size_dest); // Finish writing, generate the output.
 void RA_dat_writer_abort(RA_DatWriter* writer);                                  // Finish writing, don't generate any output.
 
+// Optional string sharing. With RA_DAT_WRITER_DEDUPLICATE_STRINGS, writing a
+// string that has already been written returns the existing offset. With
+// RA_DAT_WRITER_MERGE_STRING_SUFFIXES, the part of a path after any slash can
+// also be shared with a later string that matches it exactly.
+typedef enum {
+	RA_DAT_WRITER_DEDUPLICATE_STRINGS = 1 << 0,
+	RA_DAT_WRITER_MERGE_STRING_SUFFIXES = 1 << 1
+} RA_DatWriterFlags;
+
+void RA_dat_writer_set_flags(RA_DatWriter* writer, u32 flags);                     // Call before writing any strings.
+u32 RA_dat_writer_string_bytes_saved(RA_DatWriter* writer);                        // Bytes not written due to string sharing.
+
+// Direct mode: Declare all the lumps and strings up front, then the output is
+// allocated once and the lumps are written into it in place. Strings passed to
+// RA_dat_writer_string aren't copied until RA_dat_writer_allocate is called.
+RA_DatWriter* RA_dat_writer_begin_direct(u32 asset_type_crc, u32 bytes_before_magic); // Begin writing. Call this first.
+s32 RA_dat_writer_declare_lump(RA_DatWriter* writer, u32 type_crc, s64 size);      // Declare a lump, returns its index. Call this second.
+s64 RA_dat_writer_size(RA_DatWriter* writer);                                      // Size of the output, once everything is declared.
+RA_Result RA_dat_writer_allocate(RA_DatWriter* writer, u8* buffer);                // Lay out the output into buffer (RA_malloc'd if NULL).
+void* RA_dat_writer_lump_data(RA_DatWriter* writer, s32 lump);                     // Get a pointer to a lump in the output.
+
 // Lump type information
 
 typedef enum {
@@ -68,6 +100,8 @@ enum RA_LumpName {
 };
 
 void RA_dat_get_lump_types(RA_LumpType** lump_types_dest, s32* lump_type_count_dest);
+RA_LumpType* RA_dat_lookup_lump_type(u32 type_crc);
+RA_LumpType* RA_dat_lookup_lump_type_by_name(const char* name);
 const char* RA_dat_lump_type_name(u32 type_crc);
 
 // Testing
@@ -1,6 +1,11 @@
 #include "dependency_dag.h"
 
 #include "dat_container.h"
+#include "platform.h"
+
+static void hash_asset_names(u32 begin, u32 end, void* user);
+static void insert_into_lookup_table(RA_DependencyDag* dag, u32 index);
+static void remove_from_lookup_table(RA_DependencyDag* dag, u32 index);
 
 RA_Result RA_dag_parse(RA_DependencyDag* dag, u8* data, u32 size) {
 	RA_Result result;
@@ -63,6 +68,7 @@ RA_Result RA_dag_parse(RA_DependencyDag* dag, u8* data, u32 size) {
 	
 	dag->assets = RA_arena_calloc(&dag->arena, asset_count, sizeof(RA_DependencyDagAsset));
 	dag->asset_count = asset_count;
+	dag->asset_capacity = asset_count;
 	if(dag->assets == NULL) {
 		error = "cannot allocate asset list";
 		goto fail;
@@ -71,7 +77,6 @@ RA_Result RA_dag_parse(RA_DependencyDag* dag, u8* data, u32 size) {
 	for(u32 i = 0; i < asset_count; i++) {
 		dag->assets[i].id = ((u64*) asset_ids->data)[i];
 		dag->assets[i].name = (char*) (data + sizeof(RA_DependencyDagFileHeader) + ((u32*) asset_names->data)[i]);
-		dag->assets[i].name_crc = RA_crc64_path(dag->assets[i].name);
 		dag->assets[i].type = asset_types->data[i];
 		
 		s32 dependency_list_index = ((u32*) dependency_index->data)[i];
@@ -93,16 +98,125 @@ RA_Result RA_dag_parse(RA_DependencyDag* dag, u8* data, u32 size) {
 		}
 	}
 	
+	// Hashing the names dominates the time spent parsing, so do it in parallel.
+	RA_parallel_for(dag->asset_count, 16 * 1024, hash_asset_names, dag);
+	
+	if((result = RA_dag_build_lookup_table(dag)) != RA_SUCCESS) {
+		error = result->message;
+		goto fail;
+	}
+	
 	RA_dat_free(&dat, DONT_FREE_FILE_DATA);
 	return RA_SUCCESS;
 	
 fail:
 	RA_dat_free(&dat, DONT_FREE_FILE_DATA);
-	RA_arena_destroy(&dat.arena);
+	RA_arena_destroy(&dag->arena);
 	return RA_FAILURE(error);
 }
 
-RA_Result RA_dag_build(RA_DependencyDag* dag, u8** data_dest, s64* size_dest) {
+static void hash_asset_names(u32 begin, u32 end, void* user) {
+	RA_DependencyDag* dag = user;
+	for(u32 i = begin; i < end; i++) {
+		dag->assets[i].name_crc = RA_crc64_path(dag->assets[i].name);
+	}
+}
+
+RA_Result RA_dag_view(RA_DependencyDagView* view, u8* data, u32 size) {
+	RA_Result result;
+	
+	memset(view, 0, sizeof(RA_DependencyDagView));
+	
+	RA_DatFile dat;
+	if((result = RA_dat_parse(&dat, data, size, sizeof(RA_DependencyDagFileHeader))) != RA_SUCCESS) {
+		return result;
+	}
+	
+	// The lumps point into the file data, so the DAT file can be freed once
+	// the view has been filled in. The lump structs themselves can't be used
+	// after that though.
+	RA_DatLump* asset_ids = RA_dat_lookup_lump(&dat, LUMP_ASSET_IDS);
+	RA_DatLump* asset_names = RA_dat_lookup_lump(&dat, LUMP_ASSET_NAMES);
+	RA_DatLump* asset_types = RA_dat_lookup_lump(&dat, LUMP_ASSET_TYPES);
+	RA_DatLump* dependency_index = RA_dat_lookup_lump(&dat, LUMP_DEPENDENCY_LINKS_HEADS);
+	RA_DatLump* dependency = RA_dat_lookup_lump(&dat, LUMP_DEPENDENCY_LINKS);
+	
+	if(asset_ids == NULL || asset_names == NULL || asset_types == NULL || dependency_index == NULL || dependency == NULL) {
+		RA_dat_free(&dat, DONT_FREE_FILE_DATA);
+		return RA_FAILURE("missing lumps");
+	}
+	
+	u32 asset_count = asset_types->size;
+	if(asset_ids->size / 8 != asset_count || asset_names->size / 4 != asset_count || dependency_index->size / 4 != asset_count) {
+		RA_dat_free(&dat, DONT_FREE_FILE_DATA);
+		return RA_FAILURE("asset names or asset ids lump has bad size");
+	}
+	
+	view->file_data = data;
+	view->file_size = size;
+	view->asset_count = asset_count;
+	view->ids = (u64*) asset_ids->data;
+	view->name_offsets = (u32*) asset_names->data;
+	view->types = asset_types->data;
+	view->dependency_heads = (s32*) dependency_index->data;
+	view->dependencies = (s32*) dependency->data;
+	view->dependencies_count = dependency->size / 4;
+	
+	RA_dat_free(&dat, DONT_FREE_FILE_DATA);
+	return RA_SUCCESS;
+}
+
+const char* RA_dag_view_name(RA_DependencyDagView* view, u32 asset_index) {
+	if(asset_index >= view->asset_count) {
+		return NULL;
+	}
+	u32 offset = view->name_offsets[asset_index];
+	if(offset >= view->file_size - sizeof(RA_DependencyDagFileHeader)) {
+		return NULL;
+	}
+	// Make sure the name is terminated before the end of the file.
+	const char* name = (const char*) (view->file_data + sizeof(RA_DependencyDagFileHeader) + offset);
+	if(memchr(name, '\0', view->file_size - sizeof(RA_DependencyDagFileHeader) - offset) == NULL) {
+		return NULL;
+	}
+	return name;
+}
+
+u64 RA_dag_view_name_crc(RA_DependencyDagView* view, u32 asset_index) {
+	const char* name = RA_dag_view_name(view, asset_index);
+	if(name == NULL) {
+		return 0;
+	}
+	return RA_crc64_path(name);
+}
+
+s32* RA_dag_view_dependencies(RA_DependencyDagView* view, u32 asset_index, u32* count_dest) {
+	*count_dest = 0;
+	if(asset_index >= view->asset_count) {
+		return NULL;
+	}
+	s32 head = view->dependency_heads[asset_index];
+	if(head < 0 || (u32) head >= view->dependencies_count) {
+		return NULL;
+	}
+	s32* dependencies = &view->dependencies[head];
+	u32 max_count = view->dependencies_count - (u32) head;
+	while(*count_dest < max_count && dependencies[*count_dest] > -1) {
+		(*count_dest)++;
+	}
+	return dependencies;
+}
+
+s32 RA_dag_view_find_id(RA_DependencyDagView* view, u64 id) {
+	for(u32 i = 0; i < view->asset_count; i++) {
+		if(view->ids[i] == id) {
+			return (s32) i;
+		}
+	}
+	return -1;
+}
+
+RA_Result RA_dag_build(RA_DependencyDag* dag, u8** data_dest, s64* size_dest, u32 writer_flags, u32* string_bytes_saved_dest) {
 	RA_Result result;
 	
 	u32 dependency_count = 0;
@@ -112,44 +226,85 @@ RA_Result RA_dag_build(RA_DependencyDag* dag, u8** data_dest, s64* size_dest) {
 		}
 	}
 	
-	RA_DatWriter* writer = RA_dat_writer_begin(RA_ASSET_TYPE_DAG, 0xc);
+	RA_DatWriter* writer = RA_dat_writer_begin_direct(RA_ASSET_TYPE_DAG, 0xc);
 	if(writer == NULL) {
 		return RA_FAILURE("cannot allocate dat writer");
 	}
+	RA_dat_writer_set_flags(writer, writer_flags);
 	
-	u64* asset_ids = RA_dat_writer_lump(writer, LUMP_ASSET_IDS, dag->asset_count * 8);
-	u32* names = RA_dat_writer_lump(writer, LUMP_ASSET_NAMES, dag->asset_count * 4);
-	u8* asset_types = RA_dat_writer_lump(writer, LUMP_ASSET_TYPES, dag->asset_count);
-	u32* dependency_indices = RA_dat_writer_lump(writer, LUMP_DEPENDENCY_LINKS_HEADS, dag->asset_count * 4);
-	s32* dependency = RA_dat_writer_lump(writer, LUMP_DEPENDENCY_LINKS, dependency_count * 4);
-	u32* unk = RA_dat_writer_lump(writer, LUMP_DAG_UNKNOWN, 1);
+	s32 asset_ids_lump = RA_dat_writer_declare_lump(writer, LUMP_ASSET_IDS, dag->asset_count * 8);
+	s32 names_lump = RA_dat_writer_declare_lump(writer, LUMP_ASSET_NAMES, dag->asset_count * 4);
+	s32 asset_types_lump = RA_dat_writer_declare_lump(writer, LUMP_ASSET_TYPES, dag->asset_count);
+	s32 dependency_indices_lump = RA_dat_writer_declare_lump(writer, LUMP_DEPENDENCY_LINKS_HEADS, dag->asset_count * 4);
+	s32 dependency_lump = RA_dat_writer_declare_lump(writer, LUMP_DEPENDENCY_LINKS, dependency_count * 4);
+	s32 unk_lump = RA_dat_writer_declare_lump(writer, LUMP_DAG_UNKNOWN, 1);
 	u32 dependency_dag_string_offset = RA_dat_writer_string(writer, "DependencyDAG");
 	
-	b8 allocation_failed =
-		asset_ids == NULL ||
-		names == NULL ||
-		asset_types == NULL ||
-		dependency_indices == NULL ||
-		dependency == NULL ||
-		unk == NULL ||
+	b8 declaration_failed =
+		asset_ids_lump < 0 ||
+		names_lump < 0 ||
+		asset_types_lump < 0 ||
+		dependency_indices_lump < 0 ||
+		dependency_lump < 0 ||
+		unk_lump < 0 ||
 		dependency_dag_string_offset == 0;
-	if(allocation_failed) {
+	if(declaration_failed) {
 		RA_dat_writer_abort(writer);
-		return RA_FAILURE("cannot allocate lumps");
+		return RA_FAILURE("cannot declare lumps");
 	}
 	
+	// The name offsets are only known once all the strings have been declared,
+	// which has to happen before the output buffer is allocated.
+	u32* name_offsets = RA_malloc(dag->asset_count * sizeof(u32));
+	if(name_offsets == NULL) {
+		RA_dat_writer_abort(writer);
+		return RA_FAILURE("cannot allocate name offsets");
+	}
+	for(u32 i = 0; i < dag->asset_count; i++) {
+		name_offsets[i] = RA_dat_writer_string(writer, dag->assets[i].name);
+		if(name_offsets[i] == 0) {
+			RA_free(name_offsets);
+			RA_dat_writer_abort(writer);
+			return RA_FAILURE("cannot allocate string");
+		}
+	}
+	
+	if((result = RA_dat_writer_allocate(writer, NULL)) != RA_SUCCESS) {
+		RA_free(name_offsets);
+		RA_dat_writer_abort(writer);
+		return RA_FAILURE(result->message);
+	}
+	
+	u64* asset_ids = RA_dat_writer_lump_data(writer, asset_ids_lump);
+	u32* names = RA_dat_writer_lump_data(writer, names_lump);
+	u8* asset_types = RA_dat_writer_lump_data(writer, asset_types_lump);
+	s32* dependency_indices = RA_dat_writer_lump_data(writer, dependency_indices_lump);
+	s32* dependency = RA_dat_writer_lump_data(writer, dependency_lump);
+	
+	// Name offsets are relative to the start of the DAT header, which is how
+	// RA_dag_parse reads them.
+	s32 dependency_index = 0;
 	for(u32 i = 0; i < dag->asset_count; i++) {
 		asset_types[i] = dag->assets[i].type;
 		asset_ids[i] = dag->assets[i].id;
-		names[i] = RA_dat_writer_string(writer, dag->assets[i].name);
+		names[i] = name_offsets[i] - sizeof(RA_DependencyDagFileHeader);
 		if(dag->assets[i].dependency_count > 0) {
+			dependency_indices[i] = dependency_index;
 			for(u32 j = 0; j < dag->assets[i].dependency_count; j++) {
-				(*dependency++) = dag->assets[i].dependencies[j];
+				dependency[dependency_index++] = dag->assets[i].dependencies[j];
 			}
-			(*dependency++) = -1;
+			dependency[dependency_index++] = -1;
+		} else {
+			dependency_indices[i] = -1;
 		}
 	}
 	
+	RA_free(name_offsets);
+	
+	if(string_bytes_saved_dest) {
+		*string_bytes_saved_dest = RA_dat_writer_string_bytes_saved(writer);
+	}
+	
 	if((result = RA_dat_writer_finish(writer, data_dest, size_dest)) != RA_SUCCESS) {
 		RA_dat_writer_abort(writer);
 		return RA_FAILURE(result->message);
@@ -165,25 +320,599 @@ void RA_dag_free(RA_DependencyDag* dag, b8 free_file_data) {
 	}
 }
 
+RA_Result RA_dag_build_lookup_table(RA_DependencyDag* dag) {
+	u32 capacity = 16;
+	while(capacity < dag->asset_count * 2) {
+		capacity *= 2;
+	}
+	
+	u32* table = RA_arena_alloc(&dag->arena, capacity * sizeof(u32));
+	if(table == NULL) {
+		return RA_FAILURE("cannot allocate lookup table");
+	}
+	memset(table, 0xff, capacity * sizeof(u32));
+	
+	dag->lookup_table = table;
+	dag->lookup_table_capacity = capacity;
+	
+	for(u32 i = 0; i < dag->asset_count; i++) {
+		insert_into_lookup_table(dag, i);
+	}
+	
+	return RA_SUCCESS;
+}
+
+// Every asset gets its own slot. Assets with the same name are kept in index
+// order along the probe sequence, so that lookups find the first one.
+static void insert_into_lookup_table(RA_DependencyDag* dag, u32 index) {
+	u64 name_crc = dag->assets[index].name_crc;
+	u32 mask = dag->lookup_table_capacity - 1;
+	u32 slot = (u32) name_crc & mask;
+	while(dag->lookup_table[slot] != UINT32_MAX) {
+		u32 other = dag->lookup_table[slot];
+		if(other > index && dag->assets[other].name_crc == name_crc) {
+			dag->lookup_table[slot] = index;
+			index = other;
+		}
+		slot = (slot + 1) & mask;
+	}
+	dag->lookup_table[slot] = index;
+}
+
+// Backward shift deletion, so that no tombstones are left behind. Must be
+// called before the asset's name CRC changes.
+static void remove_from_lookup_table(RA_DependencyDag* dag, u32 index) {
+	u32 mask = dag->lookup_table_capacity - 1;
+	u32 hole = (u32) dag->assets[index].name_crc & mask;
+	while(dag->lookup_table[hole] != index) {
+		if(dag->lookup_table[hole] == UINT32_MAX) {
+			return;
+		}
+		hole = (hole + 1) & mask;
+	}
+	
+	// Move back any entries after the hole that would otherwise become
+	// unreachable, i.e. ones whose home slot isn't between the hole and them.
+	for(u32 slot = (hole + 1) & mask; dag->lookup_table[slot] != UINT32_MAX; slot = (slot + 1) & mask) {
+		u32 home = (u32) dag->assets[dag->lookup_table[slot]].name_crc & mask;
+		if(((slot - home) & mask) >= ((slot - hole) & mask)) {
+			dag->lookup_table[hole] = dag->lookup_table[slot];
+			hole = slot;
+		}
+	}
+	dag->lookup_table[hole] = UINT32_MAX;
+}
+
 RA_DependencyDagAsset* RA_dag_lookup_asset(RA_DependencyDag* dag, u64 name_crc) {
-	if(dag->asset_count == 0) {
+	if(dag->lookup_table == NULL) {
+		// The DAG was built by hand, so fall back to a linear search.
+		for(u32 i = 0; i < dag->asset_count; i++) {
+			if(dag->assets[i].name_crc == name_crc) {
+				return &dag->assets[i];
+			}
+		}
 		return NULL;
 	}
 	
-	s64 first = 0;
-	s64 last = dag->asset_count - 1;
-	
-	while(first <= last) {
-		s64 mid = (first + last) / 2;
-		RA_DependencyDagAsset* asset = &dag->assets[mid];
-		if(asset->name_crc < name_crc) {
-			first = mid + 1;
-		} else if(asset->name_crc > name_crc) {
-			last = mid - 1;
-		} else {
+	u32 mask = dag->lookup_table_capacity - 1;
+	for(u32 slot = (u32) name_crc & mask; dag->lookup_table[slot] != UINT32_MAX; slot = (slot + 1) & mask) {
+		RA_DependencyDagAsset* asset = &dag->assets[dag->lookup_table[slot]];
+		if(asset->name_crc == name_crc) {
 			return asset;
 		}
 	}
 	
 	return NULL;
 }
+
+RA_Result RA_dag_build_reverse_index(RA_DependencyDag* dag) {
+	u32* offsets = RA_arena_calloc(&dag->arena, dag->asset_count + 1, sizeof(u32));
+	if(offsets == NULL) {
+		return RA_FAILURE("cannot allocate dependent offsets");
+	}
+	
+	// Count the dependents of each asset, then turn the counts into offsets.
+	u32 edge_count = 0;
+	for(u32 i = 0; i < dag->asset_count; i++) {
+		for(u32 j = 0; j < dag->assets[i].dependency_count; j++) {
+			offsets[dag->assets[i].dependencies[j] + 1]++;
+		}
+		edge_count += dag->assets[i].dependency_count;
+	}
+	for(u32 i = 0; i < dag->asset_count; i++) {
+		offsets[i + 1] += offsets[i];
+	}
+	
+	s32* dependents = RA_arena_alloc(&dag->arena, edge_count * sizeof(s32));
+	if(dependents == NULL) {
+		return RA_FAILURE("cannot allocate dependents");
+	}
+	
+	// Fill in the dependents, using the offsets as write cursors. Each cursor
+	// ends up at the start of the next asset's list, so shift them back after.
+	for(u32 i = 0; i < dag->asset_count; i++) {
+		for(u32 j = 0; j < dag->assets[i].dependency_count; j++) {
+			dependents[offsets[dag->assets[i].dependencies[j]]++] = (s32) i;
+		}
+	}
+	for(u32 i = dag->asset_count; i > 0; i--) {
+		offsets[i] = offsets[i - 1];
+	}
+	offsets[0] = 0;
+	
+	dag->dependent_offsets = offsets;
+	dag->dependents = dependents;
+	
+	return RA_SUCCESS;
+}
+
+s32* RA_dag_lookup_dependents(RA_DependencyDag* dag, u32 asset_index, u32* count_dest) {
+	if(dag->dependent_offsets == NULL || asset_index >= dag->asset_count) {
+		*count_dest = 0;
+		return NULL;
+	}
+	
+	u32 begin = dag->dependent_offsets[asset_index];
+	*count_dest = dag->dependent_offsets[asset_index + 1] - begin;
+	return &dag->dependents[begin];
+}
+
+// Frontiers bigger than this are expanded in parallel.
+#define PARALLEL_FRONTIER_SIZE (16 * 1024)
+
+typedef struct {
+	RA_DependencyDag* dag;
+	u64* bitset;
+	const s32* frontier;
+	s32* next_frontier;
+	u32 next_frontier_size;
+} ReachableLevel;
+
+static void expand_frontier(u32 begin, u32 end, void* user) {
+	ReachableLevel* level = user;
+	for(u32 i = begin; i < end; i++) {
+		RA_DependencyDagAsset* asset = &level->dag->assets[level->frontier[i]];
+		for(u32 j = 0; j < asset->dependency_count; j++) {
+			s32 dependency = asset->dependencies[j];
+			u64 bit = (u64) 1 << (dependency % 64);
+			if(level->bitset[dependency / 64] & bit) {
+				continue;
+			}
+			// Only the thread that actually sets the bit adds the asset to the
+			// next frontier.
+			if((RA_atomic_fetch_or_u64(&level->bitset[dependency / 64], bit) & bit) == 0) {
+				u32 index = RA_atomic_fetch_add_u32(&level->next_frontier_size, 1);
+				level->next_frontier[index] = dependency;
+			}
+		}
+	}
+}
+
+RA_Result RA_dag_reachable(RA_DependencyDag* dag, const s32* roots, u32 root_count, u64* bitset_dest) {
+	memset(bitset_dest, 0, RA_DAG_BITSET_SIZE(dag->asset_count) * sizeof(u64));
+	
+	// Each asset is added to a frontier at most once, so they can't overflow.
+	s32* frontier = RA_malloc(dag->asset_count * sizeof(s32));
+	s32* next_frontier = RA_malloc(dag->asset_count * sizeof(s32));
+	if(frontier == NULL || next_frontier == NULL) {
+		if(frontier) {
+			RA_free(frontier);
+		}
+		if(next_frontier) {
+			RA_free(next_frontier);
+		}
+		return RA_FAILURE("cannot allocate frontier");
+	}
+	
+	u32 frontier_size = 0;
+	for(u32 i = 0; i < root_count; i++) {
+		if(roots[i] < 0 || roots[i] >= dag->asset_count) {
+			RA_free(frontier);
+			RA_free(next_frontier);
+			return RA_FAILURE("root out of range");
+		}
+		u64 bit = (u64) 1 << (roots[i] % 64);
+		if((bitset_dest[roots[i] / 64] & bit) == 0) {
+			bitset_dest[roots[i] / 64] |= bit;
+			frontier[frontier_size++] = roots[i];
+		}
+	}
+	
+	while(frontier_size > 0) {
+		ReachableLevel level;
+		level.dag = dag;
+		level.bitset = bitset_dest;
+		level.frontier = frontier;
+		level.next_frontier = next_frontier;
+		level.next_frontier_size = 0;
+		if(frontier_size >= PARALLEL_FRONTIER_SIZE) {
+			RA_parallel_for(frontier_size, PARALLEL_FRONTIER_SIZE / 4, expand_frontier, &level);
+		} else {
+			expand_frontier(0, frontier_size, &level);
+		}
+		
+		s32* temp = frontier;
+		frontier = next_frontier;
+		next_frontier = temp;
+		frontier_size = level.next_frontier_size;
+	}
+	
+	RA_free(frontier);
+	RA_free(next_frontier);
+	
+	return RA_SUCCESS;
+}
+
+static void discard_reverse_index(RA_DependencyDag* dag) {
+	dag->dependent_offsets = NULL;
+	dag->dependents = NULL;
+}
+
+static char* copy_name(RA_DependencyDag* dag, const char* name) {
+	s64 size = strlen(name) + 1;
+	char* copy = RA_arena_alloc_aligned(&dag->arena, size, 1);
+	if(copy) {
+		memcpy(copy, name, size);
+	}
+	return copy;
+}
+
+RA_Result RA_dag_add_asset(RA_DependencyDag* dag, const char* name, u64 id, u8 type, s32* index_dest) {
+	RA_Result result;
+	
+	if(dag->asset_count >= dag->asset_capacity) {
+		u32 new_capacity = MAX(dag->asset_count * 2, 16);
+		RA_DependencyDagAsset* new_assets = RA_arena_calloc(&dag->arena, new_capacity, sizeof(RA_DependencyDagAsset));
+		if(new_assets == NULL) {
+			return RA_FAILURE("cannot allocate asset list");
+		}
+		if(dag->asset_count > 0) {
+			memcpy(new_assets, dag->assets, dag->asset_count * sizeof(RA_DependencyDagAsset));
+		}
+		dag->assets = new_assets;
+		dag->asset_capacity = new_capacity;
+	}
+	
+	char* name_copy = copy_name(dag, name);
+	if(name_copy == NULL) {
+		return RA_FAILURE("cannot allocate name");
+	}
+	
+	u32 index = dag->asset_count;
+	RA_DependencyDagAsset* asset = &dag->assets[index];
+	memset(asset, 0, sizeof(RA_DependencyDagAsset));
+	asset->id = id;
+	asset->name = name_copy;
+	asset->name_crc = RA_crc64_path(name_copy);
+	asset->type = type;
+	dag->asset_count++;
+	
+	if(dag->lookup_table) {
+		if(dag->asset_count * 2 > dag->lookup_table_capacity) {
+			if((result = RA_dag_build_lookup_table(dag)) != RA_SUCCESS) {
+				return result;
+			}
+		} else {
+			insert_into_lookup_table(dag, index);
+		}
+	}
+	
+	discard_reverse_index(dag);
+	
+	if(index_dest) {
+		*index_dest = (s32) index;
+	}
+	
+	return RA_SUCCESS;
+}
+
+RA_Result RA_dag_rename_asset(RA_DependencyDag* dag, s32 asset, const char* name) {
+	if(asset < 0 || asset >= dag->asset_count) {
+		return RA_FAILURE("asset index out of range");
+	}
+	
+	char* name_copy = copy_name(dag, name);
+	if(name_copy == NULL) {
+		return RA_FAILURE("cannot allocate name");
+	}
+	
+	if(dag->lookup_table) {
+		remove_from_lookup_table(dag, (u32) asset);
+	}
+	
+	dag->assets[asset].name = name_copy;
+	dag->assets[asset].name_crc = RA_crc64_path(name_copy);
+	
+	if(dag->lookup_table) {
+		insert_into_lookup_table(dag, (u32) asset);
+	}
+	
+	return RA_SUCCESS;
+}
+
+// Dependency lists that came from the file are copied into the arena before
+// they're modified.
+static RA_Result reserve_dependencies(RA_DependencyDag* dag, RA_DependencyDagAsset* asset, u32 capacity) {
+	if(asset->dependency_capacity >= capacity) {
+		return RA_SUCCESS;
+	}
+	
+	u32 new_capacity = MAX(MAX(asset->dependency_capacity * 2, capacity), 4);
+	s32* new_dependencies = RA_arena_alloc(&dag->arena, new_capacity * sizeof(s32));
+	if(new_dependencies == NULL) {
+		return RA_FAILURE("cannot allocate dependency list");
+	}
+	if(asset->dependency_count > 0) {
+		memcpy(new_dependencies, asset->dependencies, asset->dependency_count * sizeof(s32));
+	}
+	asset->dependencies = new_dependencies;
+	asset->dependency_capacity = new_capacity;
+	
+	return RA_SUCCESS;
+}
+
+RA_Result RA_dag_add_dependency(RA_DependencyDag* dag, s32 asset, s32 dependency) {
+	RA_Result result;
+	
+	if(asset < 0 || asset >= dag->asset_count || dependency < 0 || dependency >= dag->asset_count) {
+		return RA_FAILURE("asset index out of range");
+	}
+	if(asset == dependency) {
+		return RA_FAILURE("asset cannot depend on itself");
+	}
+	
+	RA_DependencyDagAsset* dependent = &dag->assets[asset];
+	for(u32 i = 0; i < dependent->dependency_count; i++) {
+		if(dependent->dependencies[i] == dependency) {
+			return RA_SUCCESS;
+		}
+	}
+	
+	if((result = reserve_dependencies(dag, dependent, dependent->dependency_count + 1)) != RA_SUCCESS) {
+		return result;
+	}
+	dependent->dependencies[dependent->dependency_count++] = dependency;
+	
+	discard_reverse_index(dag);
+	
+	return RA_SUCCESS;
+}
+
+RA_Result RA_dag_remove_dependency(RA_DependencyDag* dag, s32 asset, s32 dependency) {
+	RA_Result result;
+	
+	if(asset < 0 || asset >= dag->asset_count) {
+		return RA_FAILURE("asset index out of range");
+	}
+	
+	RA_DependencyDagAsset* dependent = &dag->assets[asset];
+	u32 index = 0;
+	while(index < dependent->dependency_count && dependent->dependencies[index] != dependency) {
+		index++;
+	}
+	if(index == dependent->dependency_count) {
+		return RA_FAILURE("asset %d does not depend on asset %d", asset, dependency);
+	}
+	
+	if((result = reserve_dependencies(dag, dependent, dependent->dependency_count)) != RA_SUCCESS) {
+		return result;
+	}
+	// Keep the remaining dependencies in order.
+	memmove(&dependent->dependencies[index], &dependent->dependencies[index + 1], (dependent->dependency_count - index - 1) * sizeof(s32));
+	dependent->dependency_count--;
+	
+	discard_reverse_index(dag);
+	
+	return RA_SUCCESS;
+}
+
+static b8 points_into(const void* pointer, const u8* data, u32 size) {
+	return (const u8*) pointer >= data && (const u8*) pointer < data + size;
+}
+
+// Anything that still points into the original file is unchanged.
+static b8 name_changed(RA_DependencyDag* dag, u32 index, u32 original_asset_count) {
+	return index >= original_asset_count || !points_into(dag->assets[index].name, dag->file_data, dag->file_size);
+}
+
+static b8 dependencies_changed(RA_DependencyDag* dag, u32 index, u32 original_asset_count, RA_DatLump* dependency) {
+	RA_DependencyDagAsset* asset = &dag->assets[index];
+	if(index >= original_asset_count) {
+		return true;
+	}
+	return asset->dependencies != NULL && !points_into(asset->dependencies, dependency->data, dependency->size);
+}
+
+RA_Result RA_dag_build_incremental(RA_DependencyDag* dag, u8** data_dest, s64* size_dest) {
+	RA_Result result;
+	
+	if(dag->file_data == NULL) {
+		return RA_FAILURE("no original file to reuse, use RA_dag_build instead");
+	}
+	
+	RA_DatFile dat;
+	if((result = RA_dat_parse(&dat, dag->file_data, dag->file_size, sizeof(RA_DependencyDagFileHeader))) != RA_SUCCESS) {
+		return result;
+	}
+	
+	RA_DatLump* dependency = RA_dat_lookup_lump(&dat, LUMP_DEPENDENCY_LINKS);
+	RA_DatLump* asset_types = RA_dat_lookup_lump(&dat, LUMP_ASSET_TYPES);
+	if(dependency == NULL || asset_types == NULL) {
+		RA_dat_free(&dat, DONT_FREE_FILE_DATA);
+		return RA_FAILURE("original file is missing lumps");
+	}
+	u32 original_asset_count = asset_types->size;
+	if(dag->asset_count < original_asset_count) {
+		RA_dat_free(&dat, DONT_FREE_FILE_DATA);
+		return RA_FAILURE("assets have been removed");
+	}
+	
+	RA_DatWriter* writer = RA_dat_writer_begin_direct(dat.asset_type_crc, sizeof(RA_DependencyDagFileHeader));
+	s32* lumps = RA_malloc(dat.lump_count * sizeof(s32));
+	u32* changed_names = RA_malloc(MAX(dag->asset_count, 1) * sizeof(u32));
+	u32* changed_dependencies = RA_malloc(MAX(dag->asset_count, 1) * sizeof(u32));
+	u32* name_offsets = RA_malloc(MAX(dag->asset_count, 1) * sizeof(u32));
+	if(writer == NULL || lumps == NULL || changed_names == NULL || changed_dependencies == NULL || name_offsets == NULL) {
+		result = RA_FAILURE("cannot allocate dat writer");
+		goto fail;
+	}
+	
+	// Work out which names and dependency lists have to be written out again,
+	// so that the rest of the assets don't need to be looked at after this.
+	u32 changed_name_count = 0;
+	u32 changed_dependency_count = 0;
+	u32 new_link_count = 0;
+	for(u32 i = 0; i < dag->asset_count; i++) {
+		if(name_changed(dag, i, original_asset_count)) {
+			changed_names[changed_name_count++] = i;
+		}
+		if(dependencies_changed(dag, i, original_asset_count, dependency)) {
+			changed_dependencies[changed_dependency_count++] = i;
+			if(dag->assets[i].dependency_count > 0) {
+				new_link_count += dag->assets[i].dependency_count + 1;
+			}
+		}
+	}
+	
+	// Declare the same lumps as the original file, so that the strings end up
+	// in the same place and the original name offsets are still valid.
+	u32 first_lump_offset = dag->file_size;
+	for(u32 i = 0; i < dat.lump_count; i++) {
+		RA_DatLump* lump = &dat.lumps[i];
+		s64 size = lump->size;
+		switch((u32) lump->type_crc) {
+			case LUMP_ASSET_IDS: size = dag->asset_count * 8; break;
+			case LUMP_ASSET_NAMES: size = dag->asset_count * 4; break;
+			case LUMP_ASSET_TYPES: size = dag->asset_count; break;
+			case LUMP_DEPENDENCY_LINKS_HEADS: size = dag->asset_count * 4; break;
+			case LUMP_DEPENDENCY_LINKS: size = lump->size + new_link_count * 4; break;
+		}
+		if((lumps[i] = RA_dat_writer_declare_lump(writer, lump->type_crc, size)) < 0) {
+			result = RA_FAILURE("cannot declare lumps");
+			goto fail;
+		}
+		first_lump_offset = MIN(first_lump_offset, (u32) (lump->data - dag->file_data));
+	}
+	
+	// Copy the original strings, then append the new names after them. Name
+	// offsets are relative to the start of the DAT header, which is how
+	// RA_dag_parse reads them.
+	u32 strings_begin = RA_dat_writer_next_string_offset(writer);
+	if(strings_begin > first_lump_offset) {
+		result = RA_FAILURE("original file has an unexpected layout");
+		goto fail;
+	}
+	if(first_lump_offset > strings_begin && RA_dat_writer_string_block(writer, (char*) dag->file_data + strings_begin, first_lump_offset - strings_begin) != strings_begin) {
+		result = RA_FAILURE("cannot allocate string");
+		goto fail;
+	}
+	for(u32 i = 0; i < changed_name_count; i++) {
+		u32 offset = RA_dat_writer_string(writer, dag->assets[changed_names[i]].name);
+		if(offset == 0) {
+			result = RA_FAILURE("cannot allocate string");
+			goto fail;
+		}
+		name_offsets[i] = offset - sizeof(RA_DependencyDagFileHeader);
+	}
+	
+	if((result = RA_dat_writer_allocate(writer, NULL)) != RA_SUCCESS) {
+		goto fail;
+	}
+	
+	for(u32 i = 0; i < dat.lump_count; i++) {
+		RA_DatLump* lump = &dat.lumps[i];
+		u8* lump_data = RA_dat_writer_lump_data(writer, lumps[i]);
+		switch((u32) lump->type_crc) {
+			case LUMP_ASSET_IDS: {
+				u64* ids = (u64*) lump_data;
+				memcpy(ids, lump->data, original_asset_count * 8);
+				for(u32 j = original_asset_count; j < dag->asset_count; j++) {
+					ids[j] = dag->assets[j].id;
+				}
+				break;
+			}
+			case LUMP_ASSET_NAMES: {
+				u32* names = (u32*) lump_data;
+				memcpy(names, lump->data, original_asset_count * 4);
+				for(u32 j = 0; j < changed_name_count; j++) {
+					names[changed_names[j]] = name_offsets[j];
+				}
+				break;
+			}
+			case LUMP_ASSET_TYPES: {
+				memcpy(lump_data, lump->data, original_asset_count);
+				for(u32 j = original_asset_count; j < dag->asset_count; j++) {
+					lump_data[j] = dag->assets[j].type;
+				}
+				break;
+			}
+			case LUMP_DEPENDENCY_LINKS_HEADS: {
+				s32* heads = (s32*) lump_data;
+				memcpy(heads, lump->data, original_asset_count * 4);
+				u32 tail = dependency->size / 4;
+				for(u32 j = 0; j < changed_dependency_count; j++) {
+					RA_DependencyDagAsset* asset = &dag->assets[changed_dependencies[j]];
+					if(asset->dependency_count > 0) {
+						heads[changed_dependencies[j]] = (s32) tail;
+						tail += asset->dependency_count + 1;
+					} else {
+						heads[changed_dependencies[j]] = -1;
+					}
+				}
+				break;
+			}
+			case LUMP_DEPENDENCY_LINKS: {
+				s32* links = (s32*) lump_data;
+				memcpy(links, lump->data, lump->size);
+				links += lump->size / 4;
+				for(u32 j = 0; j < changed_dependency_count; j++) {
+					RA_DependencyDagAsset* asset = &dag->assets[changed_dependencies[j]];
+					if(asset->dependency_count > 0) {
+						memcpy(links, asset->dependencies, asset->dependency_count * sizeof(s32));
+						links += asset->dependency_count;
+						*links++ = -1;
+					}
+				}
+				break;
+			}
+			default: {
+				memcpy(lump_data, lump->data, lump->size);
+			}
+		}
+	}
+	
+	RA_free(lumps);
+	RA_free(changed_names);
+	RA_free(changed_dependencies);
+	RA_free(name_offsets);
+	RA_dat_free(&dat, DONT_FREE_FILE_DATA);
+	
+	if((result = RA_dat_writer_finish(writer, data_dest, size_dest)) != RA_SUCCESS) {
+		RA_dat_writer_abort(writer);
+		return result;
+	}
+	
+	// Preserve the header that comes before the DAT data.
+	memcpy(*data_dest, dag->file_data, sizeof(RA_DependencyDagFileHeader));
+	
+	return RA_SUCCESS;
+	
+fail:
+	if(lumps) {
+		RA_free(lumps);
+	}
+	if(changed_names) {
+		RA_free(changed_names);
+	}
+	if(changed_dependencies) {
+		RA_free(changed_dependencies);
+	}
+	if(name_offsets) {
+		RA_free(name_offsets);
+	}
+	if(writer) {
+		RA_dat_writer_abort(writer);
+	}
+	RA_dat_free(&dat, DONT_FREE_FILE_DATA);
+	return result;
+}
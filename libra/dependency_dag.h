@@ -17,6 +17,7 @@ typedef struct {
 	u8 type;
 	s32* dependencies;
 	u32 dependency_count;
+	u32 dependency_capacity; // Zero unless the list has been copied into the arena to be edited.
 } RA_DependencyDagAsset;
 
 typedef struct {
@@ -26,12 +27,66 @@ typedef struct {
 	RA_DependencyDagFileHeader* header;
 	RA_DependencyDagAsset* assets;
 	u32 asset_count;
+	u32 asset_capacity;
+	u32* lookup_table; // Open addressing hash table of asset indices keyed by name_crc, UINT32_MAX for empty slots.
+	u32 lookup_table_capacity;
+	// Reverse dependencies in compressed sparse row form. The assets that
+	// depend on asset i are dependents[dependent_offsets[i]] up to
+	// dependents[dependent_offsets[i + 1]]. NULL until the index is built.
+	u32* dependent_offsets;
+	s32* dependents;
 } RA_DependencyDag;
 
 RA_Result RA_dag_parse(RA_DependencyDag* dag, u8* data, u32 size);
-RA_Result RA_dag_build(RA_DependencyDag* dag, u8** data_dest, s64* size_dest);
+RA_Result RA_dag_build(RA_DependencyDag* dag, u8** data_dest, s64* size_dest, u32 writer_flags, u32* string_bytes_saved_dest);
 void RA_dag_free(RA_DependencyDag* dag, b8 free_file_data);
 
-RA_DependencyDagAsset* RA_dag_lookup_asset(RA_DependencyDag* dag, u64 name_crc);
+RA_Result RA_dag_build_lookup_table(RA_DependencyDag* dag); // Called by RA_dag_parse. Call again if the assets are modified.
+RA_DependencyDagAsset* RA_dag_lookup_asset(RA_DependencyDag* dag, u64 name_crc); // Returns the first matching asset.
+RA_Result RA_dag_build_reverse_index(RA_DependencyDag* dag);
+s32* RA_dag_lookup_dependents(RA_DependencyDag* dag, u32 asset_index, u32* count_dest); // Requires the reverse index.
+
+// A lighter alternative to RA_dag_parse that reads straight out of the lumps
+// in the file data without allocating anything per asset. Names, name CRCs and
+// dependency lists are worked out when they're asked for, so this is better
+// for tools that only need to look at a few assets, or go through them once.
+typedef struct {
+	u8* file_data;
+	u32 file_size;
+	u32 asset_count;
+	u64* ids;
+	u32* name_offsets;
+	u8* types;
+	s32* dependency_heads;
+	s32* dependencies;
+	u32 dependencies_count; // Including the -1 terminators.
+} RA_DependencyDagView;
+
+RA_Result RA_dag_view(RA_DependencyDagView* view, u8* data, u32 size);
+const char* RA_dag_view_name(RA_DependencyDagView* view, u32 asset_index); // NULL if out of range.
+u64 RA_dag_view_name_crc(RA_DependencyDagView* view, u32 asset_index);
+s32* RA_dag_view_dependencies(RA_DependencyDagView* view, u32 asset_index, u32* count_dest);
+s32 RA_dag_view_find_id(RA_DependencyDagView* view, u64 id); // Linear search, -1 if not found.
+
+// Find all the assets that the roots depend on, directly or indirectly. The
+// roots themselves are included. The result is a bitset indexed by asset
+// index, which must have space for RA_DAG_BITSET_SIZE(dag->asset_count) u64s.
+#define RA_DAG_BITSET_SIZE(asset_count) (((asset_count) + 63) / 64)
+#define RA_DAG_BITSET_TEST(bitset, index) (((bitset)[(index) / 64] >> ((index) % 64)) & 1)
+RA_Result RA_dag_reachable(RA_DependencyDag* dag, const s32* roots, u32 root_count, u64* bitset_dest);
+
+// Editing. Assets can be added but not removed, so indices stay valid, but
+// RA_dag_add_asset may move the asset array. Any edit discards the reverse
+// index. The lookup table is kept up to date if there is one.
+RA_Result RA_dag_add_asset(RA_DependencyDag* dag, const char* name, u64 id, u8 type, s32* index_dest);
+RA_Result RA_dag_rename_asset(RA_DependencyDag* dag, s32 asset, const char* name);
+RA_Result RA_dag_add_dependency(RA_DependencyDag* dag, s32 asset, s32 dependency); // Does nothing if the dependency already exists.
+RA_Result RA_dag_remove_dependency(RA_DependencyDag* dag, s32 asset, s32 dependency);
+
+// Write out an edited DAG that was loaded with RA_dag_parse. The original
+// strings and dependency lists are copied over as they are, and only the names
+// and dependency lists that have changed are appended after them, so this is
+// much cheaper than RA_dag_build when only a few assets have been touched.
+RA_Result RA_dag_build_incremental(RA_DependencyDag* dag, u8** data_dest, s64* size_dest);
 
 #endif
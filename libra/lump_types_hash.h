@@ -0,0 +1,44 @@
+// This file is generated from lump_types.txt by genlumptypes.
+// Indices into the lump_types array, 0xff for empty slots.
+#define LUMP_TYPE_CRC_HASH_MULTIPLIER 0xbf0955a7u
+#define LUMP_TYPE_CRC_HASH_SHIFT 24
+#define LUMP_TYPE_CRC_HASH_SIZE 256
+LUMP_TYPE_CRC_HASH_TABLE(
+	0xff, 0x44, 0x4d, 0xff, 0xff, 0xff, 0xff, 0x07, 0xff, 0x45, 0xff, 0xff, 0x38, 0x12, 0xff, 0xff,
+	0x0a, 0x48, 0xff, 0xff, 0xff, 0x2d, 0xff, 0xff, 0xff, 0x0d, 0xff, 0xff, 0xff, 0xff, 0x11, 0x47,
+	0xff, 0xff, 0xff, 0xff, 0x26, 0xff, 0xff, 0x0f, 0xff, 0xff, 0x1c, 0xff, 0xff, 0xff, 0xff, 0x01,
+	0x4c, 0xff, 0x30, 0xff, 0xff, 0x43, 0xff, 0x3e, 0xff, 0xff, 0xff, 0xff, 0x20, 0xff, 0x17, 0xff,
+	0x15, 0xff, 0xff, 0xff, 0x42, 0xff, 0x2b, 0xff, 0xff, 0xff, 0x4a, 0xff, 0xff, 0xff, 0x27, 0x19,
+	0x16, 0xff, 0x18, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x10, 0xff, 0xff, 0xff, 0x03, 0xff,
+	0xff, 0xff, 0xff, 0xff, 0x36, 0xff, 0xff, 0x02, 0x37, 0xff, 0x49, 0x23, 0xff, 0x39, 0x31, 0x2c,
+	0xff, 0xff, 0xff, 0xff, 0x3b, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x33, 0xff, 0xff, 0xff,
+	0xff, 0x4b, 0xff, 0xff, 0xff, 0x21, 0xff, 0x1d, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x1a, 0xff,
+	0xff, 0x0b, 0xff, 0xff, 0x05, 0xff, 0x1e, 0x3c, 0xff, 0xff, 0xff, 0xff, 0xff, 0x2f, 0x0e, 0xff,
+	0x2e, 0xff, 0xff, 0xff, 0xff, 0xff, 0x46, 0xff, 0xff, 0x0c, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0x32, 0x1f, 0xff, 0xff, 0xff, 0x3a, 0xff, 0x04, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0x40, 0xff, 0xff, 0x25, 0x22, 0x29, 0xff, 0xff, 0x00, 0xff, 0xff, 0x09, 0x3f, 0x08, 0xff,
+	0xff, 0xff, 0xff, 0xff, 0xff, 0x34, 0xff, 0xff, 0x13, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0x24, 0xff, 0xff, 0xff, 0xff, 0x2a, 0xff, 0x3d, 0x14, 0x1b, 0x28, 0xff, 0xff, 0xff, 0x35,
+	0xff, 0xff, 0xff, 0x06, 0xff, 0x41, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff
+)
+#define LUMP_TYPE_NAME_HASH_MULTIPLIER 0xbf0955a7u
+#define LUMP_TYPE_NAME_HASH_SHIFT 24
+#define LUMP_TYPE_NAME_HASH_SIZE 256
+LUMP_TYPE_NAME_HASH_TABLE(
+	0xff, 0x44, 0x4d, 0xff, 0xff, 0xff, 0xff, 0x07, 0xff, 0xff, 0xff, 0xff, 0x38, 0x12, 0xff, 0xff,
+	0x0a, 0x48, 0xff, 0xff, 0xff, 0x2d, 0xff, 0xff, 0xff, 0x0d, 0xff, 0xff, 0xff, 0xff, 0x11, 0x47,
+	0xff, 0xff, 0xff, 0xff, 0x26, 0xff, 0xff, 0x0f, 0xff, 0xff, 0x1c, 0xff, 0xff, 0xff, 0xff, 0x01,
+	0x4c, 0xff, 0x30, 0xff, 0xff, 0x43, 0xff, 0x3e, 0xff, 0xff, 0xff, 0xff, 0x20, 0x45, 0x17, 0xff,
+	0x15, 0xff, 0xff, 0xff, 0x42, 0xff, 0x2b, 0xff, 0xff, 0xff, 0x4a, 0xff, 0xff, 0xff, 0x27, 0x19,
+	0x16, 0xff, 0x18, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x10, 0xff, 0xff, 0xff, 0x03, 0xff,
+	0xff, 0xff, 0xff, 0xff, 0x36, 0xff, 0xff, 0x02, 0x37, 0xff, 0x49, 0x23, 0xff, 0x39, 0x31, 0x2c,
+	0xff, 0xff, 0xff, 0xff, 0x3b, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x33, 0xff, 0xff, 0xff,
+	0xff, 0x4b, 0xff, 0xff, 0xff, 0x21, 0xff, 0x1d, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x1a, 0xff,
+	0xff, 0x0b, 0xff, 0xff, 0x05, 0xff, 0x1e, 0x3c, 0xff, 0xff, 0xff, 0xff, 0xff, 0x2f, 0x0e, 0xff,
+	0x2e, 0xff, 0xff, 0xff, 0xff, 0xff, 0x46, 0xff, 0xff, 0x0c, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0x32, 0x1f, 0xff, 0xff, 0xff, 0x3a, 0xff, 0x04, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0x40, 0xff, 0xff, 0x25, 0x22, 0x29, 0xff, 0xff, 0x00, 0xff, 0xff, 0x09, 0x3f, 0x08, 0xff,
+	0xff, 0xff, 0xff, 0xff, 0xff, 0x34, 0xff, 0xff, 0x13, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0x24, 0xff, 0xff, 0xff, 0xff, 0x2a, 0xff, 0x3d, 0x14, 0x1b, 0x28, 0xff, 0xff, 0xff, 0x35,
+	0xff, 0xff, 0xff, 0x06, 0xff, 0x41, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff
+)
@@ -4,6 +4,7 @@
 #include <json_object.h>
 #include <json_tokener.h>
 
+#include "archive.h"
 #include "texture.h"
 #include "platform.h"
 #include "dat_container.h"
@@ -16,28 +17,156 @@ typedef struct {
 	char archive_path[0x42];
 	RA_LoadedModAsset* assets;
 	u32 asset_count;
+	b8 has_cache_file;
+	u32 mod_index; // Index into the list of mods passed to RA_install_mods.
 } RA_LoadedMod;
 
+// Each mod has a manifest next to its cache file recording which version of
+// the mod the cache was built from and which assets it contains, so that mods
+// that haven't changed don't have to be loaded again. The header is followed
+// by the assets.
+#define MANIFEST_MAGIC 0x464e4d52 // "RMNF"
+#define MANIFEST_VERSION 2
+
+// Zip entries are copied into the cache file in chunks of this size, so that
+// big textures don't have to fit in memory all at once.
+#define STAGE_COPY_CHUNK_SIZE (1024 * 1024)
+
+static const u8 zero_padding[0x40] = {0};
+
+// Where assets are written when they're copied into the cache file. The cache
+// can either be a plain file or a DSAR archive.
+typedef struct {
+	FILE* file;
+	RA_ArchiveWriter* archive; // NULL if the cache isn't compressed.
+} CacheWriter;
+
+// Bump this if the format of the mod list cache changes, or if the metadata
+// read from the mods changes, so that old caches get thrown away.
+#define MOD_LIST_CACHE_VERSION 2
+
+// How much of the end of the mod file is hashed. This is where both the zip
+// central directory and the .rcmod directory live. For zip files this covers
+// the names, sizes and checksums of all the files in the mod. The .rcmod
+// directory has no checksums, so an edit to an .rcmod file that keeps its
+// size and modified time and doesn't touch its last 64 KiB isn't noticed.
+#define MANIFEST_HASH_SIZE (64 * 1024)
+
+typedef struct {
+	u32 magic;
+	u32 version;
+	char mod_file_name[RA_MAX_PATH];
+	s64 mod_size;
+	s64 mod_modified_time;
+	u32 mod_hash;
+	u32 asset_count;
+	s64 cache_size; // -1 if the mod doesn't have a cache file.
+	u32 install_flags; // The cache has to be rebuilt if these change.
+	char archive_path[0x42];
+} ModCacheManifest;
+
+// Every asset provided by the mods being installed, keyed by group and path
+// hash, along with which mods provide it.
+typedef struct {
+	u64 path_hash;
+	u32 group;
+	u32 toc_index;
+	u32 first_provider;
+	u32 last_provider;
+	u32 provider_count;
+} ModAsset;
+
+typedef struct {
+	u32 mod_index;
+	u32 next; // UINT32_MAX for the last provider.
+} ModAssetProvider;
+
+typedef struct {
+	ModAsset* assets; // In the order they were first seen.
+	u32 asset_count;
+	ModAssetProvider* providers;
+	u32 provider_count;
+	u32* table; // Open addressing hash table of asset indices, UINT32_MAX for empty slots.
+	u32 capacity;
+} ModAssetMap;
+
+// The paths listed in info.json as not having a header, compared without
+// regard to case.
+typedef struct {
+	RA_StringList paths;
+	u64* path_crcs;
+	u32* table; // Open addressing hash table of path indices keyed by path CRC, UINT32_MAX for empty slots.
+	u32 capacity;
+} HeaderlessSet;
+
+// The start of an .rcmod file is four null terminated strings followed by the
+// offset of the directory. The strings point into data.
+typedef struct {
+	u8* data;
+	const char* name;
+	const char* version;
+	const char* description;
+	const char* author;
+	u32 directory_offset;
+} RcmodHeader;
+
+typedef struct {
+	RA_Mod* mod;
+	char mod_path[RA_MAX_PATH];
+	char cache_path[RA_MAX_PATH];
+	RA_LoadedMod loaded;
+	RA_Result result;
+	RA_Error error;
+	char error_message[1024];
+} ModLoadJob;
+
+typedef struct {
+	ModLoadJob* jobs;
+	u32 job_count;
+	u32 next; // Index of the next job to be picked up by a worker.
+	u32 install_flags;
+	s32 compress_thread_count; // Threads each worker can use to compress its cache.
+} ModLoadQueue;
+
+static json_object* read_mod_list_cache(const char* cache_path, const char* game_dir);
+static b8 read_cached_mod(RA_Mod* dest, json_object* cache, const char* file_name, RA_FileStat* stat);
+static char* read_cached_string(json_object* entry, const char* key);
+static void write_cached_mod(json_object* cache, RA_Mod* mod, RA_FileStat* stat);
 static RA_Result parse_mod(RA_Mod* mod, const char* game_dir, const char* mod_file_name);
 static void free_mod(RA_Mod* mod);
-static RA_Result delete_old_cache_files(const char* cache_dir);
-static RA_Result load_mod(RA_LoadedMod* dest, RA_Mod* src, const char* mod_path, const char* cache_path);
-static RA_Result update_table_of_contents(RA_LoadedMod* mods, u32 mod_count, RA_TableOfContents* toc);
+static RA_Result delete_stale_cache_files(const char* cache_dir, RA_Mod* mods, u32 mod_count);
+static void load_mods_thread(u32 begin, u32 end, void* user);
+static RA_Result load_mod(RA_LoadedMod* dest, RA_Mod* src, const char* mod_path, const char* cache_path, u32 install_flags, s32 compress_thread_count, u8* copy_buffer);
+static RA_Result build_manifest(ModCacheManifest* dest, RA_Mod* mod, const char* mod_path, u32 install_flags);
+static b8 read_manifest(RA_LoadedMod* dest, ModCacheManifest* expected, const char* manifest_path, const char* cache_path);
+static void write_manifest(ModCacheManifest* manifest, RA_LoadedMod* mod, const char* manifest_path, const char* cache_path);
+static RA_Result update_table_of_contents(RA_LoadedMod* mods, u32 mod_count, RA_TableOfContents* toc, RA_ModConflictList* conflicts_dest);
+static ModAsset* lookup_mod_asset(ModAssetMap* map, u64 path_hash, u32 group, b8* created_dest);
+static RA_Result build_conflict_list(RA_ModConflictList* dest, ModAssetMap* map);
 static RA_Result parse_stage(RA_Mod* mod, const char* game_dir, const char* mod_file_name);
-static RA_Result load_stage(RA_LoadedMod* dest, RA_Mod* src, const char* mod_path, const char* cache_path);
-static RA_Result parse_stage_info(RA_Mod* mod, RA_StringList* headerless, zip_t* in_archive);
-static RA_Result parse_stage_entry(RA_LoadedMod* mod, zip_t* in_archive, s64 index, FILE* out_file, RA_StringList* headerless);
+static RA_Result load_stage(RA_LoadedMod* dest, RA_Mod* src, const char* mod_path, const char* cache_path, u32 install_flags, s32 compress_thread_count, u8* copy_buffer);
+static RA_Result parse_stage_info(RA_Mod* mod, HeaderlessSet* headerless, zip_t* in_archive);
+static RA_Result build_headerless_set(HeaderlessSet* headerless);
+static b8 is_headerless(HeaderlessSet* headerless, const char* path);
+static void free_headerless_set(HeaderlessSet* headerless);
+static RA_Result parse_stage_entry(RA_LoadedMod* mod, zip_t* in_archive, s64 index, CacheWriter* cache, HeaderlessSet* headerless, u8* copy_buffer, s64 data_offset, FILE* mod_file);
+static b8 parse_stage_asset_name(const char* name, u32* group_dest, const char** relative_path_dest);
+static RA_Result copy_stored_entry(RA_LoadedModAsset* asset, const char* name, u64 entry_size, s64 data_offset, FILE* mod_file, CacheWriter* cache, u8* copy_buffer);
+static RA_Result write_cache(CacheWriter* cache, const void* data, s64 size);
+static s64 cache_offset(CacheWriter* cache);
+static void find_stored_entries(s64* data_offsets, zip_t* in_archive, s64 entry_count, FILE* file, s64 file_size);
 static RA_Result parse_rcmod(RA_Mod* mod, const char* game_dir, const char* mod_file_name);
 static RA_Result load_rcmod(RA_LoadedMod* dest, RA_Mod* src, const char* mod_path, const char* cache_path);
-static char* read_rcmod_string(FILE* file);
-static b8 skip_rcmod_string(FILE* file);
+static RA_Result read_rcmod_header(RcmodHeader* dest, FILE* file, s64 file_size);
+static char* copy_rcmod_string(const char* string);
+static int compare_u64(const void* lhs, const void* rhs);
 static void build_texture_metadata(RA_TocTextureMeta* dest, RA_TextureHeader* src);
 
 static int compare_mods(const void* lhs, const void* rhs) {
 	return RA_string_compare_no_case(((RA_Mod*) lhs)->file_name, ((RA_Mod*) rhs)->file_name);
 }
 
-RA_Result RA_mod_list_load(RA_Mod** mods_dest, u32* mod_count_dest, const char* game_dir, ModLoadErrorFunc* error_func) {
+RA_Result RA_mod_list_load(RA_Mod** mods_dest, u32* mod_count_dest, const char* game_dir, const char* cache_path, ModLoadErrorFunc* error_func) {
 	RA_Result result;
 	
 	char mods_dir[RA_MAX_PATH];
@@ -56,17 +185,70 @@ RA_Result RA_mod_list_load(RA_Mod** mods_dest, u32* mod_count_dest, const char*
 		return RA_FAILURE("failed to allocate mod list");
 	}
 	
+	// The old cache is only read from, and a new one is built up as we go so
+	// that mods that have been removed get dropped.
+	json_object* old_cache = cache_path != NULL ? read_mod_list_cache(cache_path, game_dir) : NULL;
+	json_object* new_cache = cache_path != NULL ? json_object_new_object() : NULL;
+	b8 cache_changed = old_cache == NULL;
+	u32 cached_mod_count = 0;
+	
 	u32 mod_count = 0;
 	for(u32 i = 0; i < file_names.count; i++) {
-		if((result = parse_mod(&mods[mod_count], game_dir, file_names.strings[i])) == RA_SUCCESS) {
+		const char* file_name = file_names.strings[i];
+		
+		// Only mods that have been added or modified since the last refresh
+		// need to be opened.
+		RA_FileStat stat;
+		b8 have_stat = false;
+		if(new_cache != NULL) {
+			char mod_path[RA_MAX_PATH];
+			if(snprintf(mod_path, RA_MAX_PATH, "%s/%s", mods_dir, file_name) >= 0) {
+				have_stat = RA_file_stat(mod_path, &stat) == RA_SUCCESS;
+			}
+			if(have_stat && read_cached_mod(&mods[mod_count], old_cache, file_name, &stat)) {
+				write_cached_mod(new_cache, &mods[mod_count], &stat);
+				cached_mod_count++;
+				mod_count++;
+				continue;
+			}
+		}
+		
+		if((result = parse_mod(&mods[mod_count], game_dir, file_name)) == RA_SUCCESS) {
+			if(have_stat) {
+				write_cached_mod(new_cache, &mods[mod_count], &stat);
+				cache_changed = true;
+			}
 			mod_count++;
 		} else if(strcmp(result->message, "unsupported format") != 0) {
-			error_func(file_names.strings[i], result);
+			error_func(file_name, result);
 		}
 	}
 	
 	qsort(mods, mod_count, sizeof(RA_Mod), compare_mods);
 	
+	// If every mod came from the old cache and none have been removed, the new
+	// cache would be the same as the old one, so it isn't written out again.
+	if(old_cache != NULL && json_object_object_length(old_cache) != (int) cached_mod_count) {
+		cache_changed = true;
+	}
+	
+	// The cache only exists to speed things up, so failing to write it isn't
+	// an error.
+	if(new_cache != NULL && cache_changed) {
+		json_object* root = json_object_new_object();
+		json_object_object_add(root, "version", json_object_new_int(MOD_LIST_CACHE_VERSION));
+		json_object_object_add(root, "game_dir", json_object_new_string(game_dir));
+		json_object_object_add(root, "mods", new_cache);
+		const char* string = json_object_to_json_string(root);
+		RA_file_write(cache_path, (u8*) string, strlen(string));
+		json_object_put(root);
+	} else if(new_cache != NULL) {
+		json_object_put(new_cache);
+	}
+	if(old_cache != NULL) {
+		json_object_put(old_cache);
+	}
+	
 	*mods_dest = mods;
 	*mod_count_dest = mod_count;
 	
@@ -74,6 +256,109 @@ RA_Result RA_mod_list_load(RA_Mod** mods_dest, u32* mod_count_dest, const char*
 	return RA_SUCCESS;
 }
 
+// Returns the object containing the cached mods, or NULL if the cache doesn't
+// exist or can't be used. A cache written for a different game folder is
+// thrown away, since the mods in it aren't the same files.
+static json_object* read_mod_list_cache(const char* cache_path, const char* game_dir) {
+	if(!RA_file_exists(cache_path)) {
+		return NULL;
+	}
+	
+	u8* data;
+	s64 size;
+	if(RA_file_read(cache_path, &data, &size) != RA_SUCCESS) {
+		return NULL;
+	}
+	
+	json_object* root = json_tokener_parse((char*) data);
+	RA_free(data);
+	if(root == NULL) {
+		return NULL;
+	}
+	
+	json_object* version = json_object_object_get(root, "version");
+	json_object* cached_game_dir = json_object_object_get(root, "game_dir");
+	json_object* mods = json_object_object_get(root, "mods");
+	if(version == NULL || json_object_get_int(version) != MOD_LIST_CACHE_VERSION
+		|| cached_game_dir == NULL || !json_object_is_type(cached_game_dir, json_type_string)
+		|| strcmp(json_object_get_string(cached_game_dir), game_dir) != 0
+		|| mods == NULL || !json_object_is_type(mods, json_type_object)) {
+		json_object_put(root);
+		return NULL;
+	}
+	
+	// Keep the mods object alive after the root is freed.
+	json_object_get(mods);
+	json_object_put(root);
+	return mods;
+}
+
+static b8 read_cached_mod(RA_Mod* dest, json_object* cache, const char* file_name, RA_FileStat* stat) {
+	if(cache == NULL) {
+		return false;
+	}
+	
+	json_object* entry = json_object_object_get(cache, file_name);
+	if(entry == NULL || !json_object_is_type(entry, json_type_object)) {
+		return false;
+	}
+	
+	json_object* size = json_object_object_get(entry, "size");
+	json_object* modified_time = json_object_object_get(entry, "modified_time");
+	json_object* format = json_object_object_get(entry, "format");
+	if(size == NULL || json_object_get_int64(size) != stat->size
+		|| modified_time == NULL || json_object_get_int64(modified_time) != stat->modified_time
+		|| format == NULL) {
+		return false;
+	}
+	
+	memset(dest, 0, sizeof(RA_Mod));
+	RA_string_copy(dest->file_name, file_name, sizeof(dest->file_name));
+	dest->format = (RA_ModFormat) json_object_get_int(format);
+	dest->name = read_cached_string(entry, "name");
+	dest->version = read_cached_string(entry, "version");
+	dest->description = read_cached_string(entry, "description");
+	dest->author = read_cached_string(entry, "author");
+	return true;
+}
+
+static char* read_cached_string(json_object* entry, const char* key) {
+	json_object* string_json = json_object_object_get(entry, key);
+	if(string_json == NULL) {
+		return NULL;
+	}
+	const char* string = json_object_get_string(string_json);
+	if(string == NULL) {
+		return NULL;
+	}
+	s64 size = strlen(string) + 1;
+	char* copy = RA_malloc(size);
+	if(copy != NULL) {
+		memcpy(copy, string, size);
+	}
+	return copy;
+}
+
+static void write_cached_mod(json_object* cache, RA_Mod* mod, RA_FileStat* stat) {
+	json_object* entry = json_object_new_object();
+	json_object_object_add(entry, "size", json_object_new_int64(stat->size));
+	json_object_object_add(entry, "modified_time", json_object_new_int64(stat->modified_time));
+	json_object_object_add(entry, "format", json_object_new_int(mod->format));
+	if(mod->name != NULL) {
+		json_object_object_add(entry, "name", json_object_new_string(mod->name));
+	}
+	if(mod->version != NULL) {
+		json_object_object_add(entry, "version", json_object_new_string(mod->version));
+	}
+	if(mod->description != NULL) {
+		json_object_object_add(entry, "description", json_object_new_string(mod->description));
+	}
+	if(mod->author != NULL) {
+		json_object_object_add(entry, "author", json_object_new_string(mod->author));
+	}
+	json_object_object_add(cache, mod->file_name, entry);
+}
+
 void RA_mod_list_free(RA_Mod* mods, u32 mod_count) {
 	for(u32 i = 0; i < mod_count; i++) {
 		free_mod(&mods[i]);
@@ -105,9 +390,14 @@ static void free_mod(RA_Mod* mod) {
 
 // *****************************************************************************
 
-RA_Result RA_install_mods(RA_Mod* mods, u32 mod_count, RA_TableOfContents* toc, u32* success_count_dest, u32* fail_count_dest, const char* game_dir, ModLoadErrorFunc* error_func) {
+RA_Result RA_install_mods(RA_Mod* mods, u32 mod_count, RA_TableOfContents* toc, u32* success_count_dest, u32* fail_count_dest, const char* game_dir, u32 flags, ModLoadErrorFunc* error_func, RA_ModConflictList* conflicts_dest) {
 	RA_Result result;
 	
+	if(conflicts_dest != NULL) {
+		memset(conflicts_dest, 0, sizeof(RA_ModConflictList));
+		RA_arena_create(&conflicts_dest->arena);
+	}
+	
 	// Fail safe to make sure we don't delete any .cache files from the wrong
 	// directory, probably overkill but better to be careful.
 	char exe_path[RA_MAX_PATH];
@@ -119,13 +409,13 @@ RA_Result RA_install_mods(RA_Mod* mods, u32 mod_count, RA_TableOfContents* toc,
 	}
 	
 	// Create the modcache directory if it doesn't already exist and delete any
-	// old cache files from last time.
+	// cache files left over from mods that have since been removed.
 	char cache_dir[RA_MAX_PATH];
 	if(snprintf(cache_dir, sizeof(cache_dir), "%s/modcache", game_dir) < 0) {
 		return RA_FAILURE("path too long");
 	}
 	RA_make_dir(cache_dir);
-	if((result = delete_old_cache_files(cache_dir)) != RA_SUCCESS) {
+	if((result = delete_stale_cache_files(cache_dir, mods, mod_count)) != RA_SUCCESS) {
 		return RA_FAILURE(result->message);
 	}
 	
@@ -144,36 +434,74 @@ RA_Result RA_install_mods(RA_Mod* mods, u32 mod_count, RA_TableOfContents* toc,
 		}
 	}
 	
-	RA_LoadedMod* loaded_mods = RA_malloc(mod_count * sizeof(RA_LoadedMod));
-	u32 loaded_mod_count = 0;
-	u32 success_count = 0;
-	u32 fail_count = 0;
-	if(loaded_mods == NULL) {
+	// Work out all the paths up front, so the workers only have to load.
+	ModLoadJob* jobs = RA_calloc(MAX(mod_count, 1), sizeof(ModLoadJob));
+	if(jobs == NULL) {
 		return RA_FAILURE("cannot allocate mod list");
 	}
+	u32 job_count = 0;
 	for(u32 i = 0; i < mod_count; i++) {
 		if(mods[i].enabled) {
-			char mod_path[RA_MAX_PATH];
-			if(snprintf(mod_path, sizeof(mod_path), "%s/mods/%s", game_dir, mods[i].file_name) < 0) {
+			ModLoadJob* job = &jobs[job_count++];
+			job->mod = &mods[i];
+			if(snprintf(job->mod_path, sizeof(job->mod_path), "%s/mods/%s", game_dir, mods[i].file_name) < 0) {
+				RA_free(jobs);
 				return RA_FAILURE("path too long");
 			}
-			
-			char cache_path[RA_MAX_PATH];
-			if(snprintf(cache_path, sizeof(cache_path), "%s/%s.cache", cache_dir, mods[i].file_name) < 0) {
+			if(snprintf(job->cache_path, sizeof(job->cache_path), "%s/%s.cache", cache_dir, mods[i].file_name) < 0) {
+				RA_free(jobs);
 				return RA_FAILURE("path too long");
 			}
-			
-			if((result = load_mod(&loaded_mods[loaded_mod_count], &mods[i], mod_path, cache_path)) == RA_SUCCESS) {
-				loaded_mod_count++;
-				success_count++;
-			} else {
-				error_func(mods[i].file_name, result);
-				fail_count++;
+		}
+	}
+	
+	// Each mod writes its own cache file, so they can all be loaded at once.
+	ModLoadQueue queue = {0};
+	queue.jobs = jobs;
+	queue.job_count = job_count;
+	queue.install_flags = flags;
+	// Split the processors between the workers, so that compressing the
+	// caches doesn't start another set of threads for each of them.
+	s32 worker_count = (s32) MIN((u32) RA_processor_count(), MAX(job_count, 1));
+	queue.compress_thread_count = MAX(RA_processor_count() / worker_count, 1);
+	if(job_count <= 1) {
+		load_mods_thread(0, 1, &queue);
+	} else {
+		RA_parallel_for(job_count, 1, load_mods_thread, &queue);
+	}
+	
+	// Report errors and add the mods to the TOC in their original order, so
+	// mods later in the list still take priority.
+	RA_LoadedMod* loaded_mods = RA_malloc(MAX(job_count, 1) * sizeof(RA_LoadedMod));
+	if(loaded_mods == NULL) {
+		for(u32 i = 0; i < job_count; i++) {
+			if(jobs[i].result == RA_SUCCESS) {
+				RA_free(jobs[i].loaded.assets);
 			}
 		}
+		RA_free(jobs);
+		return RA_FAILURE("cannot allocate mod list");
+	}
+	u32 loaded_mod_count = 0;
+	u32 success_count = 0;
+	u32 fail_count = 0;
+	for(u32 i = 0; i < job_count; i++) {
+		if(jobs[i].result == RA_SUCCESS) {
+			loaded_mods[loaded_mod_count] = jobs[i].loaded;
+			loaded_mods[loaded_mod_count].mod_index = (u32) (jobs[i].mod - mods);
+			loaded_mod_count++;
+			success_count++;
+		} else {
+			error_func(jobs[i].mod->file_name, jobs[i].result);
+			fail_count++;
+		}
 	}
+	RA_free(jobs);
 	
-	if((result = update_table_of_contents(loaded_mods, loaded_mod_count, toc)) != RA_SUCCESS) {
+	if((result = update_table_of_contents(loaded_mods, loaded_mod_count, toc, conflicts_dest)) != RA_SUCCESS) {
+		if(conflicts_dest != NULL) {
+			RA_mod_conflict_list_free(conflicts_dest);
+		}
 		for(u32 i = 0; i < loaded_mod_count; i++) {
 			RA_free(loaded_mods[i].assets);
 		}
@@ -192,7 +520,9 @@ RA_Result RA_install_mods(RA_Mod* mods, u32 mod_count, RA_TableOfContents* toc,
 	return RA_SUCCESS;
 }
 
-static RA_Result delete_old_cache_files(const char* cache_dir) {
+// Cache files for mods that are disabled are kept, so that they can be
+// reused if the mod is enabled again.
+static RA_Result delete_stale_cache_files(const char* cache_dir, RA_Mod* mods, u32 mod_count) {
 	RA_Result result;
 	
 	RA_StringList file_names;
@@ -202,8 +532,29 @@ static RA_Result delete_old_cache_files(const char* cache_dir) {
 	
 	for(u32 i = 0; i < file_names.count; i++) {
 		const char* file_name = file_names.strings[i];
-		const char* extension = strrchr(file_name, '.');
-		if(strcmp(extension, ".cache") == 0) {
+		
+		// Work out which mod the file belongs to.
+		char mod_file_name[RA_MAX_PATH];
+		RA_string_copy(mod_file_name, file_name, sizeof(mod_file_name));
+		char* extension = strrchr(mod_file_name, '.');
+		if(extension != NULL && strcmp(extension, ".manifest") == 0) {
+			*extension = '\0';
+			extension = strrchr(mod_file_name, '.');
+		}
+		if(extension == NULL || strcmp(extension, ".cache") != 0) {
+			continue;
+		}
+		*extension = '\0';
+		
+		b8 stale = true;
+		for(u32 j = 0; j < mod_count; j++) {
+			if(strcmp(mods[j].file_name, mod_file_name) == 0) {
+				stale = false;
+				break;
+			}
+		}
+		
+		if(stale) {
 			char file_path[RA_MAX_PATH];
 			if(snprintf(file_path, sizeof(file_path), "%s/%s", cache_dir, file_name) < 0) {
 				RA_string_list_destroy(&file_names);
@@ -218,15 +569,195 @@ static RA_Result delete_old_cache_files(const char* cache_dir) {
 	return RA_SUCCESS;
 }
 
-static RA_Result load_mod(RA_LoadedMod* dest, RA_Mod* src, const char* mod_path, const char* cache_path) {
+static void load_mods_thread(u32 begin, u32 end, void* user) {
+	ModLoadQueue* queue = user;
+	
+	// Each worker reuses the same buffer for copying all of its mods.
+	u8* copy_buffer = RA_malloc(STAGE_COPY_CHUNK_SIZE);
+	
+	// Hand out the mods one at a time, since they vary a lot in size.
+	for(;;) {
+		u32 index = RA_atomic_fetch_add_u32(&queue->next, 1);
+		if(index >= queue->job_count) {
+			break;
+		}
+		ModLoadJob* job = &queue->jobs[index];
+		RA_Result result;
+		if(copy_buffer != NULL) {
+			result = load_mod(&job->loaded, job->mod, job->mod_path, job->cache_path, queue->install_flags, queue->compress_thread_count, copy_buffer);
+		} else {
+			result = RA_FAILURE("cannot allocate copy buffer");
+		}
+		if(result != RA_SUCCESS) {
+			// The error message is thread local, so copy it out.
+			RA_string_copy(job->error_message, result->message, sizeof(job->error_message));
+			job->error.message = job->error_message;
+			job->error.line = result->line;
+			job->result = &job->error;
+		} else {
+			job->result = RA_SUCCESS;
+		}
+	}
+	
+	if(copy_buffer != NULL) {
+		RA_free(copy_buffer);
+	}
+}
+
+static RA_Result load_mod(RA_LoadedMod* dest, RA_Mod* src, const char* mod_path, const char* cache_path, u32 install_flags, s32 compress_thread_count, u8* copy_buffer) {
+	RA_Result result;
+	
+	char manifest_path[RA_MAX_PATH];
+	if(snprintf(manifest_path, sizeof(manifest_path), "%s.manifest", cache_path) < 0) {
+		return RA_FAILURE("path too long");
+	}
+	
+	// If the mod hasn't changed since it was last installed, reuse the cache.
+	ModCacheManifest manifest;
+	if((result = build_manifest(&manifest, src, mod_path, install_flags)) != RA_SUCCESS) {
+		return result;
+	}
+	if(read_manifest(dest, &manifest, manifest_path, cache_path)) {
+		return RA_SUCCESS;
+	}
+	
+	// Make sure the old manifest can't be picked up if loading the mod fails
+	// part of the way through rewriting the cache file.
+	remove(manifest_path);
+	
 	switch(src->format) {
-		case RA_MOD_FORMAT_STAGE: return load_stage(dest, src, mod_path, cache_path);
-		case RA_MOD_FORMAT_RCMOD: return load_rcmod(dest, src, mod_path, cache_path);
-		default: return RA_FAILURE("invalid format enum");
+		case RA_MOD_FORMAT_STAGE: result = load_stage(dest, src, mod_path, cache_path, install_flags, compress_thread_count, copy_buffer); break;
+		case RA_MOD_FORMAT_RCMOD: result = load_rcmod(dest, src, mod_path, cache_path); break;
+		default: result = RA_FAILURE("invalid format enum");
+	}
+	if(result != RA_SUCCESS) {
+		return result;
+	}
+	
+	// If this fails the mod will just be loaded again next time.
+	write_manifest(&manifest, dest, manifest_path, dest->has_cache_file ? cache_path : NULL);
+	
+	return RA_SUCCESS;
+}
+
+static RA_Result build_manifest(ModCacheManifest* dest, RA_Mod* mod, const char* mod_path, u32 install_flags) {
+	RA_Result result;
+	
+	memset(dest, 0, sizeof(ModCacheManifest));
+	dest->magic = MANIFEST_MAGIC;
+	dest->version = MANIFEST_VERSION;
+	RA_string_copy(dest->mod_file_name, mod->file_name, sizeof(dest->mod_file_name));
+	dest->install_flags = install_flags;
+	
+	RA_FileStat stat;
+	if((result = RA_file_stat(mod_path, &stat)) != RA_SUCCESS) {
+		return result;
+	}
+	dest->mod_size = stat.size;
+	dest->mod_modified_time = stat.modified_time;
+	
+	FILE* file = fopen(mod_path, "rb");
+	if(file == NULL) {
+		return RA_FAILURE("cannot open mod file");
+	}
+	s64 hash_size = MIN(stat.size, MANIFEST_HASH_SIZE);
+	u8* data = RA_malloc(MAX(hash_size, 1));
+	if(data == NULL) {
+		fclose(file);
+		return RA_FAILURE("cannot allocate memory for hashing");
+	}
+	if(fseek(file, (long) -hash_size, SEEK_END) != 0 || (hash_size > 0 && fread(data, hash_size, 1, file) != 1)) {
+		RA_free(data);
+		fclose(file);
+		return RA_FAILURE("cannot read mod file");
 	}
+	dest->mod_hash = RA_crc32_update(CRC32_POLYNOMIAL, data, hash_size);
+	RA_free(data);
+	fclose(file);
+	
+	return RA_SUCCESS;
 }
 
-static RA_Result update_table_of_contents(RA_LoadedMod* mods, u32 mod_count, RA_TableOfContents* toc) {
+static b8 read_manifest(RA_LoadedMod* dest, ModCacheManifest* expected, const char* manifest_path, const char* cache_path) {
+	FILE* file = fopen(manifest_path, "rb");
+	if(file == NULL) {
+		return false;
+	}
+	
+	ModCacheManifest manifest;
+	if(fread(&manifest, sizeof(ModCacheManifest), 1, file) != 1) {
+		fclose(file);
+		return false;
+	}
+	
+	b8 matches = manifest.magic == expected->magic
+		&& manifest.version == expected->version
+		&& strcmp(manifest.mod_file_name, expected->mod_file_name) == 0
+		&& manifest.mod_size == expected->mod_size
+		&& manifest.mod_modified_time == expected->mod_modified_time
+		&& manifest.mod_hash == expected->mod_hash
+		&& manifest.install_flags == expected->install_flags;
+	if(!matches) {
+		fclose(file);
+		return false;
+	}
+	
+	// Make sure the cache file hasn't been truncated or replaced.
+	if(manifest.cache_size > -1) {
+		RA_FileStat stat;
+		if(RA_file_stat(cache_path, &stat) != RA_SUCCESS || stat.size != manifest.cache_size) {
+			fclose(file);
+			return false;
+		}
+	}
+	
+	memset(dest, 0, sizeof(RA_LoadedMod));
+	dest->assets = RA_malloc(MAX(manifest.asset_count, 1) * sizeof(RA_LoadedModAsset));
+	if(dest->assets == NULL) {
+		fclose(file);
+		return false;
+	}
+	for(u32 i = 0; i < manifest.asset_count; i++) {
+		if(fread(&dest->assets[i].toc, sizeof(RA_TocAsset), 1, file) != 1) {
+			RA_free(dest->assets);
+			fclose(file);
+			return false;
+		}
+	}
+	dest->asset_count = manifest.asset_count;
+	dest->has_cache_file = manifest.cache_size > -1;
+	RA_string_copy(dest->archive_path, manifest.archive_path, sizeof(dest->archive_path));
+	
+	fclose(file);
+	return true;
+}
+
+static void write_manifest(ModCacheManifest* manifest, RA_LoadedMod* mod, const char* manifest_path, const char* cache_path) {
+	manifest->asset_count = mod->asset_count;
+	manifest->cache_size = -1;
+	if(cache_path != NULL) {
+		RA_FileStat stat;
+		if(RA_file_stat(cache_path, &stat) != RA_SUCCESS) {
+			return;
+		}
+		manifest->cache_size = stat.size;
+	}
+	RA_string_copy(manifest->archive_path, mod->archive_path, sizeof(manifest->archive_path));
+	
+	FILE* file = fopen(manifest_path, "wb");
+	if(file == NULL) {
+		return;
+	}
+	b8 success = fwrite(manifest, sizeof(ModCacheManifest), 1, file) == 1;
+	for(u32 i = 0; success && i < mod->asset_count; i++) {
+		success = fwrite(&mod->assets[i].toc, sizeof(RA_TocAsset), 1, file) == 1;
+	}
+	if(fclose(file) != 0 || !success) {
+		remove(manifest_path);
+	}
+}
+
+static RA_Result update_table_of_contents(RA_LoadedMod* mods, u32 mod_count, RA_TableOfContents* toc, RA_ModConflictList* conflicts_dest) {
 	// Add archives.
 	RA_TocArchive* new_archives = RA_arena_alloc(&toc->arena, (toc->archive_count + mod_count) * sizeof(RA_TocArchive));
 	if(new_archives == NULL) {
@@ -260,36 +791,138 @@ static RA_Result update_table_of_contents(RA_LoadedMod* mods, u32 mod_count, RA_
 	u32 old_asset_count = toc->asset_count;
 	toc->assets = new_assets;
 	
+	// Keep track of which assets have already been added and which mods
+	// provide them, so that the same asset is never added twice, and so that
+	// conflicts can be reported.
+	u32 mod_asset_count = max_asset_count - old_asset_count;
+	ModAssetMap map = {0};
+	map.capacity = 16;
+	while(map.capacity < mod_asset_count * 2) {
+		map.capacity *= 2;
+	}
+	map.assets = RA_malloc(MAX(mod_asset_count, 1) * sizeof(ModAsset));
+	map.providers = RA_malloc(MAX(mod_asset_count, 1) * sizeof(ModAssetProvider));
+	map.table = RA_malloc(map.capacity * sizeof(u32));
+	if(map.assets == NULL || map.providers == NULL || map.table == NULL) {
+		if(map.assets) RA_free(map.assets);
+		if(map.providers) RA_free(map.providers);
+		if(map.table) RA_free(map.table);
+		return RA_FAILURE("cannot allocate asset map");
+	}
+	memset(map.table, 0xff, map.capacity * sizeof(u32));
+	
 	u32 archive_index = old_archive_count;
 	for(u32 i = 0; i < mod_count; i++) {
 		for(u32 j = 0; j < mods[i].asset_count; j++) {
 			RA_LoadedModAsset* mod_asset = &mods[i].assets[j];
-			RA_TocAsset* toc_asset = RA_toc_lookup_asset(toc->assets, old_asset_count, mod_asset->toc.path_hash, mod_asset->toc.group);
-			if(toc_asset == NULL) {
-				// Make sure we don't add the same asset twice, even if multiple
-				// mods contain the same asset.
-				for(u32 k = old_asset_count; k < toc->asset_count; k++) {
-					if(toc->assets[k].group == mod_asset->toc.group && toc->assets[k].path_hash == mod_asset->toc.path_hash) {
-						toc_asset = &toc->assets[k];
-						break;
-					}
+			b8 created;
+			ModAsset* asset = lookup_mod_asset(&map, mod_asset->toc.path_hash, mod_asset->toc.group, &created);
+			if(created) {
+				RA_TocAsset* toc_asset = RA_toc_lookup_asset(toc->assets, old_asset_count, mod_asset->toc.path_hash, mod_asset->toc.group);
+				if(toc_asset) {
+					asset->toc_index = (u32) (toc_asset - toc->assets);
+				} else {
+					asset->toc_index = toc->asset_count++;
 				}
 			}
-			if(toc_asset) {
-				*toc_asset = mod_asset->toc;
-			} else {
-				toc_asset = &toc->assets[toc->asset_count];
-				toc->asset_count++;
-			}
+			
+			// Later mods take priority over earlier ones.
+			RA_TocAsset* toc_asset = &toc->assets[asset->toc_index];
 			*toc_asset = mod_asset->toc;
 			toc_asset->metadata.archive_index = archive_index;
+			
+			// A mod that contains the same asset twice doesn't conflict with
+			// itself.
+			if(asset->provider_count == 0 || map.providers[asset->last_provider].mod_index != mods[i].mod_index) {
+				ModAssetProvider* provider = &map.providers[map.provider_count];
+				provider->mod_index = mods[i].mod_index;
+				provider->next = UINT32_MAX;
+				if(asset->provider_count == 0) {
+					asset->first_provider = map.provider_count;
+				} else {
+					map.providers[asset->last_provider].next = map.provider_count;
+				}
+				asset->last_provider = map.provider_count;
+				asset->provider_count++;
+				map.provider_count++;
+			}
 		}
 		archive_index++;
 	}
 	
+	RA_Result result = RA_SUCCESS;
+	if(conflicts_dest != NULL) {
+		result = build_conflict_list(conflicts_dest, &map);
+	}
+	
+	RA_free(map.assets);
+	RA_free(map.providers);
+	RA_free(map.table);
+	
+	return result;
+}
+
+static ModAsset* lookup_mod_asset(ModAssetMap* map, u64 path_hash, u32 group, b8* created_dest) {
+	u32 mask = map->capacity - 1;
+	u32 slot = ((u32) path_hash ^ (u32) (path_hash >> 32) ^ (group * 0x9e3779b9)) & mask;
+	for(; map->table[slot] != UINT32_MAX; slot = (slot + 1) & mask) {
+		ModAsset* asset = &map->assets[map->table[slot]];
+		if(asset->path_hash == path_hash && asset->group == group) {
+			*created_dest = false;
+			return asset;
+		}
+	}
+	
+	map->table[slot] = map->asset_count;
+	ModAsset* asset = &map->assets[map->asset_count++];
+	memset(asset, 0, sizeof(ModAsset));
+	asset->path_hash = path_hash;
+	asset->group = group;
+	*created_dest = true;
+	return asset;
+}
+
+static RA_Result build_conflict_list(RA_ModConflictList* dest, ModAssetMap* map) {
+	u32 conflict_count = 0;
+	for(u32 i = 0; i < map->asset_count; i++) {
+		if(map->assets[i].provider_count > 1) {
+			conflict_count++;
+		}
+	}
+	
+	if(conflict_count == 0) {
+		return RA_SUCCESS;
+	}
+	
+	dest->conflicts = RA_arena_calloc(&dest->arena, conflict_count, sizeof(RA_ModConflict));
+	if(dest->conflicts == NULL) {
+		return RA_FAILURE("cannot allocate conflict list");
+	}
+	
+	for(u32 i = 0; i < map->asset_count; i++) {
+		ModAsset* asset = &map->assets[i];
+		if(asset->provider_count > 1) {
+			RA_ModConflict* conflict = &dest->conflicts[dest->conflict_count++];
+			conflict->path_hash = asset->path_hash;
+			conflict->group = asset->group;
+			conflict->mod_indices = RA_arena_alloc(&dest->arena, asset->provider_count * sizeof(u32));
+			if(conflict->mod_indices == NULL) {
+				return RA_FAILURE("cannot allocate conflict list");
+			}
+			for(u32 provider = asset->first_provider; provider != UINT32_MAX; provider = map->providers[provider].next) {
+				conflict->mod_indices[conflict->mod_count++] = map->providers[provider].mod_index;
+			}
+		}
+	}
+	
 	return RA_SUCCESS;
 }
 
+void RA_mod_conflict_list_free(RA_ModConflictList* conflicts) {
+	RA_arena_destroy(&conflicts->arena);
+	memset(conflicts, 0, sizeof(RA_ModConflictList));
+}
+
 // *****************************************************************************
 
 static RA_Result parse_stage(RA_Mod* mod, const char* game_dir, const char* mod_file_name) {
@@ -327,7 +960,7 @@ static RA_Result parse_stage(RA_Mod* mod, const char* game_dir, const char* mod_
 	return RA_SUCCESS;
 }
 
-static RA_Result load_stage(RA_LoadedMod* dest, RA_Mod* src, const char* mod_path, const char* cache_path) {
+static RA_Result load_stage(RA_LoadedMod* dest, RA_Mod* src, const char* mod_path, const char* cache_path, u32 install_flags, s32 compress_thread_count, u8* copy_buffer) {
 	RA_Result result;
 	
 	memset(dest, 0, sizeof(RA_LoadedMod));
@@ -343,62 +976,157 @@ static RA_Result load_stage(RA_LoadedMod* dest, RA_Mod* src, const char* mod_pat
 		return result_val;
 	}
 	
-	// Open the cache file, which we'll use to store the decompressed assets
-	// that the game will actually use.
-	RA_make_dirs(cache_path);
-	FILE* out_file = fopen(cache_path, "wb");
-	if(out_file == NULL) {
-		zip_close(in_archive);
-		return RA_FAILURE("cannot open cache file");
-	}
-	
 	// Determine which files lack the "header" that would be stored in the toc.
-	RA_StringList headerless;
+	HeaderlessSet headerless;
 	if((result = parse_stage_info(NULL, &headerless, in_archive)) != RA_SUCCESS) {
-		fclose(out_file);
 		zip_close(in_archive);
 		return RA_FAILURE("cannot read info.json: %s", result->message);
 	}
 	
 	s64 entry_count = zip_get_num_entries(in_archive, 0);
 	if(entry_count == -1) {
-		RA_string_list_destroy(&headerless);
-		fclose(out_file);
+		free_headerless_set(&headerless);
 		zip_close(in_archive);
 		return RA_FAILURE("zip_get_num_entries returned -1");
 	}
-	dest->assets = RA_calloc(entry_count, sizeof(RA_LoadedModAsset));
-	if(dest->assets == NULL) {
-		RA_string_list_destroy(&headerless);
-		fclose(out_file);
+	dest->assets = RA_calloc(MAX(entry_count, 1), sizeof(RA_LoadedModAsset));
+	s64* data_offsets = RA_malloc(MAX(entry_count, 1) * sizeof(s64));
+	if(dest->assets == NULL || data_offsets == NULL) {
+		if(dest->assets) {
+			RA_free(dest->assets);
+		}
+		if(data_offsets) {
+			RA_free(data_offsets);
+		}
+		free_headerless_set(&headerless);
 		zip_close(in_archive);
 		return RA_FAILURE("cannot allocate asset list");
 	}
 	
+	// Entries that aren't compressed can be copied straight out of the mod
+	// file instead of going through libzip.
+	RA_FileStat mod_stat;
+	FILE* mod_file = NULL;
+	if(RA_file_stat(mod_path, &mod_stat) == RA_SUCCESS) {
+		mod_file = fopen(mod_path, "rb");
+	}
+	if(mod_file != NULL) {
+		find_stored_entries(data_offsets, in_archive, entry_count, mod_file, mod_stat.size);
+	} else {
+		for(s64 i = 0; i < entry_count; i++) {
+			data_offsets[i] = -1;
+		}
+	}
+	
+	// If none of the assets are compressed, the game can read them from the mod
+	// file directly, the same way as for .rcmod files, so no cache file is
+	// needed. The TOC can only store 32-bit offsets though.
+	// The size of the assets is also worked out here, in case the cache file is
+	// going to be compressed.
+	b8 in_place = mod_file != NULL && mod_stat.size <= UINT32_MAX;
+	s64 max_cache_size = 0;
 	for(s64 i = 0; i < entry_count; i++) {
-		if((result = parse_stage_entry(dest, in_archive, i, out_file, &headerless)) != RA_SUCCESS) {
+		zip_stat_t stat;
+		if(zip_stat_index(in_archive, i, 0, &stat) != 0 || !(stat.valid & ZIP_STAT_NAME)) {
+			in_place = false;
+		} else if(parse_stage_asset_name(stat.name, NULL, NULL)) {
+			if(data_offsets[i] == -1) {
+				in_place = false;
+			}
+			if(stat.valid & ZIP_STAT_SIZE) {
+				max_cache_size += ALIGN(stat.size, 0x40);
+			}
+		}
+	}
+	
+	// Otherwise, open the cache file, which we'll use to store the decompressed
+	// assets that the game will actually use.
+	CacheWriter cache = {0};
+	if(in_place) {
+		remove(cache_path);
+	} else {
+		RA_make_dirs(cache_path);
+		cache.file = fopen(cache_path, "wb");
+		if(cache.file != NULL && (install_flags & RA_INSTALL_COMPRESS_CACHE)) {
+			cache.archive = RA_archive_writer_begin(cache.file, max_cache_size, compress_thread_count);
+			if(cache.archive == NULL) {
+				fclose(cache.file);
+				cache.file = NULL;
+			}
+		}
+		if(cache.file == NULL) {
+			if(mod_file) {
+				fclose(mod_file);
+			}
+			RA_free(data_offsets);
 			RA_free(dest->assets);
-			RA_string_list_destroy(&headerless);
-			fclose(out_file);
+			free_headerless_set(&headerless);
+			zip_close(in_archive);
+			return RA_FAILURE("cannot open cache file");
+		}
+	}
+	
+	for(s64 i = 0; i < entry_count; i++) {
+		if((result = parse_stage_entry(dest, in_archive, i, in_place ? NULL : &cache, &headerless, copy_buffer, data_offsets[i], mod_file)) != RA_SUCCESS) {
+			if(cache.archive) {
+				RA_archive_writer_abort(cache.archive);
+			}
+			if(cache.file) {
+				fclose(cache.file);
+			}
+			if(mod_file) {
+				fclose(mod_file);
+			}
+			RA_free(data_offsets);
+			RA_free(dest->assets);
+			free_headerless_set(&headerless);
 			zip_close(in_archive);
 			return result;
 		}
 	}
 	
+	// Write out the block headers for the compressed cache.
+	if(cache.archive && (result = RA_archive_writer_finish(cache.archive)) != RA_SUCCESS) {
+		cache.archive = NULL;
+		fclose(cache.file);
+		if(mod_file) {
+			fclose(mod_file);
+		}
+		RA_free(data_offsets);
+		RA_free(dest->assets);
+		free_headerless_set(&headerless);
+		zip_close(in_archive);
+		return RA_FAILURE("cannot write cache file: %s", result->message);
+	}
+	
 	// Cleanup.
-	RA_string_list_destroy(&headerless);
-	fclose(out_file);
+	if(cache.file) {
+		fclose(cache.file);
+	}
+	if(mod_file) {
+		fclose(mod_file);
+	}
+	RA_free(data_offsets);
+	free_headerless_set(&headerless);
 	zip_close(in_archive);
 	
-	if(snprintf(dest->archive_path, sizeof(dest->archive_path), "modcache\\%s.cache", src->file_name) < 0) {
-		RA_free(dest->assets);
-		return RA_FAILURE("path too long");
+	if(in_place) {
+		if(snprintf(dest->archive_path, sizeof(dest->archive_path), "mods\\%s", src->file_name) < 0) {
+			RA_free(dest->assets);
+			return RA_FAILURE("path too long");
+		}
+	} else {
+		if(snprintf(dest->archive_path, sizeof(dest->archive_path), "modcache\\%s.cache", src->file_name) < 0) {
+			RA_free(dest->assets);
+			return RA_FAILURE("path too long");
+		}
+		dest->has_cache_file = true;
 	}
 	
 	return RA_SUCCESS;
 }
 
-static RA_Result parse_stage_info(RA_Mod* mod, RA_StringList* headerless, zip_t* in_archive) {
+static RA_Result parse_stage_info(RA_Mod* mod, HeaderlessSet* headerless, zip_t* in_archive) {
 	RA_Result result;
 	
 	zip_stat_t stat;
@@ -456,7 +1184,8 @@ static RA_Result parse_stage_info(RA_Mod* mod, RA_StringList* headerless, zip_t*
 	}
 	
 	if(headerless != NULL) {
-		RA_string_list_create(headerless);
+		memset(headerless, 0, sizeof(HeaderlessSet));
+		RA_string_list_create(&headerless->paths);
 		
 		json_object* headerless_json = json_object_object_get(root, "headerless");
 		if(headerless_json != NULL && json_object_is_type(headerless_json, json_type_array)) {
@@ -465,11 +1194,13 @@ static RA_Result parse_stage_info(RA_Mod* mod, RA_StringList* headerless, zip_t*
 				json_object* element = json_object_array_get_idx(headerless_json, i);
 				const char* headerless_path = json_object_get_string(element);
 				if(headerless_path == NULL) {
+					RA_string_list_destroy(&headerless->paths);
 					json_object_put(root);
 					zip_fclose(info_file);
 					return RA_FAILURE("bad headerless property");
 				}
-				if((result = RA_string_list_add(headerless, headerless_path)) != RA_SUCCESS) {
+				if((result = RA_string_list_add(&headerless->paths, headerless_path)) != RA_SUCCESS) {
+					RA_string_list_destroy(&headerless->paths);
 					json_object_put(root);
 					zip_fclose(info_file);
 					return result;
@@ -477,8 +1208,15 @@ static RA_Result parse_stage_info(RA_Mod* mod, RA_StringList* headerless, zip_t*
 			}
 		}
 		
-		if((result = RA_string_list_finish(headerless)) != RA_SUCCESS) {
-			RA_string_list_destroy(headerless);
+		if((result = RA_string_list_finish(&headerless->paths)) != RA_SUCCESS) {
+			RA_string_list_destroy(&headerless->paths);
+			json_object_put(root);
+			zip_fclose(info_file);
+			return result;
+		}
+		
+		if((result = build_headerless_set(headerless)) != RA_SUCCESS) {
+			free_headerless_set(headerless);
 			json_object_put(root);
 			zip_fclose(info_file);
 			return result;
@@ -491,7 +1229,60 @@ static RA_Result parse_stage_info(RA_Mod* mod, RA_StringList* headerless, zip_t*
 	return RA_SUCCESS;
 }
 
-static RA_Result parse_stage_entry(RA_LoadedMod* mod, zip_t* in_archive, s64 index, FILE* out_file, RA_StringList* headerless) {
+// RA_crc64_path ignores case the same way RA_string_compare_no_case does, so
+// paths that compare equal always end up in the same chain.
+static RA_Result build_headerless_set(HeaderlessSet* headerless) {
+	u32 capacity = 16;
+	while(capacity < headerless->paths.count * 2) {
+		capacity *= 2;
+	}
+	
+	headerless->path_crcs = RA_malloc(MAX(headerless->paths.count, 1) * sizeof(u64));
+	headerless->table = RA_malloc(capacity * sizeof(u32));
+	if(headerless->path_crcs == NULL || headerless->table == NULL) {
+		return RA_FAILURE("cannot allocate headerless table");
+	}
+	memset(headerless->table, 0xff, capacity * sizeof(u32));
+	headerless->capacity = capacity;
+	
+	u32 mask = capacity - 1;
+	for(u32 i = 0; i < headerless->paths.count; i++) {
+		u64 crc = RA_crc64_path(headerless->paths.strings[i]);
+		headerless->path_crcs[i] = crc;
+		u32 slot = (u32) crc & mask;
+		while(headerless->table[slot] != UINT32_MAX) {
+			slot = (slot + 1) & mask;
+		}
+		headerless->table[slot] = i;
+	}
+	
+	return RA_SUCCESS;
+}
+
+static b8 is_headerless(HeaderlessSet* headerless, const char* path) {
+	u64 crc = RA_crc64_path(path);
+	u32 mask = headerless->capacity - 1;
+	for(u32 slot = (u32) crc & mask; headerless->table[slot] != UINT32_MAX; slot = (slot + 1) & mask) {
+		u32 index = headerless->table[slot];
+		// The CRC also treats backslashes as slashes, so check the string too.
+		if(headerless->path_crcs[index] == crc && RA_string_compare_no_case(headerless->paths.strings[index], path) == 0) {
+			return true;
+		}
+	}
+	return false;
+}
+
+static void free_headerless_set(HeaderlessSet* headerless) {
+	if(headerless->table) {
+		RA_free(headerless->table);
+	}
+	if(headerless->path_crcs) {
+		RA_free(headerless->path_crcs);
+	}
+	RA_string_list_destroy(&headerless->paths);
+}
+
+static RA_Result parse_stage_entry(RA_LoadedMod* mod, zip_t* in_archive, s64 index, CacheWriter* cache, HeaderlessSet* headerless, u8* copy_buffer, s64 data_offset, FILE* mod_file) {
 	RA_Result result;
 	
 	zip_stat_t stat;
@@ -500,19 +1291,12 @@ static RA_Result parse_stage_entry(RA_LoadedMod* mod, zip_t* in_archive, s64 ind
 	}
 	
 	const char* name = stat.name;
-	u64 name_size = strlen(name);
-	if(name_size == 0 || name[name_size - 1] == '/') {
-		// Not an asset.
-		return RA_SUCCESS;
-	}
-	
-	char* relative_path;
-	u32 group = (u32) strtoll(name, &relative_path, 10);
-	if(relative_path == name || relative_path == NULL || *relative_path == '\0') {
+	u32 group;
+	const char* relative_path;
+	if(!parse_stage_asset_name(name, &group, &relative_path)) {
 		// Not an asset.
 		return RA_SUCCESS;
 	}
-	relative_path++; // Skip past '/'.
 	
 	b8 is_hash_path = true;
 	if(strlen(relative_path) == 16) {
@@ -532,21 +1316,20 @@ static RA_Result parse_stage_entry(RA_LoadedMod* mod, zip_t* in_archive, s64 ind
 	asset->toc.path_hash = is_hash_path ? strtoull(relative_path, NULL, 16) : RA_crc64_path(relative_path);
 	asset->toc.group = group;
 	
-	b8 has_header = (asset->toc.group % 8) == 0;
-	if(has_header) {
-		for(u32 i = 0; i < headerless->count; i++) {
-			if(RA_string_compare_no_case(headerless->strings[i], name) == 0) {
-				has_header = false;
-				break;
-			}
-		}
+	b8 has_header = (asset->toc.group % 8) == 0 && !is_headerless(headerless, name);
+	asset->toc.has_header = has_header;
+	
+	if(data_offset > -1) {
+		return copy_stored_entry(asset, name, stat.size, data_offset, mod_file, cache, copy_buffer);
 	}
 	
 	zip_file_t* file = zip_fopen_index(in_archive, index, 0);
+	if(file == NULL) {
+		return RA_FAILURE("cannot open asset %s", name);
+	}
 	
 	u32 header_size = 0;
 	if(has_header) {
-		asset->toc.has_header = true;
 		if(zip_fread(file, &asset->toc.header, sizeof(RA_TocAssetHeader)) != sizeof(RA_TocAssetHeader)) {
 			zip_fclose(file);
 			return RA_FAILURE("cannot read asset header for asset %s", name);
@@ -555,57 +1338,335 @@ static RA_Result parse_stage_entry(RA_LoadedMod* mod, zip_t* in_archive, s64 ind
 	}
 	
 	u32 file_size = stat.size - header_size;
-	u32 allocation_size = ALIGN(file_size, 0x40);
-	u8* file_data = RA_calloc(1, allocation_size);
-	if(file_data == NULL) {
-		zip_fclose(file);
-		return RA_FAILURE("cannot allocate file data for asset %s", name);
-	}
-	if(zip_fread(file, file_data, file_size) != file_size) {
-		RA_free(file_data);
-		zip_fclose(file);
-		return RA_FAILURE("cannot read data for asset %s", name);
+	u32 padding_size = ALIGN(file_size, 0x40) - file_size;
+	b8 is_texture = asset->toc.has_header && asset->toc.header.asset_type_hash == RA_ASSET_TYPE_TEXTURE;
+	
+	// Copy the asset into the cache file a chunk at a time. For textures, the
+	// position of the texture header is read from the DAT header in the first
+	// chunk, and then it's picked out of whichever chunk it's in.
+	RA_TextureHeader texture_header = {0};
+	u32 texture_header_offset = 0;
+	u32 texture_header_size = 0;
+	s64 begin_offset = cache_offset(cache);
+	for(u32 copied = 0; copied < file_size;) {
+		u32 chunk_size = MIN(file_size - copied, STAGE_COPY_CHUNK_SIZE);
+		if(zip_fread(file, copy_buffer, chunk_size) != chunk_size) {
+			zip_fclose(file);
+			return RA_FAILURE("cannot read data for asset %s", name);
+		}
+		
+		if(is_texture && copied == 0) {
+			RA_DatLump lump;
+			if((result = RA_dat_peek_lump(&lump, copy_buffer, chunk_size, file_size, 0, LUMP_TEXTURE_HEADER)) != RA_SUCCESS) {
+				zip_fclose(file);
+				return RA_FAILURE("cannot parse asset %s: %s", name, result->message);
+			}
+			texture_header_offset = lump.offset;
+			texture_header_size = MIN(lump.size, sizeof(RA_TextureHeader));
+		}
+		
+		u32 overlap_begin = MAX(texture_header_offset, copied);
+		u32 overlap_end = MIN(texture_header_offset + texture_header_size, copied + chunk_size);
+		if(overlap_begin < overlap_end) {
+			memcpy((u8*) &texture_header + (overlap_begin - texture_header_offset), copy_buffer + (overlap_begin - copied), overlap_end - overlap_begin);
+		}
+		
+		if(write_cache(cache, copy_buffer, chunk_size) != RA_SUCCESS) {
+			zip_fclose(file);
+			return RA_FAILURE("cannot write data to cache file for asset %s", name);
+		}
+		copied += chunk_size;
 	}
 	
-	s64 begin_offset = ftell(out_file);
-	if(fwrite(file_data, allocation_size, 1, out_file) != 1) {
-		RA_free(file_data);
+	if(padding_size > 0 && write_cache(cache, zero_padding, padding_size) != RA_SUCCESS) {
 		zip_fclose(file);
 		return RA_FAILURE("cannot write data to cache file for asset %s", name);
 	}
-	s64 end_offset = begin_offset + file_size;
 	
 	asset->toc.metadata.offset = (u32) begin_offset;
-	asset->toc.metadata.size = (u32) (end_offset - begin_offset);
+	asset->toc.metadata.size = file_size;
 	
-	if(asset->toc.has_header && asset->toc.header.asset_type_hash == RA_ASSET_TYPE_TEXTURE) {
-		RA_DatFile dat;
-		if((result = RA_dat_parse(&dat, file_data, file_size, 0)) != RA_SUCCESS) {
-			RA_free(file_data);
-			zip_fclose(file);
-			return RA_FAILURE("cannot parse asset %s: %s", name, result->message);
-		}
-		
-		RA_DatLump* texture_header = RA_dat_lookup_lump(&dat, LUMP_TEXTURE_HEADER);
-		if(texture_header == NULL) {
-			RA_dat_free(&dat, DONT_FREE_FILE_DATA);
-			RA_free(file_data);
+	if(is_texture) {
+		if(texture_header_size == 0) {
 			zip_fclose(file);
 			return RA_FAILURE("missing texture header for asset %s", name);
 		}
-		
 		asset->toc.has_texture_meta = true;
-		build_texture_metadata(&asset->toc.texture_meta, (RA_TextureHeader*) texture_header->data);
-		
-		RA_dat_free(&dat, DONT_FREE_FILE_DATA);
+		build_texture_metadata(&asset->toc.texture_meta, &texture_header);
 	}
 	
-	RA_free(file_data);
 	zip_fclose(file);
 	
 	return RA_SUCCESS;
 }
 
+// Asset files are stored in the zip as <group>/<path>. Everything else is
+// ignored. The outputs can be NULL.
+static b8 parse_stage_asset_name(const char* name, u32* group_dest, const char** relative_path_dest) {
+	u64 name_size = strlen(name);
+	if(name_size == 0 || name[name_size - 1] == '/') {
+		return false;
+	}
+	
+	char* relative_path;
+	u32 group = (u32) strtoll(name, &relative_path, 10);
+	if(relative_path == name || relative_path == NULL || *relative_path == '\0') {
+		return false;
+	}
+	
+	if(group_dest) {
+		*group_dest = group;
+	}
+	if(relative_path_dest) {
+		*relative_path_dest = relative_path + 1; // Skip past '/'.
+	}
+	return true;
+}
+
+// Copy an asset that isn't compressed out of the mod file. If cache is NULL the
+// asset is left where it is and the game reads it from the mod file.
+static RA_Result copy_stored_entry(RA_LoadedModAsset* asset, const char* name, u64 entry_size, s64 data_offset, FILE* mod_file, CacheWriter* cache, u8* copy_buffer) {
+	RA_Result result;
+	
+	u32 header_size = 0;
+	if(asset->toc.has_header) {
+		if(entry_size < sizeof(RA_TocAssetHeader) || RA_file_read_range(mod_file, data_offset, &asset->toc.header, sizeof(RA_TocAssetHeader)) != RA_SUCCESS) {
+			return RA_FAILURE("cannot read asset header for asset %s", name);
+		}
+		header_size = sizeof(RA_TocAssetHeader);
+	}
+	u32 file_size = (u32) (entry_size - header_size);
+	data_offset += header_size;
+	
+	// The texture header can be read straight out of the mod file too. Only
+	// the start of the file is needed to find it, and it's usually in there.
+	if(asset->toc.has_header && asset->toc.header.asset_type_hash == RA_ASSET_TYPE_TEXTURE) {
+		u32 peek_size = MIN(file_size, RA_DAT_MAX_HEADER_SIZE);
+		if(RA_file_read_range(mod_file, data_offset, copy_buffer, peek_size) != RA_SUCCESS) {
+			return RA_FAILURE("cannot read data for asset %s", name);
+		}
+		RA_DatLump lump;
+		if((result = RA_dat_peek_lump(&lump, copy_buffer, peek_size, file_size, 0, LUMP_TEXTURE_HEADER)) != RA_SUCCESS) {
+			return RA_FAILURE("cannot parse asset %s: %s", name, result->message);
+		}
+		RA_TextureHeader texture_header = {0};
+		u32 texture_header_size = MIN(lump.size, sizeof(RA_TextureHeader));
+		if(lump.data != NULL) {
+			memcpy(&texture_header, lump.data, texture_header_size);
+		} else if(RA_file_read_range(mod_file, data_offset + lump.offset, &texture_header, texture_header_size) != RA_SUCCESS) {
+			return RA_FAILURE("cannot read texture header for asset %s", name);
+		}
+		asset->toc.has_texture_meta = true;
+		build_texture_metadata(&asset->toc.texture_meta, &texture_header);
+	}
+	
+	if(cache == NULL) {
+		asset->toc.metadata.offset = (u32) data_offset;
+		asset->toc.metadata.size = file_size;
+		return RA_SUCCESS;
+	}
+	
+	s64 begin_offset = cache_offset(cache);
+	if(cache->archive) {
+		// The data has to go through the compressor.
+		for(u32 copied = 0; copied < file_size;) {
+			u32 chunk_size = MIN(file_size - copied, STAGE_COPY_CHUNK_SIZE);
+			if(RA_file_read_range(mod_file, data_offset + copied, copy_buffer, chunk_size) != RA_SUCCESS) {
+				return RA_FAILURE("cannot read data for asset %s", name);
+			}
+			if(write_cache(cache, copy_buffer, chunk_size) != RA_SUCCESS) {
+				return RA_FAILURE("cannot write data to cache file for asset %s", name);
+			}
+			copied += chunk_size;
+		}
+	} else if((result = RA_file_copy_range(cache->file, mod_file, data_offset, file_size, copy_buffer, STAGE_COPY_CHUNK_SIZE)) != RA_SUCCESS) {
+		return RA_FAILURE("cannot copy data to cache file for asset %s: %s", name, result->message);
+	}
+	u32 padding_size = ALIGN(file_size, 0x40) - file_size;
+	if(padding_size > 0 && write_cache(cache, zero_padding, padding_size) != RA_SUCCESS) {
+		return RA_FAILURE("cannot write data to cache file for asset %s", name);
+	}
+	
+	asset->toc.metadata.offset = (u32) begin_offset;
+	asset->toc.metadata.size = file_size;
+	
+	return RA_SUCCESS;
+}
+
+static RA_Result write_cache(CacheWriter* cache, const void* data, s64 size) {
+	if(cache->archive) {
+		return RA_archive_writer_write(cache->archive, data, size);
+	}
+	if(fwrite(data, size, 1, cache->file) != 1) {
+		return RA_FAILURE("fwrite failed");
+	}
+	return RA_SUCCESS;
+}
+
+static s64 cache_offset(CacheWriter* cache) {
+	if(cache->archive) {
+		return RA_archive_writer_offset(cache->archive);
+	}
+	return ftell(cache->file);
+}
+
+static u16 read_u16(const u8* data) {
+	u16 value;
+	memcpy(&value, data, 2);
+	return value;
+}
+
+static u32 read_u32(const u8* data) {
+	u32 value;
+	memcpy(&value, data, 4);
+	return value;
+}
+
+static u64 read_u64(const u8* data) {
+	u64 value;
+	memcpy(&value, data, 8);
+	return value;
+}
+
+#define ZIP_LOCAL_HEADER_SIGNATURE 0x04034b50
+#define ZIP_CENTRAL_HEADER_SIGNATURE 0x02014b50
+#define ZIP_END_SIGNATURE 0x06054b50
+#define ZIP64_END_SIGNATURE 0x06064b50
+#define ZIP64_END_LOCATOR_SIGNATURE 0x07064b50
+
+// Work out where the data for each entry that isn't compressed or encrypted
+// is in the mod file, since libzip doesn't say. This means reading the central
+// directory, which lists the entries in the same order libzip does, and then
+// the local header of each entry. Entries that can't be copied directly are
+// set to -1.
+static void find_stored_entries(s64* data_offsets, zip_t* in_archive, s64 entry_count, FILE* file, s64 file_size) {
+	for(s64 i = 0; i < entry_count; i++) {
+		data_offsets[i] = -1;
+	}
+	
+	// Find the end of central directory record. It's followed by a comment of
+	// up to 64 KiB.
+	s64 tail_size = MIN(file_size, 0xffff + 22);
+	u8* tail = RA_malloc(MAX(tail_size, 1));
+	if(tail == NULL) {
+		return;
+	}
+	if(RA_file_read_range(file, file_size - tail_size, tail, tail_size) != RA_SUCCESS) {
+		RA_free(tail);
+		return;
+	}
+	s64 end = -1;
+	for(s64 i = tail_size - 22; i >= 0; i--) {
+		if(read_u32(&tail[i]) == ZIP_END_SIGNATURE) {
+			end = i;
+			break;
+		}
+	}
+	if(end == -1) {
+		RA_free(tail);
+		return;
+	}
+	u64 record_count = read_u16(&tail[end + 10]);
+	u64 directory_size = read_u32(&tail[end + 12]);
+	u64 directory_offset = read_u32(&tail[end + 16]);
+	
+	// For zip64 files, the real values are in another record that the locator
+	// just before the normal record points to.
+	if(record_count == 0xffff || directory_size == 0xffffffff || directory_offset == 0xffffffff) {
+		u8 record[56];
+		if(end < 20 || read_u32(&tail[end - 20]) != ZIP64_END_LOCATOR_SIGNATURE
+			|| RA_file_read_range(file, (s64) read_u64(&tail[end - 20 + 8]), record, sizeof(record)) != RA_SUCCESS
+			|| read_u32(record) != ZIP64_END_SIGNATURE) {
+			RA_free(tail);
+			return;
+		}
+		record_count = read_u64(&record[32]);
+		directory_size = read_u64(&record[40]);
+		directory_offset = read_u64(&record[48]);
+	}
+	RA_free(tail);
+	
+	if(directory_offset + directory_size > (u64) file_size) {
+		return;
+	}
+	u8* directory = RA_malloc(MAX(directory_size, 1));
+	if(directory == NULL) {
+		return;
+	}
+	if(RA_file_read_range(file, (s64) directory_offset, directory, (s64) directory_size) != RA_SUCCESS) {
+		RA_free(directory);
+		return;
+	}
+	
+	u64 offset = 0;
+	for(s64 i = 0; i < entry_count && i < record_count; i++) {
+		if(offset + 46 > directory_size || read_u32(&directory[offset]) != ZIP_CENTRAL_HEADER_SIGNATURE) {
+			break;
+		}
+		u8* header = &directory[offset];
+		u16 flags = read_u16(&header[8]);
+		u16 method = read_u16(&header[10]);
+		u64 compressed_size = read_u32(&header[20]);
+		u64 size = read_u32(&header[24]);
+		u16 name_size = read_u16(&header[28]);
+		u16 extra_size = read_u16(&header[30]);
+		u16 comment_size = read_u16(&header[32]);
+		u64 local_header_offset = read_u32(&header[42]);
+		if(offset + 46 + name_size + extra_size + comment_size > directory_size) {
+			break;
+		}
+		const char* name = (const char*) &header[46];
+		offset += 46 + name_size + extra_size + comment_size;
+		
+		// Fields that don't fit in 32 bits are in the zip64 extra field.
+		u8* extra = &header[46 + name_size];
+		for(u32 j = 0; j + 4 <= extra_size;) {
+			u16 id = read_u16(&extra[j]);
+			u16 field_size = read_u16(&extra[j + 2]);
+			if(id == 0x0001) {
+				u8* field = &extra[j + 4];
+				u8* field_end = field + MIN(field_size, extra_size - j - 4);
+				if(size == 0xffffffff && field + 8 <= field_end) {
+					size = read_u64(field);
+					field += 8;
+				}
+				if(compressed_size == 0xffffffff && field + 8 <= field_end) {
+					compressed_size = read_u64(field);
+					field += 8;
+				}
+				if(local_header_offset == 0xffffffff && field + 8 <= field_end) {
+					local_header_offset = read_u64(field);
+				}
+			}
+			j += 4 + field_size;
+		}
+		
+		// Make sure this is the entry libzip thinks it is.
+		zip_stat_t stat;
+		if(zip_stat_index(in_archive, i, 0, &stat) != 0 || !(stat.valid & ZIP_STAT_NAME)
+			|| strlen(stat.name) != name_size || memcmp(stat.name, name, name_size) != 0) {
+			continue;
+		}
+		
+		if(method != ZIP_CM_STORE || (flags & 1) || compressed_size != size) {
+			continue;
+		}
+		
+		u8 local_header[30];
+		if(RA_file_read_range(file, (s64) local_header_offset, local_header, sizeof(local_header)) != RA_SUCCESS
+			|| read_u32(local_header) != ZIP_LOCAL_HEADER_SIGNATURE) {
+			continue;
+		}
+		u64 data_offset = local_header_offset + 30 + read_u16(&local_header[26]) + read_u16(&local_header[28]);
+		if(data_offset + size > (u64) file_size) {
+			continue;
+		}
+		data_offsets[i] = (s64) data_offset;
+	}
+	
+	RA_free(directory);
+}
+
 typedef struct {
 	u32 offset;
 	u32 size;
@@ -615,6 +1676,12 @@ typedef struct {
 } RCMOD_DirEntry;
 #define RCMOD_DIRENTRY_SIZE_ON_DISK 0x12
 
+#define RCMOD_MAX_STRING_SIZE (1024 * 1024)
+
+// How much of an .rcmod file to read at once when looking for its strings or
+// for the asset headers.
+#define RCMOD_READ_SIZE (64 * 1024)
+
 static RA_Result parse_rcmod(RA_Mod* mod, const char* game_dir, const char* mod_file_name) {
 	memset(mod, 0, sizeof(RA_Mod));
 	RA_string_copy(mod->file_name, mod_file_name, sizeof(mod->file_name));
@@ -627,18 +1694,24 @@ static RA_Result parse_rcmod(RA_Mod* mod, const char* game_dir, const char* mod_
 		return RA_FAILURE("fopen");
 	}
 	
-	mod->name = read_rcmod_string(file);
-	mod->version = read_rcmod_string(file);
-	mod->description = read_rcmod_string(file);
-	mod->author = read_rcmod_string(file);
-	if(mod->name == NULL || mod->version == NULL || mod->description == NULL || mod->author == NULL) {
+	s64 file_size = RA_file_size(file);
+	RcmodHeader header;
+	if(file_size == -1 || read_rcmod_header(&header, file, file_size) != RA_SUCCESS) {
 		fclose(file);
-		free_mod(mod);
 		return RA_FAILURE("cannot read header");
 	}
-	
 	fclose(file);
 	
+	mod->name = copy_rcmod_string(header.name);
+	mod->version = copy_rcmod_string(header.version);
+	mod->description = copy_rcmod_string(header.description);
+	mod->author = copy_rcmod_string(header.author);
+	RA_free(header.data);
+	if(mod->name == NULL || mod->version == NULL || mod->description == NULL || mod->author == NULL) {
+		free_mod(mod);
+		return RA_FAILURE("cannot read header");
+	}
+	
 	mod->format = RA_MOD_FORMAT_RCMOD;
 	return RA_SUCCESS;
 }
@@ -657,71 +1730,90 @@ static RA_Result load_rcmod(RA_LoadedMod* dest, RA_Mod* src, const char* mod_pat
 		return RA_FAILURE("cannot determine file size");
 	}
 	
-	b8 name = skip_rcmod_string(file);
-	b8 version = skip_rcmod_string(file);
-	b8 description = skip_rcmod_string(file);
-	b8 author = skip_rcmod_string(file);
-	if(!name || !version || !description || !author) {
+	RcmodHeader header;
+	if(read_rcmod_header(&header, file, file_size) != RA_SUCCESS) {
 		fclose(file);
 		return RA_FAILURE("cannot read header");
 	}
-	
-	u32 directory_offset = 0;
-	if(fread(&directory_offset, 4, 1, file) != 1) {
-		return RA_FAILURE("cannot read header");
-	}
-	
-	dest->asset_count = (file_size - directory_offset) / RCMOD_DIRENTRY_SIZE_ON_DISK;
-	dest->assets = RA_calloc(dest->asset_count, sizeof(RA_LoadedModAsset));
-	if(dest->assets == NULL) {
+	RA_free(header.data);
+	if(header.directory_offset > file_size) {
+		fclose(file);
+		return RA_FAILURE("directory past end of file");
+	}
+	
+	dest->asset_count = (file_size - header.directory_offset) / RCMOD_DIRENTRY_SIZE_ON_DISK;
+	dest->assets = RA_calloc(MAX(dest->asset_count, 1), sizeof(RA_LoadedModAsset));
+	RCMOD_DirEntry* entries = RA_malloc(MAX(dest->asset_count, 1) * sizeof(RCMOD_DirEntry));
+	u8* buffer = RA_malloc(MAX(dest->asset_count * RCMOD_DIRENTRY_SIZE_ON_DISK, RCMOD_READ_SIZE));
+	u64* header_order = RA_malloc(MAX(dest->asset_count, 1) * sizeof(u64));
+	if(dest->assets == NULL || entries == NULL || buffer == NULL || header_order == NULL) {
+		if(header_order) RA_free(header_order);
+		if(buffer) RA_free(buffer);
+		if(entries) RA_free(entries);
+		if(dest->assets) RA_free(dest->assets);
 		fclose(file);
 		return RA_FAILURE("cannot allocate assets list");
 	}
 	
-	if(fseek(file, directory_offset, SEEK_SET) != 0) {
-		RA_free(dest->assets);
-		fclose(file);
-		return RA_FAILURE("cannot seek to directory entries");
-	}
-	RCMOD_DirEntry* entries = RA_malloc(dest->asset_count * sizeof(RCMOD_DirEntry));
-	if(entries == NULL) {
+	// Read the whole directory at once.
+	if(RA_file_read_range(file, header.directory_offset, buffer, dest->asset_count * RCMOD_DIRENTRY_SIZE_ON_DISK) != RA_SUCCESS) {
+		RA_free(header_order);
+		RA_free(buffer);
+		RA_free(entries);
 		RA_free(dest->assets);
 		fclose(file);
-		return RA_FAILURE("cannot allocate directory entries");
+		return RA_FAILURE("cannot read directory entries");
 	}
+	u32 header_count = 0;
 	for(u32 i = 0; i < dest->asset_count; i++) {
-		if(fread(&entries[i], RCMOD_DIRENTRY_SIZE_ON_DISK, 1, file) != 1) {
+		memcpy(&entries[i], &buffer[i * RCMOD_DIRENTRY_SIZE_ON_DISK], RCMOD_DIRENTRY_SIZE_ON_DISK);
+		if((entries[i].group % 8) == 0) {
+			header_order[header_count++] = (u64) entries[i].offset << 32 | i;
+		}
+	}
+	
+	// Read the asset headers in the order they appear in the file, so that
+	// headers that are close together can be picked out of the same read.
+	qsort(header_order, header_count, sizeof(u64), compare_u64);
+	s64 window_offset = -1;
+	s64 window_size = 0;
+	for(u32 i = 0; i < header_count; i++) {
+		u32 index = (u32) header_order[i];
+		s64 offset = entries[index].offset;
+		if(offset + (s64) sizeof(RA_TocAssetHeader) > file_size) {
+			RA_free(header_order);
+			RA_free(buffer);
 			RA_free(entries);
 			RA_free(dest->assets);
 			fclose(file);
-			return RA_FAILURE("cannot read directory entries");
+			return RA_FAILURE("can't read asset header");
 		}
-	}
-	
-	for(u32 i = 0; i < dest->asset_count; i++) {
-		s32 header_size = 0;
-		if((entries[i].group % 8) == 0) {
-			dest->assets[i].toc.has_header = true;
-			header_size = sizeof(RA_TocAssetHeader);
-			if(fseek(file, entries[i].offset, SEEK_SET) != 0) {
-				RA_free(entries);
-				RA_free(dest->assets);
-				fclose(file);
-				return RA_FAILURE("can't seek to asset header");
-			}
-			if(fread(&dest->assets[i].toc.header, sizeof(RA_TocAssetHeader), 1, file) != 1) {
+		if(window_offset == -1 || offset + (s64) sizeof(RA_TocAssetHeader) > window_offset + window_size) {
+			window_offset = offset;
+			window_size = MIN(file_size - offset, RCMOD_READ_SIZE);
+			if(RA_file_read_range(file, window_offset, buffer, window_size) != RA_SUCCESS) {
+				RA_free(header_order);
+				RA_free(buffer);
 				RA_free(entries);
 				RA_free(dest->assets);
 				fclose(file);
 				return RA_FAILURE("can't read asset header");
 			}
 		}
+		dest->assets[index].toc.has_header = true;
+		memcpy(&dest->assets[index].toc.header, &buffer[offset - window_offset], sizeof(RA_TocAssetHeader));
+	}
+	
+	for(u32 i = 0; i < dest->asset_count; i++) {
+		s32 header_size = dest->assets[i].toc.has_header ? sizeof(RA_TocAssetHeader) : 0;
 		dest->assets[i].toc.metadata.offset = entries[i].offset + header_size;
 		dest->assets[i].toc.metadata.size = entries[i].size - header_size;
 		dest->assets[i].toc.path_hash = entries[i].hash;
 		dest->assets[i].toc.group = entries[i].group;
 	}
 	
+	RA_free(header_order);
+	RA_free(buffer);
 	RA_free(entries);
 	fclose(file);
 	
@@ -733,41 +1825,81 @@ static RA_Result load_rcmod(RA_LoadedMod* dest, RA_Mod* src, const char* mod_pat
 	return RA_SUCCESS;
 }
 
-static char* read_rcmod_string(FILE* file) {
-	static char* scratchpad = NULL;
-	if(scratchpad == NULL) {
-		scratchpad = RA_malloc(1024 * 1024);
-		if(scratchpad == NULL) {
-			return NULL;
+// Read a block from the start of the file, and only read more if the strings
+// don't fit in it.
+static RA_Result read_rcmod_header(RcmodHeader* dest, FILE* file, s64 file_size) {
+	memset(dest, 0, sizeof(RcmodHeader));
+	
+	s64 max_size = MIN(file_size, 4 * RCMOD_MAX_STRING_SIZE + 4);
+	s64 size = 0;
+	u8* data = NULL;
+	for(s64 capacity = MIN(max_size, RCMOD_READ_SIZE);; capacity = MIN(capacity * 2, max_size)) {
+		u8* new_data = RA_malloc(MAX(capacity, 1));
+		if(new_data == NULL) {
+			if(data) {
+				RA_free(data);
+			}
+			return RA_FAILURE("cannot allocate header");
 		}
-	}
-	for(s32 i = 0; i < 1024 * 1024; i++) {
-		if(fread(&scratchpad[i], 1, 1, file) != 1) {
-			return NULL;
+		if(data) {
+			memcpy(new_data, data, size);
+			RA_free(data);
+		}
+		data = new_data;
+		if(RA_file_read_range(file, size, data + size, capacity - size) != RA_SUCCESS) {
+			RA_free(data);
+			return RA_FAILURE("cannot read header");
 		}
-		if(scratchpad[i] == '\0') {
-			char* string = RA_malloc(i + 1);
-			if(string == NULL) {
-				return NULL;
+		size = capacity;
+		
+		const char* strings[4];
+		s64 offset = 0;
+		u32 string_count = 0;
+		for(; string_count < 4; string_count++) {
+			u8* end = memchr(data + offset, '\0', MIN(size - offset, RCMOD_MAX_STRING_SIZE));
+			if(end == NULL) {
+				break;
 			}
-			memcpy(string, scratchpad, i + 1);
-			return string;
+			strings[string_count] = (const char*) data + offset;
+			offset = end - data + 1;
+		}
+		
+		if(string_count == 4 && offset + 4 <= size) {
+			dest->data = data;
+			dest->name = strings[0];
+			dest->version = strings[1];
+			dest->description = strings[2];
+			dest->author = strings[3];
+			memcpy(&dest->directory_offset, data + offset, 4);
+			return RA_SUCCESS;
+		}
+		
+		if(capacity == max_size) {
+			RA_free(data);
+			return RA_FAILURE("cannot read header");
 		}
 	}
-	return NULL;
 }
 
-static b8 skip_rcmod_string(FILE* file) {
-	for(s32 i = 0; i < 1024 * 1024; i++) {
-		char c;
-		if(fread(&c, 1, 1, file) != 1) {
-			return false;
-		}
-		if(c == '\0') {
-			return true;
-		}
+static char* copy_rcmod_string(const char* string) {
+	s64 size = strlen(string) + 1;
+	char* copy = RA_malloc(size);
+	if(copy != NULL) {
+		memcpy(copy, string, size);
+	}
+	return copy;
+}
+
+static int compare_u64(const void* lhs, const void* rhs) {
+	u64 lhs_value = *(const u64*) lhs;
+	u64 rhs_value = *(const u64*) rhs;
+	if(lhs_value < rhs_value) {
+		return -1;
+	} else if(lhs_value > rhs_value) {
+		return 1;
+	} else {
+		return 0;
 	}
-	return false;
 }
 
 static void build_texture_metadata(RA_TocTextureMeta* dest, RA_TextureHeader* src) {
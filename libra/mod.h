@@ -20,9 +20,38 @@ typedef struct {
 } RA_Mod;
 
 typedef void (ModLoadErrorFunc)(const char* file_name, RA_Result result);
-RA_Result RA_mod_list_load(RA_Mod** mods_dest, u32* mod_count_dest, const char* game_dir, ModLoadErrorFunc* error_func);
+
+// If cache_path isn't NULL, the metadata for each mod is cached there keyed by
+// file name, size and modification time, so that only mods that have changed
+// since the last call have to be opened. The cache is only written out again
+// if it has changed, and is ignored if it was written for another game folder.
+RA_Result RA_mod_list_load(RA_Mod** mods_dest, u32* mod_count_dest, const char* game_dir, const char* cache_path, ModLoadErrorFunc* error_func);
 void RA_mod_list_free(RA_Mod* mods, u32 mod_count);
 
-RA_Result RA_install_mods(RA_Mod* mods, u32 mod_count, RA_TableOfContents* toc, u32* success_count_dest, u32* fail_count_dest, const char* game_dir, ModLoadErrorFunc* error_func);
+// An asset that's provided by more than one of the mods that were installed.
+typedef struct {
+	u64 path_hash;
+	u32 group;
+	u32 mod_count;
+	u32* mod_indices; // Indices into the mod list in install order. The last one is the one that ends up in the TOC.
+} RA_ModConflict;
+
+typedef struct {
+	RA_ModConflict* conflicts;
+	u32 conflict_count;
+	RA_Arena arena;
+} RA_ModConflictList;
+
+typedef enum {
+	// Store the cache files for .stage mods as DSAR archives compressed with
+	// LZ4 instead of as plain files.
+	RA_INSTALL_COMPRESS_CACHE = 1 << 0
+} RA_InstallFlags;
+
+// If conflicts_dest isn't NULL, it's filled in with the assets that are
+// provided by more than one of the mods that were installed successfully. On
+// success it must be freed with RA_mod_conflict_list_free.
+RA_Result RA_install_mods(RA_Mod* mods, u32 mod_count, RA_TableOfContents* toc, u32* success_count_dest, u32* fail_count_dest, const char* game_dir, u32 flags, ModLoadErrorFunc* error_func, RA_ModConflictList* conflicts_dest);
+void RA_mod_conflict_list_free(RA_ModConflictList* conflicts);
 
 #endif
@@ -1,3 +1,7 @@
+#ifndef WIN32
+	#define _GNU_SOURCE // For copy_file_range.
+#endif
+
 #include "platform.h"
 
 #include <dirent.h>
@@ -9,12 +13,22 @@
 	#include <windows.h>
 #include <shellapi.h>
 	#include <io.h>
+	#include <sys/stat.h>
+	#include <sys/utime.h>
 #define popen _popen
 #define pclose _pclose
 #define setenv(name, value, overwrite) (_putenv_s(name, value) == 0 ? 0 : -1)
 #else
 	#include <unistd.h>
+	#include <time.h>
+	#include <pthread.h>
 	#include <sys/stat.h>
+	#include <fcntl.h>
+	#include <errno.h>
+	#include <sys/mman.h>
+	#ifdef __linux__
+		#include <sys/sendfile.h>
+	#endif
 #endif
 
 void RA_make_dir(const char* path) {
@@ -33,6 +47,128 @@ b8 RA_file_exists(const char* path) {
 #endif
 }
 
+RA_Result RA_file_stat(const char* path, RA_FileStat* stat_dest) {
+#ifdef WIN32
+	struct _stat64 info;
+	if(_stat64(path, &info) != 0) {
+		return RA_FAILURE("cannot stat '%s'", path);
+	}
+	stat_dest->size = info.st_size;
+	stat_dest->modified_time = (s64) info.st_mtime * 1000000000;
+#else
+	struct stat info;
+	if(stat(path, &info) != 0) {
+		return RA_FAILURE("cannot stat '%s'", path);
+	}
+	stat_dest->size = info.st_size;
+	stat_dest->modified_time = (s64) info.st_mtim.tv_sec * 1000000000 + info.st_mtim.tv_nsec;
+#endif
+	return RA_SUCCESS;
+}
+
+RA_Result RA_file_set_modified_time(const char* path, s64 modified_time) {
+#ifdef WIN32
+	struct _stat64 info;
+	if(_stat64(path, &info) != 0) {
+		return RA_FAILURE("cannot stat '%s'", path);
+	}
+	struct __utimbuf64 times;
+	times.actime = info.st_atime;
+	times.modtime = modified_time / 1000000000;
+	if(_utime64(path, &times) != 0) {
+		return RA_FAILURE("cannot set modified time of '%s'", path);
+	}
+#else
+	struct timespec times[2];
+	times[0].tv_sec = 0;
+	times[0].tv_nsec = UTIME_OMIT;
+	times[1].tv_sec = modified_time / 1000000000;
+	times[1].tv_nsec = modified_time % 1000000000;
+	if(utimensat(AT_FDCWD, path, times, 0) != 0) {
+		return RA_FAILURE("cannot set modified time of '%s'", path);
+	}
+#endif
+	return RA_SUCCESS;
+}
+
+static int seek_64(FILE* file, s64 offset) {
+#ifdef WIN32
+	return _fseeki64(file, offset, SEEK_SET);
+#else
+	return fseeko(file, (off_t) offset, SEEK_SET);
+#endif
+}
+
+RA_Result RA_file_read_range(FILE* file, s64 offset, void* dest, s64 size) {
+	if(seek_64(file, offset) != 0) {
+		return RA_FAILURE("cannot seek");
+	}
+	if(size > 0 && fread(dest, size, 1, file) != 1) {
+		return RA_FAILURE("cannot read");
+	}
+	return RA_SUCCESS;
+}
+
+RA_Result RA_file_copy_range(FILE* dest, FILE* src, s64 src_offset, s64 size, u8* buffer, s64 buffer_size) {
+	s64 copied = 0;
+
+#ifdef __linux__
+	// Let the kernel do the copy, so the data doesn't have to come through
+	// user space. The FILE buffers are bypassed, so they have to be flushed
+	// first and the position of dest has to be updated afterwards.
+	if(fflush(dest) == 0) {
+		int src_fd = fileno(src);
+		int dest_fd = fileno(dest);
+		off_t in_offset = (off_t) src_offset;
+		off_t out_offset = ftello(dest);
+		b8 use_sendfile = false;
+		while(copied < size && out_offset != -1) {
+			ssize_t bytes;
+			if(!use_sendfile) {
+				bytes = copy_file_range(src_fd, &in_offset, dest_fd, &out_offset, size - copied, 0);
+				if(bytes == -1 && (errno == ENOSYS || errno == EXDEV || errno == EINVAL || errno == EOPNOTSUPP)) {
+					// Not supported between these files, try sendfile instead.
+					use_sendfile = true;
+					continue;
+				}
+			} else {
+				if(lseek(dest_fd, out_offset, SEEK_SET) == -1) {
+					break;
+				}
+				bytes = sendfile(dest_fd, src_fd, &in_offset, size - copied);
+				if(bytes > 0) {
+					out_offset += bytes;
+				}
+			}
+			if(bytes <= 0) {
+				break;
+			}
+			copied += bytes;
+		}
+		if(out_offset == -1 || fseeko(dest, out_offset, SEEK_SET) != 0) {
+			return RA_FAILURE("cannot seek");
+		}
+	}
+#endif
+	
+	// Copy whatever's left through the buffer.
+	while(copied < size) {
+		s64 chunk_size = MIN(size - copied, buffer_size);
+		if(seek_64(src, src_offset + copied) != 0) {
+			return RA_FAILURE("cannot seek");
+		}
+		if(fread(buffer, chunk_size, 1, src) != 1) {
+			return RA_FAILURE("cannot read");
+		}
+		if(fwrite(buffer, chunk_size, 1, dest) != 1) {
+			return RA_FAILURE("cannot write");
+		}
+		copied += chunk_size;
+	}
+	
+	return RA_SUCCESS;
+}
+
 RA_Result RA_enumerate_directory(RA_StringList* file_names_dest, const char* dir_path) {
 	RA_Result result;
 	RA_string_list_create(file_names_dest);
@@ -79,6 +215,275 @@ void RA_thread_sleep_ms(s32 milliseconds) {
 	#endif
 }
 
+s64 RA_time_ns() {
+	#ifdef WIN32
+		LARGE_INTEGER counter;
+		LARGE_INTEGER frequency;
+		QueryPerformanceCounter(&counter);
+		QueryPerformanceFrequency(&frequency);
+		return (s64) ((double) counter.QuadPart * 1000000000.0 / (double) frequency.QuadPart);
+	#else
+		struct timespec time;
+		clock_gettime(CLOCK_MONOTONIC, &time);
+		return (s64) time.tv_sec * 1000000000 + time.tv_nsec;
+	#endif
+}
+
+void* RA_virtual_reserve(s64 size) {
+#ifdef WIN32
+	return VirtualAlloc(NULL, (SIZE_T) size, MEM_RESERVE, PAGE_NOACCESS);
+#else
+	int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+	#ifdef MAP_NORESERVE
+		flags |= MAP_NORESERVE;
+	#endif
+	void* ptr = mmap(NULL, (size_t) size, PROT_NONE, flags, -1, 0);
+	return ptr != MAP_FAILED ? ptr : NULL;
+#endif
+}
+
+RA_Result RA_virtual_commit(void* ptr, s64 size) {
+#ifdef WIN32
+	if(VirtualAlloc(ptr, (SIZE_T) size, MEM_COMMIT, PAGE_READWRITE) == NULL) {
+		return RA_FAILURE("VirtualAlloc failed");
+	}
+#else
+	if(mprotect(ptr, (size_t) size, PROT_READ | PROT_WRITE) != 0) {
+		return RA_FAILURE("mprotect failed");
+	}
+#endif
+	return RA_SUCCESS;
+}
+
+void RA_virtual_release(void* ptr, s64 size) {
+#ifdef WIN32
+	VirtualFree(ptr, 0, MEM_RELEASE);
+#else
+	munmap(ptr, (size_t) size);
+#endif
+}
+
+s64 RA_virtual_page_size() {
+#ifdef WIN32
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	return info.dwPageSize;
+#else
+	return sysconf(_SC_PAGESIZE);
+#endif
+}
+
+struct t_RA_Thread {
+#ifdef WIN32
+	HANDLE handle;
+#else
+	pthread_t thread;
+#endif
+	RA_ThreadFunc* func;
+	void* user;
+};
+
+#ifdef WIN32
+static DWORD WINAPI thread_entry(LPVOID param) {
+	RA_Thread* thread = param;
+	thread->func(thread->user);
+	return 0;
+}
+#else
+static void* thread_entry(void* param) {
+	RA_Thread* thread = param;
+	thread->func(thread->user);
+	return NULL;
+}
+#endif
+
+RA_Result RA_thread_create(RA_Thread** thread_dest, RA_ThreadFunc* func, void* user) {
+	RA_Thread* thread = RA_calloc(1, sizeof(RA_Thread));
+	if(thread == NULL) {
+		return RA_FAILURE("cannot allocate thread");
+	}
+	thread->func = func;
+	thread->user = user;
+#ifdef WIN32
+	thread->handle = CreateThread(NULL, 0, thread_entry, thread, 0, NULL);
+	if(thread->handle == NULL) {
+		RA_free(thread);
+		return RA_FAILURE("CreateThread failed");
+	}
+#else
+	if(pthread_create(&thread->thread, NULL, thread_entry, thread) != 0) {
+		RA_free(thread);
+		return RA_FAILURE("pthread_create failed");
+	}
+#endif
+	*thread_dest = thread;
+	return RA_SUCCESS;
+}
+
+void RA_thread_join(RA_Thread* thread) {
+#ifdef WIN32
+	WaitForSingleObject(thread->handle, INFINITE);
+	CloseHandle(thread->handle);
+#else
+	pthread_join(thread->thread, NULL);
+#endif
+	RA_free(thread);
+}
+
+s32 RA_processor_count() {
+#ifdef WIN32
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	return MAX((s32) info.dwNumberOfProcessors, 1);
+#else
+	return MAX((s32) sysconf(_SC_NPROCESSORS_ONLN), 1);
+#endif
+}
+
+#define MAX_PARALLEL_FOR_THREADS 64
+
+typedef struct {
+	RA_ParallelForFunc* func;
+	void* user;
+	u32 begin;
+	u32 end;
+} ParallelForChunk;
+
+static void parallel_for_thread(void* user) {
+	ParallelForChunk* chunk = user;
+	chunk->func(chunk->begin, chunk->end, chunk->user);
+}
+
+void RA_parallel_for(u32 count, u32 min_chunk_size, RA_ParallelForFunc* func, void* user) {
+	s32 chunk_count = MIN(RA_processor_count(), MAX_PARALLEL_FOR_THREADS);
+	chunk_count = MIN(chunk_count, (s32) (count / MAX(min_chunk_size, 1)));
+	if(chunk_count <= 1) {
+		func(0, count, user);
+		return;
+	}
+	
+	ParallelForChunk chunks[MAX_PARALLEL_FOR_THREADS];
+	RA_Thread* threads[MAX_PARALLEL_FOR_THREADS];
+	for(s32 i = 0; i < chunk_count; i++) {
+		chunks[i].func = func;
+		chunks[i].user = user;
+		chunks[i].begin = (u32) ((u64) count * i / chunk_count);
+		chunks[i].end = (u32) ((u64) count * (i + 1) / chunk_count);
+	}
+	
+	// Run the first chunk on the calling thread, and any chunks that couldn't
+	// get a thread of their own.
+	for(s32 i = 1; i < chunk_count; i++) {
+		if(RA_thread_create(&threads[i], parallel_for_thread, &chunks[i]) != RA_SUCCESS) {
+			threads[i] = NULL;
+		}
+	}
+	func(chunks[0].begin, chunks[0].end, user);
+	for(s32 i = 1; i < chunk_count; i++) {
+		if(threads[i] != NULL) {
+			RA_thread_join(threads[i]);
+		} else {
+			func(chunks[i].begin, chunks[i].end, user);
+		}
+	}
+}
+
+struct t_RA_Mutex {
+#ifdef WIN32
+	SRWLOCK lock;
+#else
+	pthread_mutex_t mutex;
+#endif
+};
+
+RA_Mutex* RA_mutex_create() {
+	RA_Mutex* mutex = RA_calloc(1, sizeof(RA_Mutex));
+	if(mutex == NULL) {
+		return NULL;
+	}
+#ifdef WIN32
+	InitializeSRWLock(&mutex->lock);
+#else
+	pthread_mutex_init(&mutex->mutex, NULL);
+#endif
+	return mutex;
+}
+
+void RA_mutex_destroy(RA_Mutex* mutex) {
+#ifndef WIN32
+	pthread_mutex_destroy(&mutex->mutex);
+#endif
+	RA_free(mutex);
+}
+
+void RA_mutex_lock(RA_Mutex* mutex) {
+#ifdef WIN32
+	AcquireSRWLockExclusive(&mutex->lock);
+#else
+	pthread_mutex_lock(&mutex->mutex);
+#endif
+}
+
+void RA_mutex_unlock(RA_Mutex* mutex) {
+#ifdef WIN32
+	ReleaseSRWLockExclusive(&mutex->lock);
+#else
+	pthread_mutex_unlock(&mutex->mutex);
+#endif
+}
+
+struct t_RA_CondVar {
+#ifdef WIN32
+	CONDITION_VARIABLE condvar;
+#else
+	pthread_cond_t condvar;
+#endif
+};
+
+RA_CondVar* RA_condvar_create() {
+	RA_CondVar* condvar = RA_calloc(1, sizeof(RA_CondVar));
+	if(condvar == NULL) {
+		return NULL;
+	}
+#ifdef WIN32
+	InitializeConditionVariable(&condvar->condvar);
+#else
+	pthread_cond_init(&condvar->condvar, NULL);
+#endif
+	return condvar;
+}
+
+void RA_condvar_destroy(RA_CondVar* condvar) {
+#ifndef WIN32
+	pthread_cond_destroy(&condvar->condvar);
+#endif
+	RA_free(condvar);
+}
+
+void RA_condvar_wait(RA_CondVar* condvar, RA_Mutex* mutex) {
+#ifdef WIN32
+	SleepConditionVariableSRW(&condvar->condvar, &mutex->lock, INFINITE, 0);
+#else
+	pthread_cond_wait(&condvar->condvar, &mutex->mutex);
+#endif
+}
+
+void RA_condvar_signal(RA_CondVar* condvar) {
+#ifdef WIN32
+	WakeConditionVariable(&condvar->condvar);
+#else
+	pthread_cond_signal(&condvar->condvar);
+#endif
+}
+
+void RA_condvar_broadcast(RA_CondVar* condvar) {
+#ifdef WIN32
+	WakeAllConditionVariable(&condvar->condvar);
+#else
+	pthread_cond_broadcast(&condvar->condvar);
+#endif
+}
+
 void RA_message_box(MessageBoxType type, const char* title, const char* format, ...) {
 	va_list args;
 	va_start(args, format);
@@ -6,9 +6,73 @@
 
 void RA_make_dir(const char* path);
 b8 RA_file_exists(const char* path);
+
+typedef struct {
+	s64 size;
+	s64 modified_time; // In nanoseconds since the epoch, if the filesystem records it that precisely.
+} RA_FileStat;
+
+RA_Result RA_file_stat(const char* path, RA_FileStat* stat_dest);
+RA_Result RA_file_set_modified_time(const char* path, s64 modified_time);
+
+// Read part of a file, including past the first 2 GiB on Windows.
+RA_Result RA_file_read_range(FILE* file, s64 offset, void* dest, s64 size);
+
+// Copy part of src to the current position in dest. On Linux the kernel does
+// the copy if it can, otherwise it goes through the buffer.
+RA_Result RA_file_copy_range(FILE* dest, FILE* src, s64 src_offset, s64 size, u8* buffer, s64 buffer_size);
 RA_Result RA_enumerate_directory(RA_StringList* file_names_dest, const char* dir_path);
 void RA_open_file_path_or_url(const char* path_or_url);
 void RA_thread_sleep_ms(s32 milliseconds);
+s64 RA_time_ns(); // Monotonic clock, for timing things.
+
+// Virtual memory
+
+// Reserve a range of address space without backing it with memory. Pages have
+// to be committed before they can be touched. Returns NULL on failure.
+void* RA_virtual_reserve(s64 size);
+RA_Result RA_virtual_commit(void* ptr, s64 size);
+void RA_virtual_release(void* ptr, s64 size); // Size must be the size that was reserved.
+s64 RA_virtual_page_size();
+
+// Threads
+
+typedef struct t_RA_Thread RA_Thread;
+typedef struct t_RA_Mutex RA_Mutex;
+typedef struct t_RA_CondVar RA_CondVar;
+typedef void RA_ThreadFunc(void* user);
+
+RA_Result RA_thread_create(RA_Thread** thread_dest, RA_ThreadFunc* func, void* user);
+void RA_thread_join(RA_Thread* thread); // Also frees the thread.
+s32 RA_processor_count();
+
+// Split the range [0, count) into chunks of at least min_chunk_size elements
+// and process them on multiple threads. Returns when all the chunks are done.
+typedef void RA_ParallelForFunc(u32 begin, u32 end, void* user);
+void RA_parallel_for(u32 count, u32 min_chunk_size, RA_ParallelForFunc* func, void* user);
+
+// Atomic read-modify-write operations. They return the previous value.
+#ifdef _MSC_VER
+	#include <intrin.h>
+	#define RA_atomic_fetch_or_u64(dest, value) ((u64) _InterlockedOr64((volatile long long*) (dest), (long long) (value)))
+	#define RA_atomic_fetch_add_u32(dest, value) ((u32) _InterlockedExchangeAdd((volatile long*) (dest), (long) (value)))
+#else
+	#define RA_atomic_fetch_or_u64(dest, value) __atomic_fetch_or((dest), (value), __ATOMIC_RELAXED)
+	#define RA_atomic_fetch_add_u32(dest, value) __atomic_fetch_add((dest), (value), __ATOMIC_RELAXED)
+#endif
+
+RA_Mutex* RA_mutex_create();
+void RA_mutex_destroy(RA_Mutex* mutex);
+void RA_mutex_lock(RA_Mutex* mutex);
+void RA_mutex_unlock(RA_Mutex* mutex);
+
+RA_CondVar* RA_condvar_create();
+void RA_condvar_destroy(RA_CondVar* condvar);
+void RA_condvar_wait(RA_CondVar* condvar, RA_Mutex* mutex);
+void RA_condvar_signal(RA_CondVar* condvar);
+void RA_condvar_broadcast(RA_CondVar* condvar);
+
+// GUI
 
 typedef enum {
 	GUI_MESSAGE_BOX_INFO,
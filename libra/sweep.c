@@ -0,0 +1,347 @@
+#include "sweep.h"
+
+#include <dirent.h>
+#include <stdarg.h>
+#include <sys/stat.h>
+
+#include "platform.h"
+
+// How many jobs can be waiting to be processed or delivered per worker thread.
+#define JOBS_PER_THREAD 64
+
+typedef enum {
+	JOB_FREE,
+	JOB_QUEUED,
+	JOB_RUNNING,
+	JOB_DONE,
+	JOB_DELIVERED
+} JobState;
+
+struct t_RA_SweepJob {
+	JobState state;
+	char* path;
+	char* output;
+	s64 output_size;
+	s64 output_capacity;
+	RA_Result result;
+	RA_Error error;
+	char error_message[1024];
+};
+
+typedef struct {
+	RA_SweepOptions* options;
+	s32 thread_count;
+	RA_SweepJob* jobs; // Ring buffer indexed by sequence number.
+	u32 job_count;
+	u64 head; // Next sequence number to be queued.
+	u64 next; // Next sequence number to be processed.
+	u64 tail; // Oldest sequence number that hasn't been delivered.
+	b8 finished_enumerating;
+	RA_Mutex* mutex;
+	RA_CondVar* work_available;
+	RA_CondVar* job_done;
+} Sweep;
+
+static void free_sweep(Sweep* sweep, RA_Thread** threads);
+static RA_Result enumerate(Sweep* sweep, const char* dir_path);
+static void enqueue(Sweep* sweep, const char* path);
+static void worker_thread(void* user);
+static void run_job(Sweep* sweep, RA_SweepJob* job);
+static b8 deliver_ready_jobs(Sweep* sweep);
+static void deliver(Sweep* sweep, RA_SweepJob* job);
+
+RA_Result RA_sweep(const char* dir_path, RA_SweepOptions* options) {
+	RA_Result result;
+	
+	Sweep sweep = {0};
+	sweep.options = options;
+	sweep.thread_count = options->thread_count > 0 ? options->thread_count : RA_processor_count();
+	
+	if(sweep.thread_count == 1) {
+		// Process everything on the calling thread.
+		sweep.jobs = RA_calloc(1, sizeof(RA_SweepJob));
+		if(sweep.jobs == NULL) {
+			return RA_FAILURE("cannot allocate job");
+		}
+		sweep.job_count = 1;
+		result = enumerate(&sweep, dir_path);
+		RA_free(sweep.jobs[0].output);
+		RA_free(sweep.jobs);
+		return result;
+	}
+	
+	sweep.job_count = sweep.thread_count * JOBS_PER_THREAD;
+	sweep.jobs = RA_calloc(sweep.job_count, sizeof(RA_SweepJob));
+	sweep.mutex = RA_mutex_create();
+	sweep.work_available = RA_condvar_create();
+	sweep.job_done = RA_condvar_create();
+	RA_Thread** threads = RA_calloc(sweep.thread_count, sizeof(RA_Thread*));
+	if(sweep.jobs == NULL || sweep.mutex == NULL || sweep.work_available == NULL || sweep.job_done == NULL || threads == NULL) {
+		free_sweep(&sweep, threads);
+		return RA_FAILURE("cannot allocate sweep");
+	}
+	
+	s32 threads_started = 0;
+	for(; threads_started < sweep.thread_count; threads_started++) {
+		if(RA_thread_create(&threads[threads_started], worker_thread, &sweep) != RA_SUCCESS) {
+			break;
+		}
+	}
+	
+	char error_message[1024] = {0};
+	if(threads_started == 0) {
+		RA_string_copy(error_message, "cannot create worker threads", sizeof(error_message));
+	} else if((result = enumerate(&sweep, dir_path)) != RA_SUCCESS) {
+		// Worker threads have their own error message buffers, but the result
+		// callbacks may still overwrite this one.
+		RA_string_copy(error_message, result->message, sizeof(error_message));
+	}
+	
+	// Wait for the remaining jobs to finish.
+	RA_mutex_lock(sweep.mutex);
+	sweep.finished_enumerating = true;
+	RA_condvar_broadcast(sweep.work_available);
+	while(sweep.tail < sweep.head) {
+		if(!deliver_ready_jobs(&sweep)) {
+			RA_condvar_wait(sweep.job_done, sweep.mutex);
+		}
+	}
+	RA_mutex_unlock(sweep.mutex);
+	
+	for(s32 i = 0; i < threads_started; i++) {
+		RA_thread_join(threads[i]);
+	}
+	
+	free_sweep(&sweep, threads);
+	
+	if(error_message[0] != '\0') {
+		return RA_FAILURE("%s", error_message);
+	}
+	
+	return RA_SUCCESS;
+}
+
+static void free_sweep(Sweep* sweep, RA_Thread** threads) {
+	if(sweep->jobs) {
+		for(u32 i = 0; i < sweep->job_count; i++) {
+			RA_free(sweep->jobs[i].output);
+		}
+		RA_free(sweep->jobs);
+	}
+	if(threads) {
+		RA_free(threads);
+	}
+	if(sweep->job_done) {
+		RA_condvar_destroy(sweep->job_done);
+	}
+	if(sweep->work_available) {
+		RA_condvar_destroy(sweep->work_available);
+	}
+	if(sweep->mutex) {
+		RA_mutex_destroy(sweep->mutex);
+	}
+}
+
+static RA_Result enumerate(Sweep* sweep, const char* dir_path) {
+	RA_Result result;
+	
+	DIR* directory = opendir(dir_path);
+	if(directory == NULL) {
+		return RA_FAILURE("cannot open directory '%s'", dir_path);
+	}
+	struct dirent* entry;
+	while((entry = readdir(directory)) != NULL) {
+		if(strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) {
+			continue;
+		}
+		char path[4096];
+		snprintf(path, sizeof(path), "%s/%s", dir_path, entry->d_name);
+		b8 is_dir = entry->d_type == DT_DIR;
+		b8 is_file = entry->d_type == DT_REG;
+		if(entry->d_type == DT_UNKNOWN || entry->d_type == DT_LNK) {
+			// Some filesystems don't fill in the type, and symlinks have to be
+			// followed to find out what they point to.
+			struct stat info;
+			if(stat(path, &info) == 0) {
+				is_dir = S_ISDIR(info.st_mode);
+				is_file = S_ISREG(info.st_mode);
+			}
+		}
+		if(is_dir) {
+			if(sweep->options->recursive && (result = enumerate(sweep, path)) != RA_SUCCESS) {
+				closedir(directory);
+				return result;
+			}
+		} else if(is_file) {
+			enqueue(sweep, path);
+		}
+	}
+	closedir(directory);
+	return RA_SUCCESS;
+}
+
+static void enqueue(Sweep* sweep, const char* path) {
+	s64 path_size = strlen(path) + 1;
+	
+	if(sweep->thread_count == 1) {
+		RA_SweepJob* job = &sweep->jobs[0];
+		job->path = (char*) path;
+		run_job(sweep, job);
+		deliver(sweep, job);
+		return;
+	}
+	
+	RA_mutex_lock(sweep->mutex);
+	
+	// If the queue is full, deliver results to make room.
+	while(sweep->head - sweep->tail >= sweep->job_count) {
+		if(!deliver_ready_jobs(sweep)) {
+			RA_condvar_wait(sweep->job_done, sweep->mutex);
+		}
+	}
+	
+	RA_SweepJob* job = &sweep->jobs[sweep->head % sweep->job_count];
+	job->path = RA_malloc(path_size);
+	if(job->path == NULL) {
+		fprintf(stderr, "RA_sweep: Failed to allocate memory.\n");
+		abort();
+	}
+	memcpy(job->path, path, path_size);
+	job->state = JOB_QUEUED;
+	sweep->head++;
+	
+	RA_condvar_signal(sweep->work_available);
+	RA_mutex_unlock(sweep->mutex);
+}
+
+static void worker_thread(void* user) {
+	Sweep* sweep = user;
+	
+	RA_mutex_lock(sweep->mutex);
+	for(;;) {
+		while(sweep->next == sweep->head && !sweep->finished_enumerating) {
+			RA_condvar_wait(sweep->work_available, sweep->mutex);
+		}
+		if(sweep->next == sweep->head) {
+			break;
+		}
+		RA_SweepJob* job = &sweep->jobs[sweep->next % sweep->job_count];
+		sweep->next++;
+		job->state = JOB_RUNNING;
+		RA_mutex_unlock(sweep->mutex);
+		
+		run_job(sweep, job);
+		
+		RA_mutex_lock(sweep->mutex);
+		job->state = JOB_DONE;
+		RA_condvar_signal(sweep->job_done);
+	}
+	RA_mutex_unlock(sweep->mutex);
+}
+
+static void run_job(Sweep* sweep, RA_SweepJob* job) {
+	job->output_size = 0;
+	RA_Result result = sweep->options->process(job, job->path, sweep->options->user);
+	if(result != RA_SUCCESS) {
+		// The error message is only valid until the next error on this thread.
+		RA_string_copy(job->error_message, result->message, sizeof(job->error_message));
+		job->error.message = job->error_message;
+		job->error.line = result->line;
+		job->result = &job->error;
+	} else {
+		job->result = RA_SUCCESS;
+	}
+}
+
+// Called with the mutex locked. Unlocks it while the result callback is
+// running. Returns true if any jobs were delivered.
+static b8 deliver_ready_jobs(Sweep* sweep) {
+	b8 delivered = false;
+	if(sweep->options->ordered) {
+		while(sweep->tail < sweep->head) {
+			RA_SweepJob* job = &sweep->jobs[sweep->tail % sweep->job_count];
+			if(job->state != JOB_DONE) {
+				break;
+			}
+			RA_mutex_unlock(sweep->mutex);
+			deliver(sweep, job);
+			RA_mutex_lock(sweep->mutex);
+			RA_free(job->path);
+			job->state = JOB_FREE;
+			sweep->tail++;
+			delivered = true;
+		}
+	} else {
+		for(u64 i = sweep->tail; i < sweep->head; i++) {
+			RA_SweepJob* job = &sweep->jobs[i % sweep->job_count];
+			if(job->state == JOB_DONE) {
+				RA_mutex_unlock(sweep->mutex);
+				deliver(sweep, job);
+				RA_mutex_lock(sweep->mutex);
+				job->state = JOB_DELIVERED;
+				delivered = true;
+			}
+		}
+		while(sweep->tail < sweep->head) {
+			RA_SweepJob* job = &sweep->jobs[sweep->tail % sweep->job_count];
+			if(job->state != JOB_DELIVERED) {
+				break;
+			}
+			RA_free(job->path);
+			job->state = JOB_FREE;
+			sweep->tail++;
+		}
+	}
+	return delivered;
+}
+
+static void deliver(Sweep* sweep, RA_SweepJob* job) {
+	RA_SweepResult result;
+	result.path = job->path;
+	result.output = job->output_size > 0 ? job->output : "";
+	result.output_size = job->output_size;
+	result.result = job->result;
+	if(sweep->options->result) {
+		sweep->options->result(&result, sweep->options->user);
+	} else if(result.output_size > 0) {
+		fwrite(result.output, result.output_size, 1, stdout);
+	}
+}
+
+void RA_sweep_printf(RA_SweepJob* job, const char* format, ...) {
+	va_list args;
+	va_start(args, format);
+	
+	if(job == NULL) {
+		vprintf(format, args);
+		va_end(args);
+		return;
+	}
+	
+	va_list args_copy;
+	va_copy(args_copy, args);
+	s32 size = vsnprintf(NULL, 0, format, args_copy);
+	va_end(args_copy);
+	
+	if(size > 0) {
+		if(job->output_size + size + 1 > job->output_capacity) {
+			s64 new_capacity = MAX(job->output_capacity * 2, job->output_size + size + 1);
+			new_capacity = MAX(new_capacity, 1024);
+			char* new_output = RA_malloc(new_capacity);
+			if(new_output == NULL) {
+				fprintf(stderr, "RA_sweep_printf: Failed to allocate memory.\n");
+				abort();
+			}
+			if(job->output_size > 0) {
+				memcpy(new_output, job->output, job->output_size);
+			}
+			RA_free(job->output);
+			job->output = new_output;
+			job->output_capacity = new_capacity;
+		}
+		vsnprintf(job->output + job->output_size, size + 1, format, args);
+		job->output_size += size;
+	}
+	
+	va_end(args);
+}
@@ -0,0 +1,46 @@
+#ifndef LIBRA_SWEEP_H
+#define LIBRA_SWEEP_H
+
+#include "util.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Run a function on every file in a directory tree using a pool of worker
+// threads. The directory is enumerated on the calling thread which feeds a
+// bounded queue, and the results are delivered back on the calling thread,
+// either in the order the files were enumerated or as soon as they're ready.
+
+struct t_RA_SweepJob;
+typedef struct t_RA_SweepJob RA_SweepJob;
+
+typedef struct {
+	const char* path;
+	const char* output; // Everything passed to RA_sweep_printf for this file.
+	s64 output_size;
+	RA_Result result;
+} RA_SweepResult;
+
+typedef RA_Result RA_SweepProcessFunc(RA_SweepJob* job, const char* path, void* user);
+typedef void RA_SweepResultFunc(RA_SweepResult* result, void* user);
+
+typedef struct {
+	s32 thread_count; // 0 for one per processor, 1 to do everything on the calling thread.
+	b8 recursive;
+	b8 ordered; // Deliver the results in the order the files were found.
+	RA_SweepProcessFunc* process; // Called on a worker thread.
+	RA_SweepResultFunc* result; // Called on the calling thread. If NULL the output is written to stdout.
+	void* user;
+} RA_SweepOptions;
+
+RA_Result RA_sweep(const char* dir_path, RA_SweepOptions* options);
+
+// Buffer output for the current file, or if job is NULL print it directly.
+void RA_sweep_printf(RA_SweepJob* job, const char* format, ...);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
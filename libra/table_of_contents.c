@@ -182,36 +182,50 @@ RA_Result RA_toc_build(RA_TableOfContents* toc, u8** data_dest, s64* size_dest)
 		}
 	}
 	
-	RA_DatWriter* writer = RA_dat_writer_begin(RA_ASSET_TYPE_TOC, 0x8);
+	RA_DatWriter* writer = RA_dat_writer_begin_direct(RA_ASSET_TYPE_TOC, 0x8);
 	if(writer == NULL) {
 		return RA_FAILURE("cannot allocate dat writer");
 	}
 	
-	RA_TocAssetGroup* asset_groups = RA_dat_writer_lump(writer, LUMP_ARCHIVE_TOC_HEADER, group_count * sizeof(RA_TocAssetGroup));
-	u64* asset_ids = RA_dat_writer_lump(writer, LUMP_ARCHIVE_TOC_ASSET_IDS, toc->asset_count * sizeof(u64));
-	RA_TocAssetMetadata* asset_metadata = RA_dat_writer_lump(writer, LUMP_ARCHIVE_TOC_ASSET_METADATA, toc->asset_count * sizeof(RA_TocAssetMetadata));
-	RA_TocArchive* archives = RA_dat_writer_lump(writer, LUMP_ARCHIVE_TOC_FILE_METADATA, toc->archive_count * sizeof(RA_TocArchive));
-	u64* texture_asset_ids = RA_dat_writer_lump(writer, LUMP_ARCHIVE_TOC_TEXTURE_ASSET_IDS, texture_count * sizeof(u64));
-	RA_TocTextureMeta* texture_meta = RA_dat_writer_lump(writer, LUMP_ARCHIVE_TOC_TEXTURE_META, texture_count * sizeof(RA_TocTextureMeta));
-	u32* texture_header = RA_dat_writer_lump(writer, LUMP_ARCHIVE_TOC_TEXTURE_HEADER, 4);
-	RA_TocAssetHeader* asset_headers = RA_dat_writer_lump(writer, LUMP_ARCHIVE_TOC_ASSET_HEADER_DATA, header_count * sizeof(RA_TocAssetHeader));
+	s32 asset_groups_lump = RA_dat_writer_declare_lump(writer, LUMP_ARCHIVE_TOC_HEADER, group_count * sizeof(RA_TocAssetGroup));
+	s32 asset_ids_lump = RA_dat_writer_declare_lump(writer, LUMP_ARCHIVE_TOC_ASSET_IDS, toc->asset_count * sizeof(u64));
+	s32 asset_metadata_lump = RA_dat_writer_declare_lump(writer, LUMP_ARCHIVE_TOC_ASSET_METADATA, toc->asset_count * sizeof(RA_TocAssetMetadata));
+	s32 archives_lump = RA_dat_writer_declare_lump(writer, LUMP_ARCHIVE_TOC_FILE_METADATA, toc->archive_count * sizeof(RA_TocArchive));
+	s32 texture_asset_ids_lump = RA_dat_writer_declare_lump(writer, LUMP_ARCHIVE_TOC_TEXTURE_ASSET_IDS, texture_count * sizeof(u64));
+	s32 texture_meta_lump = RA_dat_writer_declare_lump(writer, LUMP_ARCHIVE_TOC_TEXTURE_META, texture_count * sizeof(RA_TocTextureMeta));
+	s32 texture_header_lump = RA_dat_writer_declare_lump(writer, LUMP_ARCHIVE_TOC_TEXTURE_HEADER, 4);
+	s32 asset_headers_lump = RA_dat_writer_declare_lump(writer, LUMP_ARCHIVE_TOC_ASSET_HEADER_DATA, header_count * sizeof(RA_TocAssetHeader));
 	u32 archive_toc_string_offset = RA_dat_writer_string(writer, "ArchiveTOC");
 	
-	b8 allocation_failed =
-		asset_groups == NULL ||
-		asset_ids == NULL ||
-		asset_metadata == NULL ||
-		archives == NULL ||
-		texture_asset_ids == NULL ||
-		texture_meta == NULL ||
-		texture_header == NULL ||
-		asset_headers == NULL ||
+	b8 declaration_failed =
+		asset_groups_lump < 0 ||
+		asset_ids_lump < 0 ||
+		asset_metadata_lump < 0 ||
+		archives_lump < 0 ||
+		texture_asset_ids_lump < 0 ||
+		texture_meta_lump < 0 ||
+		texture_header_lump < 0 ||
+		asset_headers_lump < 0 ||
 		archive_toc_string_offset == 0;
-	if(allocation_failed) {
+	if(declaration_failed) {
 		RA_dat_writer_abort(writer);
-		return RA_FAILURE("cannot allocate lumps");
+		return RA_FAILURE("cannot declare lumps");
 	}
 	
+	if((result = RA_dat_writer_allocate(writer, NULL)) != RA_SUCCESS) {
+		RA_dat_writer_abort(writer);
+		return RA_FAILURE(result->message);
+	}
+	
+	RA_TocAssetGroup* asset_groups = RA_dat_writer_lump_data(writer, asset_groups_lump);
+	u64* asset_ids = RA_dat_writer_lump_data(writer, asset_ids_lump);
+	RA_TocAssetMetadata* asset_metadata = RA_dat_writer_lump_data(writer, asset_metadata_lump);
+	RA_TocArchive* archives = RA_dat_writer_lump_data(writer, archives_lump);
+	u64* texture_asset_ids = RA_dat_writer_lump_data(writer, texture_asset_ids_lump);
+	RA_TocTextureMeta* texture_meta = RA_dat_writer_lump_data(writer, texture_meta_lump);
+	u32* texture_header = RA_dat_writer_lump_data(writer, texture_header_lump);
+	RA_TocAssetHeader* asset_headers = RA_dat_writer_lump_data(writer, asset_headers_lump);
+	
 	memset(asset_groups, 0, group_count * sizeof(RA_TocAssetGroup));
 	u32 last_group = 0;
 	u32 group_begin = 0;
@@ -220,6 +234,7 @@ RA_Result RA_toc_build(RA_TableOfContents* toc, u8** data_dest, s64* size_dest)
 		if(i == toc->asset_count || toc->assets[i].group != last_group) {
 			while(asset_group_top != last_group) {
 				if(asset_group_top > last_group) {
+					RA_dat_writer_abort(writer);
 					return RA_FAILURE("asset group index mismatch");
 				}
 				asset_groups[asset_group_top].first_index = group_begin;
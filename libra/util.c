@@ -5,19 +5,31 @@
 
 #include "platform.h"
 
+#if defined(__x86_64__) || defined(_M_X64)
+	#define RA_X86_64
+	#ifdef _MSC_VER
+		#include <intrin.h>
+		#include <immintrin.h>
+		#define RA_TARGET_AVX2
+	#else
+		#include <immintrin.h>
+		#define RA_TARGET_AVX2 __attribute__((target("avx2")))
+	#endif
+#endif
+
 RA_Result RA_failure(int line, const char* format, ...) {
 	va_list args;
 	va_start(args, format);
 	
-	static char message[16 * 1024];
+	static RA_THREAD_LOCAL char message[16 * 1024];
 	vsnprintf(message, 16 * 1024, format, args);
 	
 	// Copy it just in case one of the variadic arguments is a pointer to the
 	// last error message.
-	static char message_copy[16 * 1024];
+	static RA_THREAD_LOCAL char message_copy[16 * 1024];
 	RA_string_copy(message_copy, message, sizeof(message_copy));
 	
-	static RA_Error error;
+	static RA_THREAD_LOCAL RA_Error error;
 	memset(&error, 0, sizeof(RA_Error));
 	error.message = message_copy;
 	error.line = line;
@@ -213,25 +225,147 @@ void RA_crc_string_parse(RA_CRCString* crc_string, u8* file_data, u32 file_size)
 	}
 }
 
-RA_Result RA_diff_buffers(const u8* lhs, u32 lhs_size, const u8* rhs, u32 rhs_size, const char* context, b8 print_hex_dump_on_failure) {
-	u32 min_size = MIN(lhs_size, rhs_size);
-	u32 max_size = MAX(lhs_size, rhs_size);
-	
-	u32 diff_offset = UINT32_MAX;
-	for(u32 i = 0; i < min_size; i++) {
+static u32 count_trailing_zeros(u32 value) {
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanForward(&index, value);
+	return (u32) index;
+#else
+	return (u32) __builtin_ctz(value);
+#endif
+}
+
+static u32 find_first_difference_scalar(const u8* lhs, const u8* rhs, u32 size) {
+	u32 i = 0;
+	for(; i + 8 <= size; i += 8) {
+		u64 lhs_word;
+		u64 rhs_word;
+		memcpy(&lhs_word, lhs + i, 8);
+		memcpy(&rhs_word, rhs + i, 8);
+		if(lhs_word != rhs_word) {
+			break;
+		}
+	}
+	for(; i < size; i++) {
 		if(lhs[i] != rhs[i]) {
-			diff_offset = i;
+			return i;
+		}
+	}
+	return size;
+}
+
+#ifdef RA_X86_64
+
+static u32 find_first_difference_sse2(const u8* lhs, const u8* rhs, u32 size) {
+	u32 i = 0;
+	for(; i + 64 <= size; i += 64) {
+		__m128i eq_0 = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*) (lhs + i)), _mm_loadu_si128((const __m128i*) (rhs + i)));
+		__m128i eq_1 = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*) (lhs + i + 16)), _mm_loadu_si128((const __m128i*) (rhs + i + 16)));
+		__m128i eq_2 = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*) (lhs + i + 32)), _mm_loadu_si128((const __m128i*) (rhs + i + 32)));
+		__m128i eq_3 = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*) (lhs + i + 48)), _mm_loadu_si128((const __m128i*) (rhs + i + 48)));
+		__m128i eq = _mm_and_si128(_mm_and_si128(eq_0, eq_1), _mm_and_si128(eq_2, eq_3));
+		if(_mm_movemask_epi8(eq) != 0xffff) {
 			break;
 		}
 	}
-	
-	if(diff_offset == UINT32_MAX) {
-		if(lhs_size == rhs_size) {
-			return RA_SUCCESS;
-		} else {
-			diff_offset = min_size;
+	for(; i + 16 <= size; i += 16) {
+		__m128i eq = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*) (lhs + i)), _mm_loadu_si128((const __m128i*) (rhs + i)));
+		u32 mask = (u32) _mm_movemask_epi8(eq);
+		if(mask != 0xffff) {
+			return i + count_trailing_zeros(~mask);
 		}
 	}
+	return i + find_first_difference_scalar(lhs + i, rhs + i, size - i);
+}
+
+RA_TARGET_AVX2 static u32 find_first_difference_avx2(const u8* lhs, const u8* rhs, u32 size) {
+	u32 i = 0;
+	for(; i + 128 <= size; i += 128) {
+		__m256i eq_0 = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*) (lhs + i)), _mm256_loadu_si256((const __m256i*) (rhs + i)));
+		__m256i eq_1 = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*) (lhs + i + 32)), _mm256_loadu_si256((const __m256i*) (rhs + i + 32)));
+		__m256i eq_2 = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*) (lhs + i + 64)), _mm256_loadu_si256((const __m256i*) (rhs + i + 64)));
+		__m256i eq_3 = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*) (lhs + i + 96)), _mm256_loadu_si256((const __m256i*) (rhs + i + 96)));
+		__m256i eq = _mm256_and_si256(_mm256_and_si256(eq_0, eq_1), _mm256_and_si256(eq_2, eq_3));
+		if((u32) _mm256_movemask_epi8(eq) != 0xffffffff) {
+			break;
+		}
+	}
+	for(; i + 32 <= size; i += 32) {
+		__m256i eq = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*) (lhs + i)), _mm256_loadu_si256((const __m256i*) (rhs + i)));
+		u32 mask = (u32) _mm256_movemask_epi8(eq);
+		if(mask != 0xffffffff) {
+			return i + count_trailing_zeros(~mask);
+		}
+	}
+	return i + find_first_difference_sse2(lhs + i, rhs + i, size - i);
+}
+
+static b8 cpu_supports_avx2() {
+#ifdef _MSC_VER
+	int info[4];
+	__cpuid(info, 0);
+	if(info[0] < 7) {
+		return false;
+	}
+	// Check that the OS saves the AVX registers as well as the CPU having them.
+	__cpuid(info, 1);
+	if((info[2] & (1 << 27)) == 0 || (info[2] & (1 << 28)) == 0) {
+		return false;
+	}
+	if((_xgetbv(0) & 6) != 6) {
+		return false;
+	}
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1 << 5)) != 0;
+#else
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif
+
+typedef u32 FindFirstDifferenceFunc(const u8* lhs, const u8* rhs, u32 size);
+
+static FindFirstDifferenceFunc* find_first_difference_impl = NULL;
+
+void RA_set_simd_level(RA_SimdLevel level) {
+	switch(level) {
+#ifdef RA_X86_64
+		case RA_SIMD_AVX2: {
+			if(cpu_supports_avx2()) {
+				find_first_difference_impl = find_first_difference_avx2;
+				break;
+			}
+		} // fallthrough
+		case RA_SIMD_SSE2: {
+			find_first_difference_impl = find_first_difference_sse2;
+			break;
+		}
+#endif
+		default: {
+			find_first_difference_impl = find_first_difference_scalar;
+		}
+	}
+}
+
+u32 RA_find_first_difference(const u8* lhs, const u8* rhs, u32 size) {
+	// Racing on this is harmless since every thread would pick the same
+	// implementation.
+	if(find_first_difference_impl == NULL) {
+		RA_set_simd_level(RA_SIMD_AVX2);
+	}
+	return find_first_difference_impl(lhs, rhs, size);
+}
+
+RA_Result RA_diff_buffers(const u8* lhs, u32 lhs_size, const u8* rhs, u32 rhs_size, const char* context, b8 print_hex_dump_on_failure) {
+	u32 min_size = MIN(lhs_size, rhs_size);
+	u32 max_size = MAX(lhs_size, rhs_size);
+	
+	u32 diff_offset = RA_find_first_difference(lhs, rhs, min_size);
+	if(diff_offset == min_size && lhs_size == rhs_size) {
+		return RA_SUCCESS;
+	}
 	
 	RA_Result error = RA_FAILURE("%s differs at offset %x", context, diff_offset);
 	if(!print_hex_dump_on_failure) {
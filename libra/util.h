@@ -39,6 +39,14 @@ typedef float f64;
 
 typedef bool b8;
 
+#if defined(__cplusplus)
+	#define RA_THREAD_LOCAL thread_local
+#elif defined(_MSC_VER)
+	#define RA_THREAD_LOCAL __declspec(thread)
+#else
+	#define RA_THREAD_LOCAL _Thread_local
+#endif
+
 typedef struct {
 	const char* message;
 	int line;
@@ -46,7 +54,7 @@ typedef struct {
 typedef RA_Error* RA_Result;
 #define RA_SUCCESS NULL
 #define RA_FAILURE(...) RA_failure(__LINE__, __VA_ARGS__)
-RA_Result RA_failure(int line, const char* format, ...);
+RA_Result RA_failure(int line, const char* format, ...); // The error is stored per thread.
 
 #define MIN(x, y) (((y) < (x)) ? (y) : (x))
 #define MAX(x, y) (((y) > (x)) ? (y) : (x))
@@ -103,6 +111,17 @@ void RA_crc_string_parse(RA_CRCString* crc_string, u8* file_data, u32 file_size)
 #endif
 #define RA_ASSERT_SIZE(type, size) __maybe_unused static char assert_size_ ##type[(sizeof(type) == size) ? 1 : -1]
 
+typedef enum {
+	RA_SIMD_NONE,
+	RA_SIMD_SSE2,
+	RA_SIMD_AVX2
+} RA_SimdLevel;
+
+// The best level the CPU supports is used by default. Falls back to a lower
+// level if the requested one isn't available.
+void RA_set_simd_level(RA_SimdLevel level);
+
+u32 RA_find_first_difference(const u8* lhs, const u8* rhs, u32 size); // Returns size if the buffers are equal.
 RA_Result RA_diff_buffers(const u8* lhs, u32 lhs_size, const u8* rhs, u32 rhs_size, const char* context, b8 print_hex_dump_on_failure);
 
 #ifdef __cplusplus
@@ -10,14 +10,17 @@ static int window_height;
 
 static char bin_dir[RA_MAX_PATH];
 static char settings_path[RA_MAX_PATH];
+static char mod_cache_path[RA_MAX_PATH];
 static Settings settings;
 static RA_Mod* mods;
 static u32 mod_count;
+static RA_ModConflictList conflicts;
 static char filter[1024];
 
 static void update(f32 frame_time);
 static void draw_gui();
 static void mod_list();
+static void conflict_list();
 static void refresh();
 static void install_mods();
 static void no_game_folder_message();
@@ -32,6 +35,9 @@ int main(int argc, char** argv) {
 	if(snprintf(settings_path, sizeof(settings_path), "%s/settings.json", bin_dir) < 0) {
 		RA_message_box(GUI_MESSAGE_BOX_ERROR, "Error", "Settings file path too long.");
 	}
+	if(snprintf(mod_cache_path, sizeof(mod_cache_path), "%s/modcache.json", bin_dir) < 0) {
+		RA_message_box(GUI_MESSAGE_BOX_ERROR, "Error", "Mod cache file path too long.");
+	}
 	
 	if(RA_file_exists(settings_path)) {
 		if((result = GUI_settings_read(&settings, settings_path)) != RA_SUCCESS) {
@@ -98,6 +104,13 @@ static void draw_gui() {
 		refresh();
 	}
 	
+	if(conflicts.conflict_count > 0) {
+		igSameLine(0.f, -1.f);
+		if(igButton("Conflicts", (ImVec2) {0, 0})) {
+			igOpenPopup_Str("Conflicts", ImGuiPopupFlags_None);
+		}
+	}
+	
 	igSameLine(0.f, -1.f);
 	if(igButton("···", (ImVec2) {0, 0})) {
 		igOpenPopup_Str("more_buttons", ImGuiPopupFlags_None);
@@ -140,6 +153,8 @@ static void draw_gui() {
 		igEndPopup();
 	}
 	
+	conflict_list();
+	
 	if(GUI_settings_draw(&settings, window_width, window_height)) {
 		if((result = GUI_settings_write(&settings, settings_path)) == RA_SUCCESS) {
 			if(settings.game_dir_valid) {
@@ -187,6 +202,43 @@ static void mod_list() {
 	igEndChild();
 }
 
+static void conflict_list() {
+	ImVec2 zero = {0, 0};
+	ImVec2 size = {800.f, 400.f};
+	ImVec2 pos = {(window_width - size.x) / 2.f, (window_height - size.y) / 2.f};
+	igSetNextWindowPos(pos, ImGuiCond_Always, zero);
+	igSetNextWindowSize(size, ImGuiCond_Always);
+	if(igBeginPopupModal("Conflicts", NULL, ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoCollapse)) {
+		igTextWrapped("These assets are provided by more than one mod. The mod listed last is the one that gets installed.");
+		
+		f32 button_height = igGetFont()->FontSize + igGetStyle()->FramePadding.y * 2.f;
+		igBeginChild_Str("conflicts", (ImVec2) {0, -(button_height + igGetStyle()->ItemSpacing.y)}, false, ImGuiWindowFlags_None);
+		ImGuiTableFlags flags = ImGuiTableFlags_RowBg | ImGuiTableFlags_Resizable;
+		if(igBeginTable("conflict_table", 3, flags, (ImVec2) {0.f, 0.f}, 0.f)) {
+			for(u32 i = 0; i < conflicts.conflict_count; i++) {
+				RA_ModConflict* conflict = &conflicts.conflicts[i];
+				igTableNextRow(ImGuiTableFlags_None, 0.f);
+				igTableNextColumn();
+				igText("%016" PRIx64, conflict->path_hash);
+				igTableNextColumn();
+				igText("Group %u", conflict->group);
+				igTableNextColumn();
+				for(u32 j = 0; j < conflict->mod_count; j++) {
+					igText("%s", mods[conflict->mod_indices[j]].file_name);
+				}
+			}
+			igEndTable();
+		}
+		igEndChild();
+		
+		if(igButton("Close", zero)) {
+			igCloseCurrentPopup();
+		}
+		
+		igEndPopup();
+	}
+}
+
 static void report_mod_load_error(const char* file_name, RA_Result result) {
 	if(result != RA_SUCCESS) {
 		RA_message_box(GUI_MESSAGE_BOX_ERROR, "Error", "Failed to load mod '%s' (%s).", file_name, result->message);
@@ -196,12 +248,14 @@ static void report_mod_load_error(const char* file_name, RA_Result result) {
 static void refresh() {
 	RA_Result result;
 	
+	// The conflicts refer to mods by their index in the list.
+	RA_mod_conflict_list_free(&conflicts);
 	if(mods != NULL) {
 		RA_mod_list_free(mods, mod_count);
 	}
 	if(settings.game_dir_valid) {
 		create_mod_dir();
-		if((result = RA_mod_list_load(&mods, &mod_count, settings.game_dir, report_mod_load_error))) {
+		if((result = RA_mod_list_load(&mods, &mod_count, settings.game_dir, mod_cache_path, report_mod_load_error))) {
 			RA_message_box(GUI_MESSAGE_BOX_ERROR, "Error", "Failed to load mod list (%s).", result->message);
 			mods = NULL;
 			mod_count = 0;
@@ -266,7 +320,9 @@ static void install_mods() {
 	
 	u32 success_count;
 	u32 fail_count;
-	if((result = RA_install_mods(mods, mod_count, &toc, &success_count, &fail_count, settings.game_dir, report_mod_install_error)) != RA_SUCCESS) {
+	u32 install_flags = settings.compress_mod_cache ? RA_INSTALL_COMPRESS_CACHE : 0;
+	RA_mod_conflict_list_free(&conflicts);
+	if((result = RA_install_mods(mods, mod_count, &toc, &success_count, &fail_count, settings.game_dir, install_flags, report_mod_install_error, &conflicts)) != RA_SUCCESS) {
 		RA_message_box(GUI_MESSAGE_BOX_ERROR, "Error", "Failed to install mods (%s). The table of contents has not been modified.\n", result->message);
 		RA_toc_free(&toc, FREE_FILE_DATA);
 		return;
@@ -295,6 +351,11 @@ static void install_mods() {
 			fail_count, fail_count == 1 ? "" : "s");
 	}
 	
+	if(conflicts.conflict_count > 0) {
+		RA_message_box(GUI_MESSAGE_BOX_INFO, "Conflicts", "%u asset%s provided by more than one mod. Click on 'Conflicts' to see which.",
+			conflicts.conflict_count, conflicts.conflict_count == 1 ? " is" : "s are");
+	}
+	
 	RA_free(out_data);
 	RA_toc_free(&toc, FREE_FILE_DATA);
 }
@@ -1,31 +1,52 @@
-#include <filesystem>
-
 #include "libra/dat_container.h"
+#include "libra/sweep.h"
 
-namespace fs = std::filesystem;
+static RA_Result process_file(RA_SweepJob* job, const char* path, void* user);
 
 int main(int argc, char** argv) {
 	RA_Result result;
 	
-	if(argc != 2) {
-		printf("usage: ./printlumpcrcs <asset dir>\n");
+	RA_SweepOptions options = {};
+	options.thread_count = 1;
+	options.recursive = true;
+	options.ordered = true;
+	options.process = process_file;
+	
+	const char* dir = NULL;
+	for(int i = 1; i < argc; i++) {
+		if(strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+			options.thread_count = atoi(argv[++i]);
+		} else if(dir == NULL) {
+			dir = argv[i];
+		} else {
+			dir = NULL;
+			break;
+		}
+	}
+	
+	if(dir == NULL) {
+		printf("usage: ./printlumpcrcs [-j <threads>] <asset dir>\n");
 		return 1;
 	}
 	
-	for(const auto& dir_entry : fs::recursive_directory_iterator(argv[1])) {
-		if(!dir_entry.is_regular_file()) {
-			continue;
-		}
-		
-		RA_DatFile dat;
-		if((result = RA_dat_read(&dat, dir_entry.path().string().c_str(), 0)) != RA_SUCCESS) {
-			continue;
-		}
-		
-		for(u32 i = 0; i < dat.lump_count; i++) {
-			printf("%08x\n", dat.lumps[i].type_crc);
-		}
-		
-		RA_dat_free(&dat, FREE_FILE_DATA);
+	if((result = RA_sweep(dir, &options)) != RA_SUCCESS) {
+		fprintf(stderr, "error: %s\n", result->message);
+		return 1;
 	}
 }
+
+static RA_Result process_file(RA_SweepJob* job, const char* path, void* user) {
+	RA_Result result;
+	
+	RA_DatFile dat;
+	if((result = RA_dat_read(&dat, path, 0)) != RA_SUCCESS) {
+		return RA_SUCCESS;
+	}
+	
+	for(u32 i = 0; i < dat.lump_count; i++) {
+		RA_sweep_printf(job, "%08x\n", dat.lumps[i].type_crc);
+	}
+	
+	RA_dat_free(&dat, FREE_FILE_DATA);
+	return RA_SUCCESS;
+}
@@ -21,13 +21,23 @@ static void report_mod_install_error(const char* file_name, RA_Result result) {
 int main(int argc, char** argv) {
 	RA_Result result;
 	
-	if(argc != 2) {
+	const char* game_dir = NULL;
+	u32 install_flags = 0;
+	for(int i = 1; i < argc; i++) {
+		if(strcmp(argv[i], "--compress-cache") == 0) {
+			install_flags |= RA_INSTALL_COMPRESS_CACHE;
+		} else if(game_dir == NULL) {
+			game_dir = argv[i];
+		} else {
+			print_help();
+			return 1;
+		}
+	}
+	if(game_dir == NULL) {
 		print_help();
 		return 1;
 	}
 	
-	const char* game_dir = argv[1];
-	
 	char toc_path[RA_MAX_PATH];
 	snprintf(toc_path, RA_MAX_PATH, "%s/toc", game_dir);
 	char toc_backup_path[RA_MAX_PATH];
@@ -66,7 +76,7 @@ int main(int argc, char** argv) {
 	
 	RA_Mod* mods;
 	u32 mod_count;
-	if((result = RA_mod_list_load(&mods, &mod_count, game_dir, report_mod_load_error)) != RA_SUCCESS) {
+	if((result = RA_mod_list_load(&mods, &mod_count, game_dir, NULL, report_mod_load_error)) != RA_SUCCESS) {
 		fprintf(stderr, "error: Failed to load mods (%s). The table of contents has not been modified.\n", result->message);
 		return 1;
 	}
@@ -78,11 +88,21 @@ int main(int argc, char** argv) {
 	
 	u32 success_count;
 	u32 fail_count;
-	if((result = RA_install_mods(mods, mod_count, &toc, &success_count, &fail_count, game_dir, report_mod_install_error)) != RA_SUCCESS) {
+	RA_ModConflictList conflicts;
+	if((result = RA_install_mods(mods, mod_count, &toc, &success_count, &fail_count, game_dir, install_flags, report_mod_install_error, &conflicts)) != RA_SUCCESS) {
 		fprintf(stderr, "error: Failed to install mods (%s). The table of contents has not been modified.\n", result->message);
 		return 1;
 	}
 	
+	for(u32 i = 0; i < conflicts.conflict_count; i++) {
+		RA_ModConflict* conflict = &conflicts.conflicts[i];
+		printf("Conflict: Asset %016" PRIx64 " in group %u is provided by", conflict->path_hash, conflict->group);
+		for(u32 j = 0; j < conflict->mod_count; j++) {
+			printf("%s %s", j == 0 ? "" : ",", mods[conflict->mod_indices[j]].file_name);
+		}
+		printf(", the last one wins.\n");
+	}
+	
 	u8* out_data;
 	s64 out_size;
 	if((result = RA_toc_build(&toc, &out_data, &out_size)) != RA_SUCCESS) {
@@ -97,6 +117,7 @@ int main(int argc, char** argv) {
 	
 	printf("%u mods installed successfully, %u mods failed to install.\n", success_count, fail_count);
 	
+	RA_mod_conflict_list_free(&conflicts);
 	RA_free(out_data);
 	RA_mod_list_free(mods, mod_count);
 	RA_toc_free(&toc, FREE_FILE_DATA);
@@ -106,5 +127,7 @@ static void print_help() {
 	puts("rebuildtoc -- part of https://github.com/chaoticgd/ripped_apart");
 	puts("  Rebuild the toc (table of contents) file based on the contents of the mod directory.");
 	puts("");
-	puts("Usage: ./rebuildtoc <game directory>");
+	puts("Usage: ./rebuildtoc <game directory> [--compress-cache]");
+	puts("");
+	puts("With --compress-cache, the mod cache files are written as LZ4 compressed DSAR archives.");
 }
@@ -0,0 +1,97 @@
+#include "../libra/util.h"
+#include "../libra/platform.h"
+#include "../libra/dependency_dag.h"
+
+static void benchmark_find_first_difference();
+static void benchmark_dag_lookup_asset();
+
+int main(int argc, const char** argv) {
+	benchmark_find_first_difference();
+	benchmark_dag_lookup_asset();
+}
+
+static void benchmark_find_first_difference() {
+	const u32 size = 256 * 1024 * 1024;
+	const s32 iterations = 8;
+	
+	u8* lhs = RA_malloc(size);
+	u8* rhs = RA_malloc(size);
+	if(lhs == NULL || rhs == NULL) {
+		fprintf(stderr, "error: Failed to allocate buffers.\n");
+		exit(1);
+	}
+	for(u32 i = 0; i < size; i++) {
+		lhs[i] = (u8) (i * 2654435761u >> 24);
+	}
+	memcpy(rhs, lhs, size);
+	
+	// Put the difference right at the end so the whole buffer is scanned.
+	rhs[size - 1] ^= 1;
+	
+	const char* names[] = {"scalar", "sse2", "avx2"};
+	RA_SimdLevel levels[] = {RA_SIMD_NONE, RA_SIMD_SSE2, RA_SIMD_AVX2};
+	for(u32 i = 0; i < ARRAY_SIZE(levels); i++) {
+		RA_set_simd_level(levels[i]);
+		s64 begin = RA_time_ns();
+		for(s32 j = 0; j < iterations; j++) {
+			if(RA_find_first_difference(lhs, rhs, size) != size - 1) {
+				fprintf(stderr, "error: RA_find_first_difference (%s) returned the wrong offset.\n", names[i]);
+				exit(1);
+			}
+		}
+		s64 end = RA_time_ns();
+		double seconds = (double) (end - begin) / 1000000000.0;
+		double gigabytes = (double) size * 2 * iterations / (1024.0 * 1024.0 * 1024.0);
+		printf("RA_find_first_difference (%s): %.2f GiB/s\n", names[i], gigabytes / seconds);
+	}
+	
+	RA_free(lhs);
+	RA_free(rhs);
+}
+
+static void benchmark_dag_lookup_asset() {
+	// Roughly the number of assets in the game.
+	const u32 asset_count = 750000;
+	const u32 lookup_count = 1000000;
+	
+	RA_DependencyDag dag = {0};
+	RA_arena_create(&dag.arena);
+	dag.assets = RA_arena_calloc(&dag.arena, asset_count, sizeof(RA_DependencyDagAsset));
+	dag.asset_count = asset_count;
+	if(dag.assets == NULL) {
+		fprintf(stderr, "error: Failed to allocate assets.\n");
+		exit(1);
+	}
+	for(u32 i = 0; i < asset_count; i++) {
+		char name[128];
+		snprintf(name, sizeof(name), "characters/hero/hero_%u/hero_%u.model", i / 16, i);
+		dag.assets[i].name_crc = RA_crc64_path(name);
+	}
+	
+	s64 build_begin = RA_time_ns();
+	if(RA_dag_build_lookup_table(&dag) != RA_SUCCESS) {
+		fprintf(stderr, "error: Failed to build lookup table.\n");
+		exit(1);
+	}
+	s64 build_end = RA_time_ns();
+	printf("RA_dag_build_lookup_table (%u assets): %.2f ms\n", asset_count, (double) (build_end - build_begin) / 1000000.0);
+	
+	// Look up assets in a scattered order, with every eighth one missing.
+	u32 found = 0;
+	u32 index = 0;
+	s64 lookup_begin = RA_time_ns();
+	for(u32 i = 0; i < lookup_count; i++) {
+		index = (index + 7919) % asset_count;
+		u64 name_crc = dag.assets[index].name_crc;
+		if(i % 8 == 0) {
+			name_crc = ~name_crc;
+		}
+		if(RA_dag_lookup_asset(&dag, name_crc) != NULL) {
+			found++;
+		}
+	}
+	s64 lookup_end = RA_time_ns();
+	printf("RA_dag_lookup_asset (%u lookups, %u hits): %.2f ns per lookup\n", lookup_count, found, (double) (lookup_end - lookup_begin) / lookup_count);
+	
+	RA_dag_free(&dag, false);
+}
@@ -3,67 +3,287 @@
 #include "../libra/dependency_dag.h"
 #include "../libra/table_of_contents.h"
 #include "../libra/material.h"
+#include "../libra/sweep.h"
+#include "../libra/dag_schedule.h"
+#include "../libra/archive.h"
+#include "../libra/mod.h"
+#include "../libra/platform.h"
+#include "../libra/texture.h"
 
-#include <dirent.h>
+// A file to be put in a zip archive by write_test_zip. Deflated files are
+// written as uncompressed deflate blocks, which is enough to make libzip have
+// to read them.
+typedef struct {
+	const char* name;
+	const u8* data;
+	u32 size;
+	b8 deflate;
+} TestZipEntry;
 
-static RA_Result test_file(const char* path);
-static RA_Result test_dat_file(u8* data, u32 size);
+static RA_Result test_file(RA_SweepJob* job, const char* path, void* user);
+static void print_test_result(RA_SweepResult* result, void* user);
+static RA_Result test_dat_file(RA_SweepJob* job, u8* data, u32 size);
 static RA_Result test_toc_file(u8* data, u32 size);
 static RA_Result test_dag_file(u8* data, u32 size);
-static RA_Result test_material_file(RA_DatFile* dat);
+static RA_Result test_material_file(RA_SweepJob* job, RA_DatFile* dat);
 static RA_Result test_toc_lookup_asset();
+static RA_Result test_dat_writer_string_sharing();
+static RA_Result test_dat_peek_lump();
+static RA_Result test_find_first_difference();
+static RA_Result test_crc64_path();
+static RA_Result test_dag_reverse_index();
+static RA_Result test_dag_editing();
+static RA_Result test_dag_rename_asset();
+static RA_Result test_dag_view();
+static RA_Result test_dag_reachable();
+static RA_Result test_dag_reachable_parallel();
+static RA_Result test_dag_schedule();
+static RA_Result schedule_fail_asset_40(RA_DagJob* job, s32 asset_index, void* user);
+static RA_Result test_arena_rewind();
+static RA_Result test_contiguous_arena();
+static RA_Result test_archive_writer();
+static RA_Result test_archive_writer_round_trip(u8* data, s64 size, s32 thread_count, u32* random);
+static RA_Result test_install_stored_entries();
+static RA_Result test_install_many_mods();
+static RA_Result test_install_reuses_cache();
+static RA_Result install_cached_test_mod(const u8* asset, u32 asset_size, u32 flags, b8 expect_reused);
+static RA_Result test_install_headerless();
+static RA_Result test_install_rcmod();
+static RA_Result test_install_conflicts();
+static RA_Result test_install_texture();
+static RA_Result test_mod_list_cache();
+static RA_Result load_cached_test_mod_list(const char* game_dir, const char* expected_names[3], u32 expected_count);
+static RA_Result check_test_mod_list_cache(u32 step);
+static RA_Result write_test_mod_info(const char* file_name, const char* name);
+static RA_Result check_test_texture_meta(RA_TableOfContents* toc, u64 path_hash, RA_TextureHeader* expected);
+static RA_Result check_stored_entries(RA_TableOfContents* toc, u8* asset_1, u32 asset_1_size, u8* asset_2, u32 asset_2_size);
+static RA_Result create_test_game_dir();
+static void delete_test_game_dir();
+static RA_Result install_test_mods(RA_TableOfContents* toc, RA_Mod** mods_dest, u32* mod_count_dest, u32 flags, RA_ModConflictList* conflicts_dest);
+static void report_test_mod_error(const char* file_name, RA_Result result);
+static RA_Result check_test_asset(RA_TableOfContents* toc, u64 path_hash, u32 group, const char* archive_path, b8 has_header, const u8* data, u32 size);
+static RA_TocAsset* find_test_asset(RA_TableOfContents* toc, u64 path_hash, u32 group);
+static RA_Result write_test_zip(const char* path, TestZipEntry* entries, u32 entry_count, b8 zip64);
+static RA_Result build_test_texture(u8** data_dest, u32* size_dest, u32 header_offset, RA_TextureHeader* texture_header);
+static RA_Result write_test_file(const char* path, const u8* data, s64 size);
+static void fill_test_data(u8* data, s64 size, u32 seed);
+static void put_u16(u8* dest, u16 value);
+static void put_u32(u8* dest, u32 value);
+static void put_u64(u8* dest, u64 value);
+
+// Hex dumps are printed directly to stdout, so only do that when running
+// single threaded.
+static b8 print_hex_dumps = true;
+
+// The mod tests install mods into a fake game folder in the working directory.
+#define TEST_GAME_DIR "test_game"
+#define TEST_CACHE_PATH TEST_GAME_DIR "/modcache/cached.stage.cache"
+
+// The first error reported by RA_mod_list_load or RA_install_mods.
+static char test_mod_error[1024];
 
 int main(int argc, const char** argv) {
 	RA_Result result;
 	
-	const char* directory_path;
-	if(argc == 2) {
-		directory_path = argv[1];
-	} else if(argc == 0 || argc == 1) {
+	RA_SweepOptions options = {0};
+	options.thread_count = 1;
+	options.ordered = true;
+	options.process = test_file;
+	options.result = print_test_result;
+	
+	const char* directory_path = NULL;
+	for(int i = 1; i < argc; i++) {
+		if(strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+			options.thread_count = atoi(argv[++i]);
+		} else if(directory_path == NULL) {
+			directory_path = argv[i];
+		} else {
+			fprintf(stderr, "usage: ./bin/test [-j <threads>] [dir]\n");
+			return 1;
+		}
+	}
+	if(directory_path == NULL) {
 		directory_path = "testdata";
-	} else {
-		fprintf(stderr, "usage: ./bin/test [dir]\n");
-		return 1;
 	}
+	print_hex_dumps = options.thread_count == 1;
 	
-	DIR* directory = opendir(directory_path);
-	if(!directory) {
+	if((result = RA_sweep(directory_path, &options)) != RA_SUCCESS) {
 		fprintf(stderr, "error: Failed to enumerate testdata directory.\n");
 		return 2;
 	}
 	
-	struct dirent* entry;
-	while((entry = readdir(directory)) != NULL) {
-		if(entry->d_type == DT_REG) {
-			char file_path[1024];
-			snprintf(file_path, 1024, "%s/%s", directory_path, entry->d_name);
-			
-			if((result = test_file(file_path)) == RA_SUCCESS) {
-				printf("success\n");
-			} else {
-				printf("%s\n", result->message);
-			}
-		}
-	}
-	
 	printf("RA_toc_lookup_asset: ");
 	if((result = test_toc_lookup_asset()) == RA_SUCCESS) {
 		printf("success\n");
 	} else {
 		printf("%s\n", result->message);
 	}
+	
+	printf("RA_dat_writer_string sharing: ");
+	if((result = test_dat_writer_string_sharing()) == RA_SUCCESS) {
+		printf("success\n");
+	} else {
+		printf("%s\n", result->message);
+	}
+	
+	printf("RA_dat_peek_lump: ");
+	if((result = test_dat_peek_lump()) == RA_SUCCESS) {
+		printf("success\n");
+	} else {
+		printf("%s\n", result->message);
+	}
+	
+	printf("RA_find_first_difference: ");
+	if((result = test_find_first_difference()) == RA_SUCCESS) {
+		printf("success\n");
+	} else {
+		printf("%s\n", result->message);
+	}
+	
+	printf("RA_crc64_path: ");
+	if((result = test_crc64_path()) == RA_SUCCESS) {
+		printf("success\n");
+	} else {
+		printf("%s\n", result->message);
+	}
+	
+	printf("RA_dag_build_reverse_index: ");
+	if((result = test_dag_reverse_index()) == RA_SUCCESS) {
+		printf("success\n");
+	} else {
+		printf("%s\n", result->message);
+	}
+	
+	printf("RA_dag_build_incremental: ");
+	if((result = test_dag_editing()) == RA_SUCCESS) {
+		printf("success\n");
+	} else {
+		printf("%s\n", result->message);
+	}
+	
+	printf("RA_dag_rename_asset: ");
+	if((result = test_dag_rename_asset()) == RA_SUCCESS) {
+		printf("success\n");
+	} else {
+		printf("%s\n", result->message);
+	}
+	
+	printf("RA_dag_view: ");
+	if((result = test_dag_view()) == RA_SUCCESS) {
+		printf("success\n");
+	} else {
+		printf("%s\n", result->message);
+	}
+	
+	printf("RA_dag_reachable: ");
+	if((result = test_dag_reachable()) == RA_SUCCESS) {
+		printf("success\n");
+	} else {
+		printf("%s\n", result->message);
+	}
+	
+	printf("RA_dag_reachable parallel: ");
+	if((result = test_dag_reachable_parallel()) == RA_SUCCESS) {
+		printf("success\n");
+	} else {
+		printf("%s\n", result->message);
+	}
+	
+	printf("RA_dag_schedule: ");
+	if((result = test_dag_schedule()) == RA_SUCCESS) {
+		printf("success\n");
+	} else {
+		printf("%s\n", result->message);
+	}
+	
+	printf("RA_arena_rewind: ");
+	if((result = test_arena_rewind()) == RA_SUCCESS) {
+		printf("success\n");
+	} else {
+		printf("%s\n", result->message);
+	}
+	
+	printf("RA_contiguous_arena: ");
+	if((result = test_contiguous_arena()) == RA_SUCCESS) {
+		printf("success\n");
+	} else {
+		printf("%s\n", result->message);
+	}
+	
+	printf("RA_archive_writer: ");
+	if((result = test_archive_writer()) == RA_SUCCESS) {
+		printf("success\n");
+	} else {
+		printf("%s\n", result->message);
+	}
+	
+	printf("RA_install_mods stored entries: ");
+	if((result = test_install_stored_entries()) == RA_SUCCESS) {
+		printf("success\n");
+	} else {
+		printf("%s\n", result->message);
+	}
+	
+	printf("RA_install_mods many mods: ");
+	if((result = test_install_many_mods()) == RA_SUCCESS) {
+		printf("success\n");
+	} else {
+		printf("%s\n", result->message);
+	}
+	
+	printf("RA_install_mods cache reuse: ");
+	if((result = test_install_reuses_cache()) == RA_SUCCESS) {
+		printf("success\n");
+	} else {
+		printf("%s\n", result->message);
+	}
+	
+	printf("RA_install_mods headerless: ");
+	if((result = test_install_headerless()) == RA_SUCCESS) {
+		printf("success\n");
+	} else {
+		printf("%s\n", result->message);
+	}
+	
+	printf("RA_install_mods rcmod: ");
+	if((result = test_install_rcmod()) == RA_SUCCESS) {
+		printf("success\n");
+	} else {
+		printf("%s\n", result->message);
+	}
+	
+	printf("RA_install_mods conflicts: ");
+	if((result = test_install_conflicts()) == RA_SUCCESS) {
+		printf("success\n");
+	} else {
+		printf("%s\n", result->message);
+	}
+	
+	printf("RA_install_mods texture: ");
+	if((result = test_install_texture()) == RA_SUCCESS) {
+		printf("success\n");
+	} else {
+		printf("%s\n", result->message);
+	}
+	
+	printf("RA_mod_list_load cache: ");
+	if((result = test_mod_list_cache()) == RA_SUCCESS) {
+		printf("success\n");
+	} else {
+		printf("%s\n", result->message);
+	}
 }
 
-static RA_Result test_file(const char* path) {
+static RA_Result test_file(RA_SweepJob* job, const char* path, void* user) {
 	RA_Result result;
 	
-	printf("%s: ", path);
+	RA_sweep_printf(job, "%s: ", path);
 	u8* data;
 	s64 size;
 	RA_file_read(path, &data, &size);
 	
 	if(size >= 4 && *(u32*) data == FOURCC("1TAD")) {
-		if((result = test_dat_file(data, (u32) size)) != RA_SUCCESS) {
+		if((result = test_dat_file(job, data, (u32) size)) != RA_SUCCESS) {
 			return result;
 		}
 	} else if(size >= 0xc && *(u32*) (data + 0x8) == FOURCC("1TAD")) {
@@ -75,13 +295,22 @@ static RA_Result test_file(const char* path) {
 			return result;
 		}
 	} else {
-		printf("skipped\n");
+		RA_sweep_printf(job, "skipped\n");
 	}
 	
 	return RA_SUCCESS;
 }
 
-static RA_Result test_dat_file(u8* data, u32 size) {
+static void print_test_result(RA_SweepResult* result, void* user) {
+	fwrite(result->output, result->output_size, 1, stdout);
+	if(result->result == RA_SUCCESS) {
+		printf("success\n");
+	} else {
+		printf("%s\n", result->result->message);
+	}
+}
+
+static RA_Result test_dat_file(RA_SweepJob* job, u8* data, u32 size) {
 	RA_Result result;
 	
 	RA_DatFile dat;
@@ -89,13 +318,13 @@ static RA_Result test_dat_file(u8* data, u32 size) {
 	
 	switch(dat.asset_type_crc) {
 		case RA_ASSET_TYPE_MATERIAL: {
-			if((result = test_material_file(&dat)) != RA_SUCCESS) {
+			if((result = test_material_file(job, &dat)) != RA_SUCCESS) {
 				return result;
 			}
 			break;
 		}
 		default: {
-			printf("skipped\n");
+			RA_sweep_printf(job, "skipped\n");
 		}
 	}
 	
@@ -116,7 +345,7 @@ static RA_Result test_toc_file(u8* data, u32 size) {
 		return result;
 	}
 	
-	if((result = RA_dat_test(data + 0x8, size - 0x8, out_data + 0x8, (u32) out_size - 0x8, true)) != RA_SUCCESS) {
+	if((result = RA_dat_test(data + 0x8, size - 0x8, out_data + 0x8, (u32) out_size - 0x8, print_hex_dumps)) != RA_SUCCESS) {
 		RA_file_write("/tmp/test_toc", out_data, out_size);
 		return result;
 	}
@@ -132,23 +361,45 @@ static RA_Result test_dag_file(u8* data, u32 size) {
 		return result;
 	}
 	
+	// The view should agree with the parsed DAG.
+	RA_DependencyDagView view;
+	if((result = RA_dag_view(&view, data, size)) != RA_SUCCESS) {
+		return result;
+	}
+	if(view.asset_count != dag.asset_count) {
+		return RA_FAILURE("view has wrong asset count");
+	}
+	for(u32 i = 0; i < dag.asset_count; i++) {
+		u32 dependency_count;
+		s32* dependencies = RA_dag_view_dependencies(&view, i, &dependency_count);
+		b8 match =
+			view.ids[i] == dag.assets[i].id &&
+			view.types[i] == dag.assets[i].type &&
+			RA_dag_view_name(&view, i) == dag.assets[i].name &&
+			dependency_count == dag.assets[i].dependency_count &&
+			(dependency_count == 0 || dependencies == dag.assets[i].dependencies);
+		if(!match) {
+			return RA_FAILURE("view differs for asset %u", i);
+		}
+	}
+	
 	u8* out_data;
 	s64 out_size;
-	if((result = RA_dag_build(&dag, &out_data, &out_size)) != RA_SUCCESS) {
+	if((result = RA_dag_build(&dag, &out_data, &out_size, 0, NULL)) != RA_SUCCESS) {
 		return result;
 	}
 	
-	if((result = RA_dat_test(data + 0xc, size - 0xc, out_data + 0xc, (u32) out_size - 0xc, true)) != RA_SUCCESS) {
+	if((result = RA_dat_test(data + 0xc, size - 0xc, out_data + 0xc, (u32) out_size - 0xc, print_hex_dumps)) != RA_SUCCESS) {
 		return result;
 	}
 	
 	return RA_SUCCESS;
 }
 
-static RA_Result test_material_file(RA_DatFile* dat) {
+static RA_Result test_material_file(RA_SweepJob* job, RA_DatFile* dat) {
 	//RA_Material material;
 	//RA_material_parse(&material, dat);
-	printf("todo\n");
+	RA_sweep_printf(job, "todo\n");
 	return RA_SUCCESS;
 }
 
@@ -183,3 +434,2118 @@ static RA_Result test_toc_lookup_asset() {
 	
 	return RA_SUCCESS;
 }
+
+static RA_Result test_dat_writer_string_sharing() {
+	RA_Result result;
+	
+	RA_DatWriter* writer = RA_dat_writer_begin(RA_ASSET_TYPE_DAG, 0);
+	RA_dat_writer_set_flags(writer, RA_DAT_WRITER_MERGE_STRING_SUFFIXES);
+	u32 first = RA_dat_writer_string(writer, "levels/i01/thing.level");
+	u32 duplicate = RA_dat_writer_string(writer, "levels/i01/thing.level");
+	u32 suffix = RA_dat_writer_string(writer, "i01/thing.level");
+	u32 other = RA_dat_writer_string(writer, "thing");
+	u32 bytes_saved = RA_dat_writer_string_bytes_saved(writer);
+	
+	u8* data;
+	s64 size;
+	if((result = RA_dat_writer_finish(writer, &data, &size)) != RA_SUCCESS) {
+		return result;
+	}
+	
+	if(duplicate != first) {
+		return RA_FAILURE("1");
+	}
+	
+	if(suffix != first + 7 || strcmp((char*) data + suffix, "i01/thing.level") != 0) {
+		return RA_FAILURE("2");
+	}
+	
+	if(other == first || strcmp((char*) data + other, "thing") != 0) {
+		return RA_FAILURE("3");
+	}
+	
+	if(bytes_saved != 23 + 16) {
+		return RA_FAILURE("4");
+	}
+	
+	RA_free(data);
+	return RA_SUCCESS;
+}
+
+static RA_Result test_dat_peek_lump() {
+	RA_Result result;
+	
+	RA_DatWriter* writer = RA_dat_writer_begin(RA_ASSET_TYPE_TEXTURE, 0);
+	u8* header = RA_dat_writer_lump(writer, LUMP_TEXTURE_HEADER, 0x40);
+	for(u32 i = 0; i < 0x40; i++) {
+		header[i] = (u8) i;
+	}
+	u8* texture = RA_dat_writer_lump(writer, LUMP_MODEL_LOOK, 0x1000);
+	memset(texture, 0xcc, 0x1000);
+	
+	u8* data;
+	s64 size;
+	if((result = RA_dat_writer_finish(writer, &data, &size)) != RA_SUCCESS) {
+		return result;
+	}
+	
+	RA_DatFile dat;
+	if((result = RA_dat_parse(&dat, data, (u32) size, 0)) != RA_SUCCESS) {
+		RA_free(data);
+		return result;
+	}
+	RA_DatLump* expected = RA_dat_lookup_lump(&dat, LUMP_TEXTURE_HEADER);
+	
+	// The whole file.
+	RA_DatLump lump;
+	if(RA_dat_peek_lump(&lump, data, (u32) size, (u32) size, 0, LUMP_TEXTURE_HEADER) != RA_SUCCESS
+		|| lump.offset != expected->offset || lump.size != expected->size || lump.data != expected->data) {
+		RA_dat_free(&dat, FREE_FILE_DATA);
+		return RA_FAILURE("1");
+	}
+	
+	// Just the lump headers.
+	u32 lump_headers_size = 0x10 + dat.lump_count * 0xc;
+	if(RA_dat_peek_lump(&lump, data, lump_headers_size, (u32) size, 0, LUMP_TEXTURE_HEADER) != RA_SUCCESS
+		|| lump.offset != expected->offset || lump.size != expected->size || lump.data != NULL) {
+		RA_dat_free(&dat, FREE_FILE_DATA);
+		return RA_FAILURE("2");
+	}
+	
+	// Not enough for the lump headers.
+	if(RA_dat_peek_lump(&lump, data, lump_headers_size - 1, (u32) size, 0, LUMP_TEXTURE_HEADER) == RA_SUCCESS) {
+		RA_dat_free(&dat, FREE_FILE_DATA);
+		return RA_FAILURE("3");
+	}
+	
+	// The lump goes past the end of the file.
+	if(RA_dat_peek_lump(&lump, data, lump_headers_size, expected->offset + expected->size - 1, 0, LUMP_TEXTURE_HEADER) == RA_SUCCESS) {
+		RA_dat_free(&dat, FREE_FILE_DATA);
+		return RA_FAILURE("4");
+	}
+	
+	// The lump doesn't exist.
+	if(RA_dat_peek_lump(&lump, data, (u32) size, (u32) size, 0, LUMP_MODEL_BUILT) == RA_SUCCESS) {
+		RA_dat_free(&dat, FREE_FILE_DATA);
+		return RA_FAILURE("5");
+	}
+	
+	RA_dat_free(&dat, FREE_FILE_DATA);
+	return RA_SUCCESS;
+}
+
+static RA_Result test_find_first_difference() {
+	u8 lhs[300];
+	u8 rhs[300];
+	for(u32 i = 0; i < sizeof(lhs); i++) {
+		lhs[i] = (u8) i;
+	}
+	
+	RA_SimdLevel levels[] = {RA_SIMD_NONE, RA_SIMD_SSE2, RA_SIMD_AVX2};
+	for(u32 i = 0; i < ARRAY_SIZE(levels); i++) {
+		RA_set_simd_level(levels[i]);
+		for(u32 size = 0; size <= sizeof(lhs); size++) {
+			memcpy(rhs, lhs, sizeof(lhs));
+			if(RA_find_first_difference(lhs, rhs, size) != size) {
+				return RA_FAILURE("level %u size %u: equal buffers", i, size);
+			}
+			for(u32 diff = 0; diff < size; diff++) {
+				memcpy(rhs, lhs, sizeof(lhs));
+				rhs[diff] ^= 0x80;
+				if(size > diff + 1) {
+					rhs[size - 1] ^= 0x80;
+				}
+				if(RA_find_first_difference(lhs, rhs, size) != diff) {
+					return RA_FAILURE("level %u size %u: wrong offset for difference at %u", i, size, diff);
+				}
+			}
+		}
+	}
+	
+	RA_set_simd_level(RA_SIMD_AVX2);
+	return RA_SUCCESS;
+}
+
+static RA_Result test_crc64_path() {
+	// Values from the original byte at a time implementation.
+	if(RA_crc64_path("") != 0xb25b15e575e1c3d0) {
+		return RA_FAILURE("1");
+	}
+	
+	if(RA_crc64_path("a") != 0xaf151533a715ad2a) {
+		return RA_FAILURE("2");
+	}
+	
+	if(RA_crc64_path("characters/hero/hero_body.model") != 0x9e474379a95b78ac) {
+		return RA_FAILURE("3");
+	}
+	
+	if(RA_crc64_path("Levels\\I01\\Zone_A\\ZONE_A.level") != 0xa11415be3439eeb6) {
+		return RA_FAILURE("4");
+	}
+	
+	// Check that case and slashes are normalised in every position.
+	char lower[64];
+	char upper[64];
+	for(u32 size = 1; size < sizeof(lower); size++) {
+		for(u32 i = 0; i < size; i++) {
+			lower[i] = (i % 5 == 4) ? '/' : 'a' + (i % 26);
+			upper[i] = (i % 5 == 4) ? '\\' : 'A' + (i % 26);
+		}
+		lower[size] = '\0';
+		upper[size] = '\0';
+		if(RA_crc64_path(lower) != RA_crc64_path(upper)) {
+			return RA_FAILURE("size %u", size);
+		}
+	}
+	
+	return RA_SUCCESS;
+}
+
+static RA_Result test_dag_reverse_index() {
+	RA_Result result;
+	
+	s32 dependencies_0[] = {1, 2};
+	s32 dependencies_1[] = {2};
+	s32 dependencies_3[] = {2, 0};
+	RA_DependencyDagAsset assets[4] = {0};
+	assets[0].dependencies = dependencies_0;
+	assets[0].dependency_count = ARRAY_SIZE(dependencies_0);
+	assets[1].dependencies = dependencies_1;
+	assets[1].dependency_count = ARRAY_SIZE(dependencies_1);
+	assets[3].dependencies = dependencies_3;
+	assets[3].dependency_count = ARRAY_SIZE(dependencies_3);
+	
+	RA_DependencyDag dag = {0};
+	RA_arena_create(&dag.arena);
+	dag.assets = assets;
+	dag.asset_count = ARRAY_SIZE(assets);
+	if((result = RA_dag_build_reverse_index(&dag)) != RA_SUCCESS) {
+		return result;
+	}
+	
+	u32 count;
+	s32* dependents = RA_dag_lookup_dependents(&dag, 0, &count);
+	if(count != 1 || dependents[0] != 3) {
+		return RA_FAILURE("0");
+	}
+	
+	dependents = RA_dag_lookup_dependents(&dag, 2, &count);
+	if(count != 3 || dependents[0] != 0 || dependents[1] != 1 || dependents[2] != 3) {
+		return RA_FAILURE("2");
+	}
+	
+	RA_dag_lookup_dependents(&dag, 3, &count);
+	if(count != 0) {
+		return RA_FAILURE("3");
+	}
+	
+	RA_arena_destroy(&dag.arena);
+	return RA_SUCCESS;
+}
+
+static RA_Result test_dag_editing() {
+	RA_Result result;
+	
+	s32 dependencies_0[] = {1};
+	s32 dependencies_2[] = {0, 1};
+	RA_DependencyDagAsset assets[3] = {0};
+	assets[0].id = 100;
+	assets[0].name = "characters/hero/hero_body.model";
+	assets[0].dependencies = dependencies_0;
+	assets[0].dependency_count = ARRAY_SIZE(dependencies_0);
+	assets[1].id = 101;
+	assets[1].name = "characters/hero/hero_body.texture";
+	assets[1].type = 1;
+	assets[2].id = 102;
+	assets[2].name = "levels/i01/zone_a.level";
+	assets[2].type = 2;
+	assets[2].dependencies = dependencies_2;
+	assets[2].dependency_count = ARRAY_SIZE(dependencies_2);
+	
+	RA_DependencyDag hand_built = {0};
+	hand_built.assets = assets;
+	hand_built.asset_count = ARRAY_SIZE(assets);
+	u8* original_data;
+	s64 original_size;
+	if((result = RA_dag_build(&hand_built, &original_data, &original_size, 0, NULL)) != RA_SUCCESS) {
+		return result;
+	}
+	
+	RA_DependencyDag original;
+	if((result = RA_dag_parse(&original, original_data, (u32) original_size)) != RA_SUCCESS) {
+		return result;
+	}
+	
+	// Check that RA_dag_build wrote out what it was given.
+	if(original.asset_count != hand_built.asset_count) {
+		return RA_FAILURE("wrong asset count after building");
+	}
+	for(u32 i = 0; i < original.asset_count; i++) {
+		RA_DependencyDagAsset* lhs = &assets[i];
+		RA_DependencyDagAsset* rhs = &original.assets[i];
+		if(lhs->id != rhs->id || lhs->type != rhs->type || strcmp(lhs->name, rhs->name) != 0) {
+			return RA_FAILURE("asset %u differs after building", i);
+		}
+		if(lhs->dependency_count != rhs->dependency_count) {
+			return RA_FAILURE("asset %u has the wrong number of dependencies after building", i);
+		}
+		for(u32 j = 0; j < lhs->dependency_count; j++) {
+			if(lhs->dependencies[j] != rhs->dependencies[j]) {
+				return RA_FAILURE("asset %u has the wrong dependencies after building", i);
+			}
+		}
+	}
+	
+	s32 new_asset;
+	if((result = RA_dag_add_asset(&original, "mods/hero_hat.model", 200, 3, &new_asset)) != RA_SUCCESS) {
+		return result;
+	}
+	if(new_asset != 3) {
+		return RA_FAILURE("wrong index for new asset");
+	}
+	if((result = RA_dag_add_dependency(&original, new_asset, 1)) != RA_SUCCESS) {
+		return result;
+	}
+	if((result = RA_dag_add_dependency(&original, 2, new_asset)) != RA_SUCCESS) {
+		return result;
+	}
+	if((result = RA_dag_remove_dependency(&original, 0, 1)) != RA_SUCCESS) {
+		return result;
+	}
+	if((result = RA_dag_rename_asset(&original, 1, "mods/hero_body.texture")) != RA_SUCCESS) {
+		return result;
+	}
+	if(RA_dag_lookup_asset(&original, RA_crc64_path("mods/hero_hat.model")) != &original.assets[3]) {
+		return RA_FAILURE("lookup of new asset failed");
+	}
+	if(RA_dag_lookup_asset(&original, RA_crc64_path("mods/hero_body.texture")) != &original.assets[1]) {
+		return RA_FAILURE("lookup of renamed asset failed");
+	}
+	
+	u8* edited_data;
+	s64 edited_size;
+	if((result = RA_dag_build_incremental(&original, &edited_data, &edited_size)) != RA_SUCCESS) {
+		return result;
+	}
+	
+	RA_DependencyDag edited;
+	if((result = RA_dag_parse(&edited, edited_data, (u32) edited_size)) != RA_SUCCESS) {
+		return result;
+	}
+	
+	if(edited.asset_count != original.asset_count) {
+		return RA_FAILURE("wrong asset count");
+	}
+	for(u32 i = 0; i < edited.asset_count; i++) {
+		RA_DependencyDagAsset* lhs = &original.assets[i];
+		RA_DependencyDagAsset* rhs = &edited.assets[i];
+		if(lhs->id != rhs->id || lhs->type != rhs->type || strcmp(lhs->name, rhs->name) != 0) {
+			return RA_FAILURE("asset %u differs", i);
+		}
+		if(lhs->dependency_count != rhs->dependency_count) {
+			return RA_FAILURE("asset %u has the wrong number of dependencies", i);
+		}
+		for(u32 j = 0; j < lhs->dependency_count; j++) {
+			if(lhs->dependencies[j] != rhs->dependencies[j]) {
+				return RA_FAILURE("asset %u has the wrong dependencies", i);
+			}
+		}
+	}
+	if(RA_dag_lookup_asset(&edited, RA_crc64_path("mods/hero_body.texture")) != &edited.assets[1]) {
+		return RA_FAILURE("lookup of renamed asset failed after saving");
+	}
+
+	// Parsing a DAG with a bad dependency should clean up after itself.
+	RA_DatFile dat;
+	if((result = RA_dat_parse(&dat, edited_data, (u32) edited_size, sizeof(RA_DependencyDagFileHeader))) != RA_SUCCESS) {
+		return result;
+	}
+	RA_DatLump* links = RA_dat_lookup_lump(&dat, LUMP_DEPENDENCY_LINKS);
+	if(links == NULL) {
+		RA_dat_free(&dat, DONT_FREE_FILE_DATA);
+		return RA_FAILURE("no dependency lump");
+	}
+	for(u32 i = 0; i < links->size / 4; i++) {
+		if(((s32*) links->data)[i] > -1) {
+			((s32*) links->data)[i] = 1000;
+		}
+	}
+	RA_dat_free(&dat, DONT_FREE_FILE_DATA);
+	RA_DependencyDag broken;
+	if(RA_dag_parse(&broken, edited_data, (u32) edited_size) == RA_SUCCESS) {
+		RA_dag_free(&broken, false);
+		return RA_FAILURE("parsed a DAG with an out of range dependency");
+	}
+
+	RA_dag_free(&edited, true);
+	RA_dag_free(&original, true);
+	return RA_SUCCESS;
+}
+
+static RA_Result test_dag_rename_asset() {
+	RA_Result result;
+	
+	RA_DependencyDag dag = {0};
+	RA_arena_create(&dag.arena);
+	if((result = RA_dag_build_lookup_table(&dag)) != RA_SUCCESS) {
+		return result;
+	}
+	
+	char name[64];
+	for(u32 i = 0; i < 1000; i++) {
+		snprintf(name, sizeof(name), "assets/%u.model", i);
+		if((result = RA_dag_add_asset(&dag, name, i, 0, NULL)) != RA_SUCCESS) {
+			RA_dag_free(&dag, false);
+			return result;
+		}
+	}
+	
+	// Renaming shouldn't use up lookup table slots, otherwise looking up a
+	// name that isn't there would never find an empty slot to stop at.
+	for(u32 pass = 0; pass < 4; pass++) {
+		for(u32 i = 0; i < dag.asset_count; i++) {
+			snprintf(name, sizeof(name), "renamed/%u/%u.model", pass, i);
+			if((result = RA_dag_rename_asset(&dag, (s32) i, name)) != RA_SUCCESS) {
+				RA_dag_free(&dag, false);
+				return result;
+			}
+		}
+	}
+	if(RA_dag_lookup_asset(&dag, RA_crc64_path("not/in/the/dag.model")) != NULL) {
+		RA_dag_free(&dag, false);
+		return RA_FAILURE("found a missing asset");
+	}
+	for(u32 i = 0; i < dag.asset_count; i++) {
+		snprintf(name, sizeof(name), "renamed/3/%u.model", i);
+		if(RA_dag_lookup_asset(&dag, RA_crc64_path(name)) != &dag.assets[i]) {
+			RA_dag_free(&dag, false);
+			return RA_FAILURE("lookup of renamed asset %u failed", i);
+		}
+		snprintf(name, sizeof(name), "renamed/2/%u.model", i);
+		if(RA_dag_lookup_asset(&dag, RA_crc64_path(name)) != NULL) {
+			RA_dag_free(&dag, false);
+			return RA_FAILURE("old name of asset %u still found", i);
+		}
+	}
+	
+	// The first asset with a duplicated name should be the one found, and the
+	// other one should take over when it's renamed.
+	if((result = RA_dag_rename_asset(&dag, 700, "renamed/3/300.model")) != RA_SUCCESS) {
+		RA_dag_free(&dag, false);
+		return result;
+	}
+	if(RA_dag_lookup_asset(&dag, RA_crc64_path("renamed/3/300.model")) != &dag.assets[300]) {
+		RA_dag_free(&dag, false);
+		return RA_FAILURE("wrong asset found for duplicated name");
+	}
+	if((result = RA_dag_rename_asset(&dag, 300, "elsewhere.model")) != RA_SUCCESS) {
+		RA_dag_free(&dag, false);
+		return result;
+	}
+	if(RA_dag_lookup_asset(&dag, RA_crc64_path("renamed/3/300.model")) != &dag.assets[700]) {
+		RA_dag_free(&dag, false);
+		return RA_FAILURE("duplicate not found after renaming the first one");
+	}
+	
+	RA_dag_free(&dag, false);
+	return RA_SUCCESS;
+}
+
+static RA_Result test_dag_view() {
+	RA_Result result;
+	
+	s32 dependencies_0[] = {1, 2};
+	s32 dependencies_2[] = {1};
+	RA_DependencyDagAsset assets[3] = {0};
+	assets[0].id = 100;
+	assets[0].name = "levels/i01/zone_a.level";
+	assets[0].type = 2;
+	assets[0].dependencies = dependencies_0;
+	assets[0].dependency_count = ARRAY_SIZE(dependencies_0);
+	assets[1].id = 101;
+	assets[1].name = "characters/hero/hero_body.texture";
+	assets[1].type = 1;
+	assets[2].id = 102;
+	assets[2].name = "characters/hero/hero_body.model";
+	assets[2].dependencies = dependencies_2;
+	assets[2].dependency_count = ARRAY_SIZE(dependencies_2);
+	
+	RA_DependencyDag hand_built = {0};
+	hand_built.assets = assets;
+	hand_built.asset_count = ARRAY_SIZE(assets);
+	u8* data;
+	s64 size;
+	if((result = RA_dag_build(&hand_built, &data, &size, 0, NULL)) != RA_SUCCESS) {
+		return result;
+	}
+	
+	RA_DependencyDagView view;
+	if((result = RA_dag_view(&view, data, (u32) size)) != RA_SUCCESS) {
+		RA_free(data);
+		return result;
+	}
+	if(view.asset_count != ARRAY_SIZE(assets)) {
+		RA_free(data);
+		return RA_FAILURE("wrong asset count");
+	}
+	for(u32 i = 0; i < view.asset_count; i++) {
+		const char* name = RA_dag_view_name(&view, i);
+		if(view.ids[i] != assets[i].id || view.types[i] != assets[i].type || name == NULL || strcmp(name, assets[i].name) != 0) {
+			RA_free(data);
+			return RA_FAILURE("asset %u differs", i);
+		}
+		if(RA_dag_view_name_crc(&view, i) != RA_crc64_path(assets[i].name)) {
+			RA_free(data);
+			return RA_FAILURE("asset %u has the wrong name crc", i);
+		}
+		u32 dependency_count;
+		s32* dependencies = RA_dag_view_dependencies(&view, i, &dependency_count);
+		if(dependency_count != assets[i].dependency_count) {
+			RA_free(data);
+			return RA_FAILURE("asset %u has the wrong number of dependencies", i);
+		}
+		for(u32 j = 0; j < dependency_count; j++) {
+			if(dependencies[j] != assets[i].dependencies[j]) {
+				RA_free(data);
+				return RA_FAILURE("asset %u has the wrong dependencies", i);
+			}
+		}
+	}
+	if(RA_dag_view_find_id(&view, 102) != 2 || RA_dag_view_find_id(&view, 103) != -1) {
+		RA_free(data);
+		return RA_FAILURE("find id");
+	}
+	if(RA_dag_view_name(&view, 3) != NULL) {
+		RA_free(data);
+		return RA_FAILURE("name out of range");
+	}
+	
+	// A name that isn't terminated before the end of the file shouldn't be
+	// returned. Point the first name at the last byte, and make it non-zero.
+	u32 original_offset = view.name_offsets[0];
+	view.name_offsets[0] = (u32) size - sizeof(RA_DependencyDagFileHeader) - 1;
+	u8 last_byte = data[size - 1];
+	data[size - 1] = 'x';
+	if(RA_dag_view_name(&view, 0) != NULL) {
+		RA_free(data);
+		return RA_FAILURE("unterminated name");
+	}
+	data[size - 1] = last_byte;
+	view.name_offsets[0] = original_offset;
+	
+	RA_free(data);
+	return RA_SUCCESS;
+}
+
+static RA_Result test_dag_reachable() {
+	RA_Result result;
+	
+	// A diamond (0 -> 1, 2 -> 3) leading into a cycle (3 -> 4 -> 5 -> 3), and
+	// an asset that nothing reaches.
+	s32 dependencies_0[] = {1, 2};
+	s32 dependencies_1[] = {3};
+	s32 dependencies_2[] = {3};
+	s32 dependencies_3[] = {4};
+	s32 dependencies_4[] = {5};
+	s32 dependencies_5[] = {3};
+	s32 dependencies_6[] = {0};
+	s32* dependencies[] = {dependencies_0, dependencies_1, dependencies_2, dependencies_3, dependencies_4, dependencies_5, dependencies_6};
+	u32 dependency_counts[] = {2, 1, 1, 1, 1, 1, 1};
+	RA_DependencyDagAsset assets[7] = {0};
+	for(u32 i = 0; i < ARRAY_SIZE(assets); i++) {
+		assets[i].dependencies = dependencies[i];
+		assets[i].dependency_count = dependency_counts[i];
+	}
+	
+	RA_DependencyDag dag = {0};
+	dag.assets = assets;
+	dag.asset_count = ARRAY_SIZE(assets);
+	
+	u64 bitset[RA_DAG_BITSET_SIZE(7)];
+	s32 roots_0[] = {0, 0};
+	if((result = RA_dag_reachable(&dag, roots_0, ARRAY_SIZE(roots_0), bitset)) != RA_SUCCESS) {
+		return result;
+	}
+	if(bitset[0] != 0x3f) {
+		return RA_FAILURE("wrong assets reachable from the diamond");
+	}
+	
+	s32 roots_4[] = {4};
+	if((result = RA_dag_reachable(&dag, roots_4, ARRAY_SIZE(roots_4), bitset)) != RA_SUCCESS) {
+		return result;
+	}
+	if(bitset[0] != 0x38) {
+		return RA_FAILURE("wrong assets reachable from the cycle");
+	}
+	
+	s32 bad_roots[] = {7};
+	if(RA_dag_reachable(&dag, bad_roots, ARRAY_SIZE(bad_roots), bitset) == RA_SUCCESS) {
+		return RA_FAILURE("root out of range accepted");
+	}
+	
+	return RA_SUCCESS;
+}
+
+// Enough roots that the first frontier is expanded in parallel, compared with
+// a simple depth first search.
+static RA_Result test_dag_reachable_parallel() {
+	RA_Result result;
+	
+	u32 asset_count = 200000;
+	u32 max_dependencies = 4;
+	RA_DependencyDagAsset* assets = RA_calloc(asset_count, sizeof(RA_DependencyDagAsset));
+	s32* links = RA_malloc(asset_count * max_dependencies * sizeof(s32));
+	s32* roots = RA_malloc(asset_count * sizeof(s32));
+	s32* stack = RA_malloc(asset_count * sizeof(s32));
+	u8* expected = RA_calloc(asset_count, 1);
+	u64* bitset = RA_malloc(RA_DAG_BITSET_SIZE(asset_count) * sizeof(u64));
+	if(assets == NULL || links == NULL || roots == NULL || stack == NULL || expected == NULL || bitset == NULL) {
+		return RA_FAILURE("cannot allocate");
+	}
+	
+	// Random edges, including cycles and self loops.
+	u32 random = 12345;
+	for(u32 i = 0; i < asset_count; i++) {
+		assets[i].dependencies = &links[i * max_dependencies];
+		random = random * 1103515245 + 12345;
+		assets[i].dependency_count = (random >> 16) % (max_dependencies + 1);
+		for(u32 j = 0; j < assets[i].dependency_count; j++) {
+			random = random * 1103515245 + 12345;
+			assets[i].dependencies[j] = (s32) ((random >> 8) % asset_count);
+		}
+	}
+	
+	u32 root_count = 20000;
+	for(u32 i = 0; i < root_count; i++) {
+		roots[i] = (s32) ((i * 7919) % asset_count);
+	}
+	
+	RA_DependencyDag dag = {0};
+	dag.assets = assets;
+	dag.asset_count = asset_count;
+	result = RA_dag_reachable(&dag, roots, root_count, bitset);
+	
+	if(result == RA_SUCCESS) {
+		u32 stack_top = 0;
+		for(u32 i = 0; i < root_count; i++) {
+			if(!expected[roots[i]]) {
+				expected[roots[i]] = 1;
+				stack[stack_top++] = roots[i];
+			}
+		}
+		while(stack_top > 0) {
+			RA_DependencyDagAsset* asset = &assets[stack[--stack_top]];
+			for(u32 j = 0; j < asset->dependency_count; j++) {
+				if(!expected[asset->dependencies[j]]) {
+					expected[asset->dependencies[j]] = 1;
+					stack[stack_top++] = asset->dependencies[j];
+				}
+			}
+		}
+		for(u32 i = 0; i < asset_count; i++) {
+			if(RA_DAG_BITSET_TEST(bitset, i) != expected[i]) {
+				result = RA_FAILURE("asset %u differs from depth first search", i);
+				break;
+			}
+		}
+	}
+	
+	RA_free(assets);
+	RA_free(links);
+	RA_free(roots);
+	RA_free(stack);
+	RA_free(expected);
+	RA_free(bitset);
+	return result;
+}
+
+static RA_Result schedule_depth(RA_DagJob* job, s32 asset_index, void* user) {
+	RA_DependencyDag* dag = user;
+	RA_DependencyDagAsset* asset = &dag->assets[asset_index];
+	
+	// Work out how deep each asset is from the results of its dependencies,
+	// which should all be available by now if they're in the set.
+	u32 depth = 0;
+	for(u32 i = 0; i < asset->dependency_count; i++) {
+		u32* dependency_depth = RA_dag_job_result(job, asset->dependencies[i]);
+		if(dependency_depth == NULL && asset->dependencies[i] != 4) {
+			return RA_FAILURE("asset %d processed before asset %d", asset_index, asset->dependencies[i]);
+		}
+		if(dependency_depth) {
+			depth = MAX(depth, *dependency_depth + 1);
+		}
+	}
+	
+	u32* result = RA_dag_job_alloc(job, sizeof(u32));
+	if(result == NULL) {
+		return RA_FAILURE("cannot allocate result");
+	}
+	*result = depth;
+	RA_dag_job_set_result(job, result);
+	
+	return RA_SUCCESS;
+}
+
+static RA_Result test_dag_schedule() {
+	RA_Result result;
+	
+	// Asset 4 isn't in the set, so asset 3 shouldn't wait for it.
+	s32 dependencies_0[] = {1, 2};
+	s32 dependencies_1[] = {3};
+	s32 dependencies_2[] = {3, 1};
+	s32 dependencies_3[] = {4};
+	RA_DependencyDagAsset assets[5] = {0};
+	assets[0].dependencies = dependencies_0;
+	assets[0].dependency_count = ARRAY_SIZE(dependencies_0);
+	assets[1].dependencies = dependencies_1;
+	assets[1].dependency_count = ARRAY_SIZE(dependencies_1);
+	assets[2].dependencies = dependencies_2;
+	assets[2].dependency_count = ARRAY_SIZE(dependencies_2);
+	assets[3].dependencies = dependencies_3;
+	assets[3].dependency_count = ARRAY_SIZE(dependencies_3);
+	
+	RA_DependencyDag dag = {0};
+	RA_arena_create(&dag.arena);
+	dag.assets = assets;
+	dag.asset_count = ARRAY_SIZE(assets);
+	
+	RA_DagScheduleOptions options = {0};
+	options.thread_count = 4;
+	options.process = schedule_depth;
+	options.user = &dag;
+	
+	s32 set[] = {0, 1, 2, 3, 0};
+	RA_DagScheduleResults results;
+	if((result = RA_dag_schedule(&dag, set, ARRAY_SIZE(set), &options, &results)) != RA_SUCCESS) {
+		return result;
+	}
+	
+	if(results.wave_count != 4) {
+		return RA_FAILURE("wrong wave count");
+	}
+	if(results.results[4] != NULL || *(u32*) results.results[0] != 3 || *(u32*) results.results[2] != 2) {
+		return RA_FAILURE("wrong results");
+	}
+	RA_dag_schedule_free(&results);
+	
+	// Make a cycle.
+	dependencies_3[0] = 0;
+	dag.dependent_offsets = NULL;
+	if(RA_dag_schedule(&dag, set, ARRAY_SIZE(set), &options, &results) == RA_SUCCESS) {
+		return RA_FAILURE("cycle not detected");
+	}
+	RA_arena_destroy(&dag.arena);
+	
+	// Two waves that are wide enough for all the worker threads to be woken
+	// up, and then the same again with an asset that fails in the second one.
+	RA_DependencyDagAsset wide_assets[64] = {0};
+	s32 wide_dependencies[32];
+	s32 wide_set[64];
+	for(u32 i = 0; i < 32; i++) {
+		wide_dependencies[i] = (s32) i;
+		wide_assets[32 + i].dependencies = &wide_dependencies[i];
+		wide_assets[32 + i].dependency_count = 1;
+	}
+	for(u32 i = 0; i < 64; i++) {
+		wide_set[i] = (s32) i;
+	}
+	RA_DependencyDag wide = {0};
+	RA_arena_create(&wide.arena);
+	wide.assets = wide_assets;
+	wide.asset_count = ARRAY_SIZE(wide_assets);
+	options.user = &wide;
+	
+	if((result = RA_dag_schedule(&wide, wide_set, ARRAY_SIZE(wide_set), &options, &results)) != RA_SUCCESS) {
+		RA_arena_destroy(&wide.arena);
+		return result;
+	}
+	b8 correct = results.wave_count == 2;
+	for(u32 i = 0; i < 64; i++) {
+		correct &= results.results[i] != NULL && *(u32*) results.results[i] == (i >= 32);
+	}
+	RA_dag_schedule_free(&results);
+	if(!correct) {
+		RA_arena_destroy(&wide.arena);
+		return RA_FAILURE("wrong results for wide waves");
+	}
+	
+	options.process = schedule_fail_asset_40;
+	if((result = RA_dag_schedule(&wide, wide_set, ARRAY_SIZE(wide_set), &options, &results)) == RA_SUCCESS) {
+		RA_dag_schedule_free(&results);
+		RA_arena_destroy(&wide.arena);
+		return RA_FAILURE("failure not reported");
+	}
+	if(strcmp(result->message, "asset 40 failed") != 0) {
+		RA_arena_destroy(&wide.arena);
+		return RA_FAILURE("wrong error for failed asset");
+	}
+	
+	RA_arena_destroy(&wide.arena);
+	return RA_SUCCESS;
+}
+
+static RA_Result schedule_fail_asset_40(RA_DagJob* job, s32 asset_index, void* user) {
+	if(asset_index == 40) {
+		return RA_FAILURE("asset 40 failed");
+	}
+	return schedule_depth(job, asset_index, user);
+}
+
+static RA_Result test_arena_rewind() {
+	RA_Arena arena;
+	RA_arena_create(&arena);
+	
+	u8* first = RA_arena_alloc(&arena, 16);
+	RA_ArenaMark mark = RA_arena_mark(&arena);
+	u8* second = RA_arena_alloc(&arena, 16);
+	u8* big = RA_arena_alloc(&arena, 4096);
+	if(first == NULL || second == NULL || big == NULL) {
+		RA_arena_destroy(&arena);
+		return RA_FAILURE("cannot allocate");
+	}
+	memset(first, 0xaa, 16);
+	
+	// Rewinding should hand out the same memory again, including the memory in
+	// blocks past the one that was marked.
+	RA_arena_rewind(&arena, mark);
+	if(RA_arena_alloc(&arena, 16) != second || RA_arena_alloc(&arena, 4096) != big) {
+		RA_arena_destroy(&arena);
+		return RA_FAILURE("memory not reused after rewind");
+	}
+	if(first[15] != 0xaa) {
+		RA_arena_destroy(&arena);
+		return RA_FAILURE("memory before the mark was clobbered");
+	}
+	
+	// Only the first 16 bytes were allocated before the mark, so only they
+	// should be copied out.
+	RA_arena_rewind(&arena, mark);
+	u8 copy[8192];
+	if(RA_arena_copy(&arena, copy, sizeof(copy)) != 16) {
+		RA_arena_destroy(&arena);
+		return RA_FAILURE("copy included rewound blocks");
+	}
+	
+	RA_arena_reset(&arena);
+	if(arena.head != arena.tail || arena.head->next != NULL || RA_arena_alloc(&arena, 4096) != big) {
+		RA_arena_destroy(&arena);
+		return RA_FAILURE("reset didn't keep the largest block");
+	}
+
+	// An allocation that doesn't fit in the spare block left over from a rewind
+	// should replace it rather than leave it linked into the arena.
+	RA_ArenaMark full = RA_arena_mark(&arena);
+	if(RA_arena_alloc(&arena, 16) == NULL) {
+		RA_arena_destroy(&arena);
+		return RA_FAILURE("cannot allocate");
+	}
+	u64 spare_capacity = arena.tail->capacity;
+	RA_arena_rewind(&arena, full);
+	if(RA_arena_alloc(&arena, spare_capacity + 1) == NULL) {
+		RA_arena_destroy(&arena);
+		return RA_FAILURE("cannot allocate past the spare block");
+	}
+	if(arena.head->next != arena.tail || arena.tail->prev != arena.head || arena.tail->next != NULL) {
+		RA_arena_destroy(&arena);
+		return RA_FAILURE("spare block not unlinked");
+	}
+
+	RA_arena_destroy(&arena);
+	return RA_SUCCESS;
+}
+
+static RA_Result test_contiguous_arena() {
+	RA_Result result;
+	
+	RA_ContiguousArena arena;
+	if((result = RA_contiguous_arena_create(&arena, 1024 * 1024)) != RA_SUCCESS) {
+		return result;
+	}
+	
+	// Allocations should follow on from each other, even once more pages have
+	// had to be committed.
+	u8* expected = arena.data;
+	for(u32 i = 0; i < 1000; i++) {
+		u8* allocation = RA_contiguous_arena_alloc(&arena, 1000);
+		if(allocation != expected) {
+			RA_contiguous_arena_destroy(&arena);
+			return RA_FAILURE("allocation %u isn't contiguous", i);
+		}
+		memset(allocation, (u8) i, 1000);
+		expected += 1000;
+	}
+	if(arena.data[999 * 1000] != (u8) 999) {
+		RA_contiguous_arena_destroy(&arena);
+		return RA_FAILURE("data clobbered");
+	}
+	
+	if(RA_contiguous_arena_alloc(&arena, 1024 * 1024) != NULL) {
+		RA_contiguous_arena_destroy(&arena);
+		return RA_FAILURE("allocated past the end of the reserved range");
+	}
+	
+	RA_contiguous_arena_destroy(&arena);
+	return RA_SUCCESS;
+}
+
+static RA_Result test_archive_writer() {
+	RA_Result result = RA_SUCCESS;
+	
+	// Sizes around the block boundaries, and big enough for several batches.
+	s64 sizes[] = {
+		0, 1,
+		RA_ARCHIVE_WRITER_BLOCK_SIZE - 1,
+		RA_ARCHIVE_WRITER_BLOCK_SIZE,
+		RA_ARCHIVE_WRITER_BLOCK_SIZE + 1,
+		4 * 1024 * 1024 + 17,
+		13 * 1024 * 1024 + 5
+	};
+	s64 max_size = sizes[ARRAY_SIZE(sizes) - 1];
+	u8* data = RA_malloc(max_size);
+	if(data == NULL) {
+		return RA_FAILURE("cannot allocate");
+	}
+	
+	// Runs of repeated bytes mixed in with noise, so that the blocks compress
+	// by different amounts.
+	u32 random = 1;
+	for(s64 i = 0; i < max_size; i++) {
+		random = random * 1103515245 + 12345;
+		data[i] = (i / 4096) % 3 == 0 ? (u8) (i / 4096) : (u8) (random >> 16);
+	}
+	
+	for(u32 i = 0; i < ARRAY_SIZE(sizes) && result == RA_SUCCESS; i++) {
+		for(s32 thread_count = 0; thread_count < 2 && result == RA_SUCCESS; thread_count++) {
+			result = test_archive_writer_round_trip(data, sizes[i], thread_count, &random);
+			if(result != RA_SUCCESS) {
+				// The message is overwritten by the next failure, so copy it.
+				char message[1024];
+				RA_string_copy(message, result->message, sizeof(message));
+				result = RA_FAILURE("size %lld, %d threads: %s", (long long) sizes[i], thread_count, message);
+			}
+		}
+	}
+	
+	RA_free(data);
+	return result;
+}
+
+static RA_Result test_archive_writer_round_trip(u8* data, s64 size, s32 thread_count, u32* random) {
+	RA_Result result;
+	
+	const char* path = "test_archive_writer.dsar";
+	FILE* file = fopen(path, "w+b");
+	if(file == NULL) {
+		return RA_FAILURE("cannot open '%s'", path);
+	}
+	RA_ArchiveWriter* writer = RA_archive_writer_begin(file, size, thread_count);
+	if(writer == NULL) {
+		fclose(file);
+		return RA_FAILURE("cannot begin writing");
+	}
+	
+	// Write the data in randomly sized pieces.
+	s64 offset = 0;
+	while(offset < size) {
+		*random = *random * 1103515245 + 12345;
+		s64 piece_size = MIN(size - offset, (s64) ((*random >> 8) % (3 * RA_ARCHIVE_WRITER_BLOCK_SIZE / 2)) + 1);
+		if((result = RA_archive_writer_write(writer, data + offset, piece_size)) != RA_SUCCESS) {
+			RA_archive_writer_abort(writer);
+			fclose(file);
+			return result;
+		}
+		offset += piece_size;
+		if(RA_archive_writer_offset(writer) != offset) {
+			RA_archive_writer_abort(writer);
+			fclose(file);
+			return RA_FAILURE("wrong offset after writing %lld bytes", (long long) offset);
+		}
+	}
+	result = RA_archive_writer_finish(writer);
+	fclose(file);
+	if(result != RA_SUCCESS) {
+		return result;
+	}
+	
+	RA_Archive archive;
+	if((result = RA_archive_open(&archive, path)) != RA_SUCCESS) {
+		return result;
+	}
+	u8* read_data = RA_malloc(size);
+	if(read_data == NULL) {
+		RA_archive_close(&archive);
+		remove(path);
+		return RA_FAILURE("cannot allocate");
+	}
+	
+	if(!archive.is_dsar_archive || RA_archive_get_decompressed_size(&archive) != size) {
+		result = RA_FAILURE("wrong decompressed size");
+	}
+	
+	// The whole thing in one go, then reads that straddle block boundaries.
+	if(result == RA_SUCCESS && size > 0) {
+		memset(read_data, 0, size);
+		if((result = RA_archive_read(&archive, 0, (u32) size, read_data)) == RA_SUCCESS && memcmp(read_data, data, size) != 0) {
+			result = RA_FAILURE("data differs");
+		}
+	}
+	for(s64 boundary = RA_ARCHIVE_WRITER_BLOCK_SIZE; boundary < size && result == RA_SUCCESS; boundary += RA_ARCHIVE_WRITER_BLOCK_SIZE) {
+		s64 begin = MAX(boundary - 100, 0);
+		s64 end = MIN(boundary + 100, size);
+		memset(read_data, 0, end - begin);
+		if((result = RA_archive_read(&archive, (u32) begin, (u32) (end - begin), read_data)) == RA_SUCCESS && memcmp(read_data, data + begin, end - begin) != 0) {
+			result = RA_FAILURE("data differs around offset %lld", (long long) boundary);
+		}
+	}
+	
+	RA_free(read_data);
+	RA_archive_close(&archive);
+	remove(path);
+	return result;
+}
+
+static RA_Result test_install_stored_entries() {
+	RA_Result result = RA_SUCCESS;
+	
+	const char* info = "{\"name\": \"Test\", \"author\": \"Test\"}";
+	
+	// The first asset has a header and the second one doesn't.
+	u8 asset_1[sizeof(RA_TocAssetHeader) + 100];
+	u8 asset_2[1000];
+	fill_test_data(asset_1, sizeof(asset_1), 1);
+	fill_test_data(asset_2, sizeof(asset_2), 2);
+	
+	// Everything in stored.stage is stored, so the game can read the assets
+	// straight out of the mod file. One of the assets in mixed.stage is
+	// deflated, so they all have to be copied into the cache file, the stored
+	// ones straight out of the mod file.
+	TestZipEntry stored[] = {
+		{"info.json", (const u8*) info, (u32) strlen(info), false},
+		{"0/0000000000000001", asset_1, sizeof(asset_1), false},
+		{"1/stored.dat", asset_2, sizeof(asset_2), false}
+	};
+	TestZipEntry mixed[] = {
+		{"info.json", (const u8*) info, (u32) strlen(info), true},
+		{"0/0000000000000002", asset_1, sizeof(asset_1), false},
+		{"1/deflated.dat", asset_2, sizeof(asset_2), true},
+		{"1/mixed.dat", asset_2, sizeof(asset_2), false}
+	};
+	
+	for(s32 zip64 = 0; zip64 < 2 && result == RA_SUCCESS; zip64++) {
+		if((result = create_test_game_dir()) != RA_SUCCESS
+			|| (result = write_test_zip(TEST_GAME_DIR "/mods/stored.stage", stored, ARRAY_SIZE(stored), zip64)) != RA_SUCCESS
+			|| (result = write_test_zip(TEST_GAME_DIR "/mods/mixed.stage", mixed, ARRAY_SIZE(mixed), zip64)) != RA_SUCCESS) {
+			break;
+		}
+		
+		RA_TableOfContents toc = {0};
+		RA_arena_create(&toc.arena);
+		RA_Mod* mods;
+		u32 mod_count;
+		if((result = install_test_mods(&toc, &mods, &mod_count, 0, NULL)) != RA_SUCCESS) {
+			RA_toc_free(&toc, DONT_FREE_FILE_DATA);
+			break;
+		}
+		
+		if((result = check_stored_entries(&toc, asset_1, sizeof(asset_1), asset_2, sizeof(asset_2))) != RA_SUCCESS) {
+			// The message is overwritten by the next failure, so copy it.
+			char message[1024];
+			RA_string_copy(message, result->message, sizeof(message));
+			result = RA_FAILURE("%s: %s", zip64 ? "zip64" : "zip", message);
+		}
+		
+		RA_mod_list_free(mods, mod_count);
+		RA_toc_free(&toc, DONT_FREE_FILE_DATA);
+	}
+	
+	delete_test_game_dir();
+	return result;
+}
+
+static RA_Result check_stored_entries(RA_TableOfContents* toc, u8* asset_1, u32 asset_1_size, u8* asset_2, u32 asset_2_size) {
+	RA_Result result;
+	
+	if(toc->archive_count != 2 || toc->asset_count != 5) {
+		return RA_FAILURE("wrong number of archives or assets");
+	}
+	if(RA_file_exists(TEST_GAME_DIR "/modcache/stored.stage.cache")) {
+		return RA_FAILURE("cache file written for stored.stage");
+	}
+	if((result = check_test_asset(toc, 1, 0, "mods\\stored.stage", true, asset_1, asset_1_size)) != RA_SUCCESS
+		|| (result = check_test_asset(toc, RA_crc64_path("stored.dat"), 1, "mods\\stored.stage", false, asset_2, asset_2_size)) != RA_SUCCESS
+		|| (result = check_test_asset(toc, 2, 0, "modcache\\mixed.stage.cache", true, asset_1, asset_1_size)) != RA_SUCCESS
+		|| (result = check_test_asset(toc, RA_crc64_path("deflated.dat"), 1, "modcache\\mixed.stage.cache", false, asset_2, asset_2_size)) != RA_SUCCESS
+		|| (result = check_test_asset(toc, RA_crc64_path("mixed.dat"), 1, "modcache\\mixed.stage.cache", false, asset_2, asset_2_size)) != RA_SUCCESS) {
+		return result;
+	}
+	
+	return RA_SUCCESS;
+}
+
+// The mods are loaded on multiple threads, but they should still end up in the
+// TOC in order, and one of them failing shouldn't affect the others.
+static RA_Result test_install_many_mods() {
+	RA_Result result;
+	
+	if((result = create_test_game_dir()) != RA_SUCCESS) {
+		return result;
+	}
+	
+	// Each mod has an asset of its own and one that they all share. Half of
+	// them have a deflated asset, so that they need a cache file.
+	const char* info = "{\"name\": \"Test\", \"author\": \"Test\"}";
+	u8 assets[12][300];
+	for(u32 i = 0; i < ARRAY_SIZE(assets); i++) {
+		fill_test_data(assets[i], sizeof(assets[i]), i + 1);
+		char path[RA_MAX_PATH];
+		snprintf(path, sizeof(path), TEST_GAME_DIR "/mods/mod%02u.stage", i);
+		char own_name[32];
+		snprintf(own_name, sizeof(own_name), "1/%016x", 0x100 + i);
+		TestZipEntry entries[] = {
+			{"info.json", (const u8*) info, (u32) strlen(info), false},
+			{own_name, assets[i], sizeof(assets[i]), (i % 2) == 1},
+			{"1/shared.dat", assets[i], 100, false}
+		};
+		if((result = write_test_zip(path, entries, ARRAY_SIZE(entries), false)) != RA_SUCCESS) {
+			delete_test_game_dir();
+			return result;
+		}
+	}
+	
+	RA_Mod* mods;
+	u32 mod_count;
+	if((result = RA_mod_list_load(&mods, &mod_count, TEST_GAME_DIR, NULL, report_test_mod_error)) != RA_SUCCESS) {
+		delete_test_game_dir();
+		return result;
+	}
+	if(mod_count != ARRAY_SIZE(assets)) {
+		RA_mod_list_free(mods, mod_count);
+		delete_test_game_dir();
+		return RA_FAILURE("wrong number of mods");
+	}
+	for(u32 i = 0; i < mod_count; i++) {
+		mods[i].enabled = true;
+	}
+	
+	// Break one of the mods after the list has been loaded.
+	if((result = write_test_file(TEST_GAME_DIR "/mods/mod05.stage", (const u8*) "broken", 6)) != RA_SUCCESS) {
+		RA_mod_list_free(mods, mod_count);
+		delete_test_game_dir();
+		return result;
+	}
+	
+	RA_TableOfContents toc = {0};
+	RA_arena_create(&toc.arena);
+	u32 success_count;
+	u32 fail_count;
+	if((result = RA_install_mods(mods, mod_count, &toc, &success_count, &fail_count, TEST_GAME_DIR, 0, report_test_mod_error, NULL)) != RA_SUCCESS) {
+		RA_toc_free(&toc, DONT_FREE_FILE_DATA);
+		RA_mod_list_free(mods, mod_count);
+		delete_test_game_dir();
+		return result;
+	}
+	
+	if(success_count != mod_count - 1 || fail_count != 1 || strncmp(test_mod_error, "mod05.stage:", 12) != 0) {
+		result = RA_FAILURE("wrong mods failed");
+	} else if(toc.archive_count != mod_count - 1 || toc.asset_count != mod_count) {
+		result = RA_FAILURE("wrong number of archives or assets");
+	}
+	for(u32 i = 0; i < mod_count && result == RA_SUCCESS; i++) {
+		char archive_path[RA_MAX_PATH];
+		if(i % 2 == 1) {
+			snprintf(archive_path, sizeof(archive_path), "modcache\\mod%02u.stage.cache", i);
+		} else {
+			snprintf(archive_path, sizeof(archive_path), "mods\\mod%02u.stage", i);
+		}
+		if(i == 5) {
+			if(find_test_asset(&toc, 0x105, 1) != NULL) {
+				result = RA_FAILURE("asset from the broken mod was installed");
+			}
+		} else if(strcmp(toc.archives[i < 5 ? i : i - 1].data, archive_path) != 0) {
+			result = RA_FAILURE("archives in the wrong order");
+		} else {
+			result = check_test_asset(&toc, 0x100 + i, 1, archive_path, false, assets[i], sizeof(assets[i]));
+		}
+		// The last mod takes priority.
+		if(result == RA_SUCCESS && i == mod_count - 1) {
+			result = check_test_asset(&toc, RA_crc64_path("shared.dat"), 1, archive_path, false, assets[i], 100);
+		}
+	}
+	
+	RA_toc_free(&toc, DONT_FREE_FILE_DATA);
+	RA_mod_list_free(mods, mod_count);
+	delete_test_game_dir();
+	return result;
+}
+
+// The cache file for a mod should be reused as long as neither the mod nor the
+// install flags have changed, and rebuilt otherwise.
+static RA_Result test_install_reuses_cache() {
+	RA_Result result = RA_SUCCESS;
+	
+	const char* info = "{\"name\": \"Test\", \"author\": \"Test\"}";
+	u8 asset[1000];
+	fill_test_data(asset, sizeof(asset), 1);
+	TestZipEntry entries[] = {
+		{"info.json", (const u8*) info, (u32) strlen(info), false},
+		{"1/asset.dat", asset, sizeof(asset), true}
+	};
+	u8 garbage[sizeof(asset) * 2];
+	memset(garbage, 0xcc, sizeof(garbage));
+	
+	if((result = create_test_game_dir()) != RA_SUCCESS) {
+		return result;
+	}
+	
+	for(u32 step = 0; step < 6 && result == RA_SUCCESS; step++) {
+		u32 flags = 0;
+		b8 reused = false;
+		RA_FileStat stat;
+		switch(step) {
+			case 0: {
+				result = write_test_zip(TEST_GAME_DIR "/mods/cached.stage", entries, ARRAY_SIZE(entries), false);
+				break;
+			}
+			case 1: {
+				// Nothing has changed. Fill the cache with garbage to check that
+				// it isn't rebuilt.
+				if((result = RA_file_stat(TEST_CACHE_PATH, &stat)) == RA_SUCCESS) {
+					result = write_test_file(TEST_CACHE_PATH, garbage, MIN(stat.size, sizeof(garbage)));
+				}
+				reused = true;
+				break;
+			}
+			case 2: {
+				result = write_test_file(TEST_CACHE_PATH, garbage, 10);
+				break;
+			}
+			case 3: {
+				// Same size and modified time, so only the hash of the mod file
+				// changes.
+				if((result = RA_file_stat(TEST_GAME_DIR "/mods/cached.stage", &stat)) != RA_SUCCESS) {
+					break;
+				}
+				fill_test_data(asset, sizeof(asset), 2);
+				if((result = write_test_zip(TEST_GAME_DIR "/mods/cached.stage", entries, ARRAY_SIZE(entries), false)) != RA_SUCCESS) {
+					break;
+				}
+				result = RA_file_set_modified_time(TEST_GAME_DIR "/mods/cached.stage", stat.modified_time);
+				break;
+			}
+			case 4: {
+				flags = RA_INSTALL_COMPRESS_CACHE;
+				break;
+			}
+			case 5: {
+				// Back to an uncompressed cache.
+				break;
+			}
+		}
+		if(result == RA_SUCCESS) {
+			result = install_cached_test_mod(asset, sizeof(asset), flags, reused);
+		}
+		if(result != RA_SUCCESS) {
+			// The message is overwritten by the next failure, so copy it.
+			char message[1024];
+			RA_string_copy(message, result->message, sizeof(message));
+			result = RA_FAILURE("step %u: %s", step, message);
+		}
+	}
+	
+	delete_test_game_dir();
+	return result;
+}
+
+static RA_Result install_cached_test_mod(const u8* asset, u32 asset_size, u32 flags, b8 expect_reused) {
+	RA_Result result;
+	
+	RA_TableOfContents toc = {0};
+	RA_arena_create(&toc.arena);
+	RA_Mod* mods;
+	u32 mod_count;
+	if((result = install_test_mods(&toc, &mods, &mod_count, flags, NULL)) != RA_SUCCESS) {
+		RA_toc_free(&toc, DONT_FREE_FILE_DATA);
+		return result;
+	}
+	RA_mod_list_free(mods, mod_count);
+	
+	if(expect_reused) {
+		// The cache was filled with garbage, and should have been left alone.
+		u8* data;
+		s64 size;
+		if((result = RA_file_read(TEST_CACHE_PATH, &data, &size)) == RA_SUCCESS) {
+			for(s64 i = 0; i < size; i++) {
+				if(data[i] != 0xcc) {
+					result = RA_FAILURE("cache file was rebuilt");
+					break;
+				}
+			}
+			RA_free(data);
+		}
+		RA_TocAsset* toc_asset = find_test_asset(&toc, RA_crc64_path("asset.dat"), 1);
+		if(result == RA_SUCCESS && (toc_asset == NULL || toc_asset->metadata.size != asset_size)) {
+			result = RA_FAILURE("asset missing from reused manifest");
+		}
+	} else if(flags & RA_INSTALL_COMPRESS_CACHE) {
+		RA_Archive archive;
+		if((result = RA_archive_open(&archive, TEST_CACHE_PATH)) == RA_SUCCESS) {
+			if(!archive.is_dsar_archive) {
+				result = RA_FAILURE("cache file wasn't compressed");
+			}
+			RA_archive_close(&archive);
+		}
+	} else {
+		result = check_test_asset(&toc, RA_crc64_path("asset.dat"), 1, "modcache\\cached.stage.cache", false, asset, asset_size);
+	}
+	
+	RA_toc_free(&toc, DONT_FREE_FILE_DATA);
+	return result;
+}
+
+// Paths listed as headerless in info.json should match the names in the zip
+// regardless of case.
+static RA_Result test_install_headerless() {
+	RA_Result result;
+	
+	if((result = create_test_game_dir()) != RA_SUCCESS) {
+		return result;
+	}
+	
+	// Plenty of other paths, so the hash table has some collisions.
+	char info[8192];
+	s32 info_size = snprintf(info, sizeof(info), "{\"name\": \"Test\", \"headerless\": [\"0/Textures\\\\Foo.dat\", \"8/Textures\\\\Foo.dat\", \"0/OTHER.DAT\"");
+	for(u32 i = 0; i < 100; i++) {
+		info_size += snprintf(info + info_size, sizeof(info) - info_size, ", \"0/filler/%u.dat\"", i);
+	}
+	info_size += snprintf(info + info_size, sizeof(info) - info_size, "]}");
+	
+	u8 asset[sizeof(RA_TocAssetHeader) + 100];
+	fill_test_data(asset, sizeof(asset), 1);
+	TestZipEntry entries[] = {
+		{"info.json", (const u8*) info, (u32) info_size, false},
+		{"0/textures/foo.dat", asset, sizeof(asset), false},
+		{"8/TEXTURES\\FOO.DAT", asset, sizeof(asset), false},
+		{"0/other.dat", asset, sizeof(asset), true},
+		{"0/textures/foo.dat.bak", asset, sizeof(asset), false},
+		{"0/filler.dat", asset, sizeof(asset), true},
+		{"8/filler/1.dat", asset, sizeof(asset), false},
+		{"1/textures/foo.dat", asset, sizeof(asset), false}
+	};
+	if((result = write_test_zip(TEST_GAME_DIR "/mods/headerless.stage", entries, ARRAY_SIZE(entries), false)) != RA_SUCCESS) {
+		delete_test_game_dir();
+		return result;
+	}
+	
+	RA_TableOfContents toc = {0};
+	RA_arena_create(&toc.arena);
+	RA_Mod* mods;
+	u32 mod_count;
+	if((result = install_test_mods(&toc, &mods, &mod_count, 0, NULL)) != RA_SUCCESS) {
+		RA_toc_free(&toc, DONT_FREE_FILE_DATA);
+		delete_test_game_dir();
+		return result;
+	}
+	
+	// Only assets in groups that are multiples of 8 have headers. Slashes
+	// don't match backslashes, the same as before the paths were hashed.
+	struct {
+		const char* path;
+		u32 group;
+		b8 has_header;
+	} expected[] = {
+		{"textures/foo.dat", 0, true},
+		{"textures/foo.dat", 8, false},
+		{"other.dat", 0, false},
+		{"textures/foo.dat.bak", 0, true},
+		{"filler.dat", 0, true},
+		{"filler/1.dat", 8, true},
+		{"textures/foo.dat", 1, false}
+	};
+	for(u32 i = 0; i < ARRAY_SIZE(expected) && result == RA_SUCCESS; i++) {
+		result = check_test_asset(&toc, RA_crc64_path(expected[i].path), expected[i].group, "modcache\\headerless.stage.cache", expected[i].has_header, asset, sizeof(asset));
+	}
+	
+	RA_mod_list_free(mods, mod_count);
+	RA_toc_free(&toc, DONT_FREE_FILE_DATA);
+	delete_test_game_dir();
+	return result;
+}
+
+// The headers of the assets in an .rcmod file are read a window at a time in
+// the order they appear in the file, which isn't the order of the directory.
+static RA_Result test_install_rcmod() {
+	RA_Result result;
+	
+	if((result = create_test_game_dir()) != RA_SUCCESS) {
+		return result;
+	}
+	
+	// The description is long enough that the strings don't fit in the first
+	// read. The assets are tiny, so that their headers are packed together
+	// closely enough that some of them cross the edges of the windows.
+	const char* name = "Test";
+	const char* version = "1.0";
+	const char* author = "Test";
+	s64 description_size = 100000;
+	u32 offsets[6000];
+	u32 sizes[6000];
+	u32 groups[6000];
+	s64 max_size = 64 + description_size + ARRAY_SIZE(offsets) * (sizeof(RA_TocAssetHeader) + 1 + 18);
+	u8* data = RA_malloc(max_size);
+	if(data == NULL) {
+		delete_test_game_dir();
+		return RA_FAILURE("cannot allocate");
+	}
+	
+	s64 offset = 0;
+	memcpy(&data[offset], name, strlen(name) + 1);
+	offset += strlen(name) + 1;
+	memcpy(&data[offset], version, strlen(version) + 1);
+	offset += strlen(version) + 1;
+	memset(&data[offset], 'd', description_size);
+	data[offset + description_size] = '\0';
+	offset += description_size + 1;
+	memcpy(&data[offset], author, strlen(author) + 1);
+	offset += strlen(author) + 1;
+	s64 directory_offset_offset = offset;
+	offset += 4;
+	
+	for(u32 i = 0; i < ARRAY_SIZE(offsets); i++) {
+		offsets[i] = (u32) offset;
+		groups[i] = (i % 3 == 2) ? 1 : (i % 3) * 8;
+		sizes[i] = (groups[i] % 8) == 0 ? sizeof(RA_TocAssetHeader) + 1 : 1;
+		fill_test_data(&data[offset], sizes[i], i + 1);
+		offset += sizes[i];
+	}
+	
+	put_u32(&data[directory_offset_offset], (u32) offset);
+	for(u32 i = 0; i < ARRAY_SIZE(offsets); i++) {
+		u32 index = (i * 7) % ARRAY_SIZE(offsets);
+		u8* entry = &data[offset];
+		put_u32(&entry[0], offsets[index]);
+		put_u32(&entry[4], sizes[index]);
+		put_u64(&entry[8], 0x1000 + index);
+		entry[16] = (u8) groups[index];
+		entry[17] = 0; // Not a texture.
+		offset += 18;
+	}
+	
+	if((result = write_test_file(TEST_GAME_DIR "/mods/test.rcmod", data, offset)) != RA_SUCCESS) {
+		RA_free(data);
+		delete_test_game_dir();
+		return result;
+	}
+	
+	RA_TableOfContents toc = {0};
+	RA_arena_create(&toc.arena);
+	RA_Mod* mods;
+	u32 mod_count;
+	if((result = install_test_mods(&toc, &mods, &mod_count, 0, NULL)) != RA_SUCCESS) {
+		RA_toc_free(&toc, DONT_FREE_FILE_DATA);
+		RA_free(data);
+		delete_test_game_dir();
+		return result;
+	}
+	
+	if(mod_count != 1 || strcmp(mods[0].name, name) != 0 || strcmp(mods[0].version, version) != 0
+		|| strlen(mods[0].description) != description_size || strcmp(mods[0].author, author) != 0) {
+		result = RA_FAILURE("wrong mod metadata");
+	} else if(toc.asset_count != ARRAY_SIZE(offsets)) {
+		result = RA_FAILURE("wrong number of assets");
+	}
+	for(u32 i = 0; i < ARRAY_SIZE(offsets) && result == RA_SUCCESS; i++) {
+		result = check_test_asset(&toc, 0x1000 + i, groups[i], "mods\\test.rcmod", (groups[i] % 8) == 0, &data[offsets[i]], sizes[i]);
+	}
+	
+	RA_mod_list_free(mods, mod_count);
+	RA_toc_free(&toc, DONT_FREE_FILE_DATA);
+	RA_free(data);
+	delete_test_game_dir();
+	return result;
+}
+
+// Assets provided by more than one of the mods being installed are reported as
+// conflicts, with the mods listed in install order. A mod that contains the
+// same asset twice doesn't conflict with itself, and disabled mods and the
+// assets that were already in the TOC are left out.
+static RA_Result test_install_conflicts() {
+	RA_Result result;
+	
+	if((result = create_test_game_dir()) != RA_SUCCESS) {
+		return result;
+	}
+	
+	const char* info = "{\"name\": \"Test\", \"author\": \"Test\"}";
+	u8 data[4][100];
+	for(u32 i = 0; i < ARRAY_SIZE(data); i++) {
+		fill_test_data(data[i], sizeof(data[i]), i + 1);
+	}
+	const char* names[4][4] = {
+		{"1/0000000000000005", "1/000000000000000A", "1/000000000000000a", "1/000000000000000B"},
+		{"1/000000000000000a"},
+		{"1/000000000000000b", "1/000000000000000c"},
+		{"1/000000000000000a", "1/000000000000000c"}
+	};
+	for(u32 i = 0; i < ARRAY_SIZE(names); i++) {
+		TestZipEntry entries[5] = {{"info.json", (const u8*) info, (u32) strlen(info), false}};
+		u32 entry_count = 1;
+		for(u32 j = 0; j < ARRAY_SIZE(names[i]) && names[i][j] != NULL; j++) {
+			entries[entry_count].name = names[i][j];
+			entries[entry_count].data = data[i];
+			entries[entry_count].size = sizeof(data[i]);
+			entry_count++;
+		}
+		char path[RA_MAX_PATH];
+		snprintf(path, sizeof(path), TEST_GAME_DIR "/mods/%c.stage", 'a' + i);
+		if((result = write_test_zip(path, entries, entry_count, false)) != RA_SUCCESS) {
+			delete_test_game_dir();
+			return result;
+		}
+	}
+	
+	RA_Mod* mods;
+	u32 mod_count;
+	if((result = RA_mod_list_load(&mods, &mod_count, TEST_GAME_DIR, NULL, report_test_mod_error)) != RA_SUCCESS) {
+		delete_test_game_dir();
+		return result;
+	}
+	if(mod_count != 4) {
+		RA_mod_list_free(mods, mod_count);
+		delete_test_game_dir();
+		return RA_FAILURE("wrong number of mods");
+	}
+	mods[0].enabled = true;
+	mods[1].enabled = true;
+	mods[2].enabled = true;
+	
+	// The game already has asset 5 and one archive.
+	RA_TableOfContents toc = {0};
+	RA_arena_create(&toc.arena);
+	toc.archives = RA_arena_calloc(&toc.arena, 1, sizeof(RA_TocArchive));
+	toc.archive_count = 1;
+	toc.assets = RA_arena_calloc(&toc.arena, 1, sizeof(RA_TocAsset));
+	toc.assets[0].path_hash = 5;
+	toc.assets[0].group = 1;
+	toc.asset_count = 1;
+	
+	u32 success_count;
+	u32 fail_count;
+	RA_ModConflictList conflicts;
+	if((result = RA_install_mods(mods, mod_count, &toc, &success_count, &fail_count, TEST_GAME_DIR, 0, report_test_mod_error, &conflicts)) != RA_SUCCESS) {
+		RA_toc_free(&toc, DONT_FREE_FILE_DATA);
+		RA_mod_list_free(mods, mod_count);
+		delete_test_game_dir();
+		return result;
+	}
+	
+	if(success_count != 3 || fail_count != 0) {
+		result = RA_FAILURE("cannot load mod: %s", test_mod_error);
+	} else if(toc.archive_count != 4 || toc.asset_count != 4) {
+		result = RA_FAILURE("wrong number of archives or assets");
+	} else if(toc.assets[0].path_hash != 5) {
+		result = RA_FAILURE("asset already in the TOC was moved");
+	}
+	
+	// The last mod to provide an asset wins.
+	struct {
+		u64 path_hash;
+		const char* archive_path;
+		u32 mod;
+	} expected[] = {
+		{0x5, "mods\\a.stage", 0},
+		{0xa, "mods\\b.stage", 1},
+		{0xb, "mods\\c.stage", 2},
+		{0xc, "mods\\c.stage", 2}
+	};
+	for(u32 i = 0; i < ARRAY_SIZE(expected) && result == RA_SUCCESS; i++) {
+		result = check_test_asset(&toc, expected[i].path_hash, 1, expected[i].archive_path, false, data[expected[i].mod], sizeof(data[0]));
+	}
+	
+	// The conflicts are in the order the assets were first seen.
+	if(result == RA_SUCCESS && conflicts.conflict_count != 2) {
+		result = RA_FAILURE("wrong number of conflicts");
+	} else if(result == RA_SUCCESS) {
+		RA_ModConflict* a = &conflicts.conflicts[0];
+		RA_ModConflict* b = &conflicts.conflicts[1];
+		if(a->path_hash != 0xa || a->group != 1 || a->mod_count != 2 || a->mod_indices[0] != 0 || a->mod_indices[1] != 1
+			|| b->path_hash != 0xb || b->group != 1 || b->mod_count != 2 || b->mod_indices[0] != 0 || b->mod_indices[1] != 2) {
+			result = RA_FAILURE("wrong conflicts");
+		}
+	}
+	
+	RA_mod_conflict_list_free(&conflicts);
+	RA_toc_free(&toc, DONT_FREE_FILE_DATA);
+	RA_mod_list_free(mods, mod_count);
+	delete_test_game_dir();
+	return result;
+}
+
+// Deflated assets are copied into the cache file a megabyte at a time, so the
+// texture header is put across the boundary between the first two chunks. The
+// stored copy is read straight out of the mod file, and the header is far
+// enough in that it isn't in the part read to find it.
+static RA_Result test_install_texture() {
+	RA_Result result;
+	
+	if((result = create_test_game_dir()) != RA_SUCCESS) {
+		return result;
+	}
+	
+	RA_TextureHeader texture_header = {0};
+	texture_header.texture_size = 0x11223344;
+	texture_header.streamed_size = 0x00556677;
+	texture_header.width = 2048;
+	texture_header.height = 1024;
+	texture_header.width_in_texture_file = 512;
+	texture_header.height_in_texture_file = 256;
+	texture_header.format = 0x4d;
+	texture_header.unknown_1e = 0x0b;
+	texture_header.unknown_20 = 0x0c;
+	
+	u8* texture = NULL;
+	u32 texture_size = 0;
+	if((result = build_test_texture(&texture, &texture_size, 1024 * 1024 - 0x10, &texture_header)) != RA_SUCCESS) {
+		delete_test_game_dir();
+		return result;
+	}
+	
+	const char* info = "{\"name\": \"Test\", \"author\": \"Test\"}";
+	TestZipEntry deflated[] = {
+		{"info.json", (const u8*) info, (u32) strlen(info), false},
+		{"0/deflated.texture", texture, texture_size, true}
+	};
+	TestZipEntry stored[] = {
+		{"info.json", (const u8*) info, (u32) strlen(info), false},
+		{"0/stored.texture", texture, texture_size, false}
+	};
+	if((result = write_test_zip(TEST_GAME_DIR "/mods/deflated.stage", deflated, ARRAY_SIZE(deflated), false)) != RA_SUCCESS
+		|| (result = write_test_zip(TEST_GAME_DIR "/mods/stored.stage", stored, ARRAY_SIZE(stored), false)) != RA_SUCCESS) {
+		RA_free(texture);
+		delete_test_game_dir();
+		return result;
+	}
+	
+	RA_TableOfContents toc = {0};
+	RA_arena_create(&toc.arena);
+	RA_Mod* mods;
+	u32 mod_count;
+	if((result = install_test_mods(&toc, &mods, &mod_count, 0, NULL)) != RA_SUCCESS) {
+		RA_toc_free(&toc, DONT_FREE_FILE_DATA);
+		RA_free(texture);
+		delete_test_game_dir();
+		return result;
+	}
+	
+	if((result = check_test_asset(&toc, RA_crc64_path("deflated.texture"), 0, "modcache\\deflated.stage.cache", true, texture, texture_size)) == RA_SUCCESS
+		&& (result = check_test_asset(&toc, RA_crc64_path("stored.texture"), 0, "mods\\stored.stage", true, texture, texture_size)) == RA_SUCCESS
+		&& (result = check_test_texture_meta(&toc, RA_crc64_path("deflated.texture"), &texture_header)) == RA_SUCCESS) {
+		result = check_test_texture_meta(&toc, RA_crc64_path("stored.texture"), &texture_header);
+	}
+	
+	RA_mod_list_free(mods, mod_count);
+	RA_toc_free(&toc, DONT_FREE_FILE_DATA);
+	RA_free(texture);
+	delete_test_game_dir();
+	return result;
+}
+
+static RA_Result check_test_texture_meta(RA_TableOfContents* toc, u64 path_hash, RA_TextureHeader* expected) {
+	RA_TocAsset* asset = find_test_asset(toc, path_hash, 0);
+	if(asset == NULL) {
+		return RA_FAILURE("asset %016" PRIx64 " missing", path_hash);
+	}
+	if(!asset->has_texture_meta) {
+		return RA_FAILURE("asset %016" PRIx64 " has no texture metadata", path_hash);
+	}
+	RA_TocTextureMeta* meta = &asset->texture_meta;
+	if(meta->width_in_texture_file != expected->width_in_texture_file
+		|| meta->height_in_texture_file != expected->height_in_texture_file
+		|| meta->format != expected->format
+		|| meta->total_size != expected->texture_size + expected->streamed_size
+		|| meta->streamed_size != expected->streamed_size
+		|| meta->unknown_20 != expected->unknown_1e
+		|| meta->unknown_40 != expected->unknown_20
+		|| meta->unknown_41 != expected->unknown_1e) {
+		return RA_FAILURE("asset %016" PRIx64 " has wrong texture metadata", path_hash);
+	}
+	return RA_SUCCESS;
+}
+
+#define TEST_MOD_LIST_CACHE_PATH TEST_GAME_DIR "/modcache/mod_list.json"
+
+// The mods are told apart by the names in their info.json files, which are
+// all the same length so that changing one doesn't change the size of the mod.
+static RA_Result test_mod_list_cache() {
+	RA_Result result;
+	
+	if((result = create_test_game_dir()) != RA_SUCCESS) {
+		return result;
+	}
+	RA_make_dir(TEST_GAME_DIR "/modcache");
+	
+	const char* names[] = {"Mod 1", "Mod 2", "Mod 3"};
+	RA_FileStat stat;
+	for(u32 step = 0; step < 5 && result == RA_SUCCESS; step++) {
+		switch(step) {
+			case 0: {
+				if((result = write_test_mod_info("first.stage", "Mod 1")) == RA_SUCCESS
+					&& (result = write_test_mod_info("second.stage", "Mod 2")) == RA_SUCCESS) {
+					result = write_test_mod_info("third.stage", "Mod 3");
+				}
+				break;
+			}
+			case 1: {
+				// The size and modified time of the second mod stay the same, so
+				// its old name should come from the cache. Nothing else has
+				// changed, so the cache shouldn't be written out again.
+				if((result = RA_file_stat(TEST_GAME_DIR "/mods/second.stage", &stat)) != RA_SUCCESS
+					|| (result = write_test_mod_info("second.stage", "Mod X")) != RA_SUCCESS
+					|| (result = RA_file_set_modified_time(TEST_GAME_DIR "/mods/second.stage", stat.modified_time)) != RA_SUCCESS) {
+					break;
+				}
+				result = RA_file_set_modified_time(TEST_MOD_LIST_CACHE_PATH, 0);
+				break;
+			}
+			case 2: {
+				// Only the third mod has a new modified time, so only it should
+				// be reparsed.
+				if((result = RA_file_stat(TEST_GAME_DIR "/mods/third.stage", &stat)) != RA_SUCCESS
+					|| (result = write_test_mod_info("third.stage", "Mod Y")) != RA_SUCCESS) {
+					break;
+				}
+				result = RA_file_set_modified_time(TEST_GAME_DIR "/mods/third.stage", stat.modified_time + 1000000000);
+				names[2] = "Mod Y";
+				break;
+			}
+			case 3: {
+				remove(TEST_GAME_DIR "/mods/first.stage");
+				names[0] = names[1];
+				names[1] = names[2];
+				break;
+			}
+			case 4: {
+				// The cache was written for a different game folder path.
+				names[0] = "Mod X";
+				break;
+			}
+		}
+		
+		u32 expected_count = step < 3 ? 3 : 2;
+		const char* game_dir = step < 4 ? TEST_GAME_DIR : TEST_GAME_DIR "/.";
+		if(result == RA_SUCCESS) {
+			result = load_cached_test_mod_list(game_dir, names, expected_count);
+		}
+		if(result == RA_SUCCESS) {
+			result = check_test_mod_list_cache(step);
+		}
+		if(result != RA_SUCCESS) {
+			// The message is overwritten by the next failure, so copy it.
+			char message[1024];
+			RA_string_copy(message, result->message, sizeof(message));
+			result = RA_FAILURE("step %u: %s", step, message);
+		}
+	}
+	
+	delete_test_game_dir();
+	return result;
+}
+
+static RA_Result load_cached_test_mod_list(const char* game_dir, const char* expected_names[3], u32 expected_count) {
+	RA_Result result;
+	
+	RA_Mod* mods;
+	u32 mod_count;
+	if((result = RA_mod_list_load(&mods, &mod_count, game_dir, TEST_MOD_LIST_CACHE_PATH, report_test_mod_error)) != RA_SUCCESS) {
+		return result;
+	}
+	
+	result = RA_SUCCESS;
+	if(test_mod_error[0] != '\0') {
+		result = RA_FAILURE("cannot load mod: %s", test_mod_error);
+	} else if(mod_count != expected_count) {
+		result = RA_FAILURE("wrong number of mods");
+	}
+	for(u32 i = 0; i < mod_count && result == RA_SUCCESS; i++) {
+		RA_Mod* mod = &mods[i];
+		if(mod->format != RA_MOD_FORMAT_STAGE || mod->name == NULL || strcmp(mod->name, expected_names[i]) != 0
+			|| mod->author == NULL || strcmp(mod->author, "Test") != 0
+			|| mod->version != NULL || mod->description != NULL) {
+			result = RA_FAILURE("wrong metadata for %s", mod->file_name);
+		}
+	}
+	
+	RA_mod_list_free(mods, mod_count);
+	return result;
+}
+
+// Check what happened to the cache file during a step of test_mod_list_cache.
+static RA_Result check_test_mod_list_cache(u32 step) {
+	RA_Result result;
+	
+	RA_FileStat stat;
+	if((result = RA_file_stat(TEST_MOD_LIST_CACHE_PATH, &stat)) != RA_SUCCESS) {
+		return result;
+	}
+	if(step == 1 && stat.modified_time != 0) {
+		return RA_FAILURE("cache written when nothing changed");
+	}
+	if(step == 2 && stat.modified_time == 0) {
+		return RA_FAILURE("cache not written when a mod changed");
+	}
+	if(step == 3) {
+		u8* data;
+		s64 size;
+		if((result = RA_file_read(TEST_MOD_LIST_CACHE_PATH, &data, &size)) != RA_SUCCESS) {
+			return result;
+		}
+		b8 found = strstr((char*) data, "\"first.stage\"") != NULL;
+		RA_free(data);
+		if(found) {
+			return RA_FAILURE("removed mod still in the cache");
+		}
+	}
+	return RA_SUCCESS;
+}
+
+static RA_Result write_test_mod_info(const char* file_name, const char* name) {
+	char info[256];
+	snprintf(info, sizeof(info), "{\"name\": \"%s\", \"author\": \"Test\"}", name);
+	TestZipEntry entries[] = {
+		{"info.json", (const u8*) info, (u32) strlen(info), false}
+	};
+	char path[RA_MAX_PATH];
+	snprintf(path, sizeof(path), "%s/mods/%s", TEST_GAME_DIR, file_name);
+	return write_test_zip(path, entries, ARRAY_SIZE(entries), false);
+}
+
+// Make an empty game folder for the mods to be installed into.
+static RA_Result create_test_game_dir() {
+	delete_test_game_dir();
+	RA_make_dir(TEST_GAME_DIR);
+	RA_make_dir(TEST_GAME_DIR "/mods");
+	test_mod_error[0] = '\0';
+	return write_test_file(TEST_GAME_DIR "/RiftApart.exe", NULL, 0);
+}
+
+static void delete_test_game_dir() {
+	const char* dirs[] = {TEST_GAME_DIR "/mods", TEST_GAME_DIR "/modcache"};
+	for(u32 i = 0; i < ARRAY_SIZE(dirs); i++) {
+		RA_StringList file_names;
+		if(RA_enumerate_directory(&file_names, dirs[i]) == RA_SUCCESS) {
+			for(u32 j = 0; j < file_names.count; j++) {
+				char path[RA_MAX_PATH];
+				snprintf(path, sizeof(path), "%s/%s", dirs[i], file_names.strings[j]);
+				remove(path);
+			}
+			RA_string_list_destroy(&file_names);
+		}
+		// This doesn't work for directories on Windows, so they're left there.
+		remove(dirs[i]);
+	}
+	remove(TEST_GAME_DIR "/RiftApart.exe");
+	remove(TEST_GAME_DIR);
+}
+
+// Load and install all the mods in the test game folder. The TOC has to be set
+// up by the caller.
+static RA_Result install_test_mods(RA_TableOfContents* toc, RA_Mod** mods_dest, u32* mod_count_dest, u32 flags, RA_ModConflictList* conflicts_dest) {
+	RA_Result result;
+	
+	if((result = RA_mod_list_load(mods_dest, mod_count_dest, TEST_GAME_DIR, NULL, report_test_mod_error)) != RA_SUCCESS) {
+		return result;
+	}
+	for(u32 i = 0; i < *mod_count_dest; i++) {
+		(*mods_dest)[i].enabled = true;
+	}
+	
+	u32 success_count;
+	u32 fail_count;
+	if((result = RA_install_mods(*mods_dest, *mod_count_dest, toc, &success_count, &fail_count, TEST_GAME_DIR, flags, report_test_mod_error, conflicts_dest)) != RA_SUCCESS) {
+		RA_mod_list_free(*mods_dest, *mod_count_dest);
+		return result;
+	}
+	if(test_mod_error[0] != '\0' || fail_count != 0 || success_count != *mod_count_dest) {
+		if(conflicts_dest != NULL) {
+			RA_mod_conflict_list_free(conflicts_dest);
+		}
+		RA_mod_list_free(*mods_dest, *mod_count_dest);
+		return RA_FAILURE("cannot load mod: %s", test_mod_error);
+	}
+	
+	return RA_SUCCESS;
+}
+
+static void report_test_mod_error(const char* file_name, RA_Result result) {
+	if(test_mod_error[0] == '\0') {
+		snprintf(test_mod_error, sizeof(test_mod_error), "%s: %s", file_name, result->message);
+	}
+}
+
+// Check that an asset has been added to the TOC, and that it points to the
+// right data. If has_header is true, the data starts with the header.
+static RA_Result check_test_asset(RA_TableOfContents* toc, u64 path_hash, u32 group, const char* archive_path, b8 has_header, const u8* data, u32 size) {
+	RA_TocAsset* asset = find_test_asset(toc, path_hash, group);
+	if(asset == NULL) {
+		return RA_FAILURE("asset %016" PRIx64 " missing", path_hash);
+	}
+	if(asset->metadata.archive_index >= toc->archive_count || strcmp(toc->archives[asset->metadata.archive_index].data, archive_path) != 0) {
+		return RA_FAILURE("asset %016" PRIx64 " in wrong archive", path_hash);
+	}
+	if(asset->has_header != has_header) {
+		return RA_FAILURE("asset %016" PRIx64 " has_header is wrong", path_hash);
+	}
+	if(has_header) {
+		if(memcmp(&asset->header, data, sizeof(RA_TocAssetHeader)) != 0) {
+			return RA_FAILURE("asset %016" PRIx64 " has wrong header", path_hash);
+		}
+		data += sizeof(RA_TocAssetHeader);
+		size -= sizeof(RA_TocAssetHeader);
+	}
+	if(asset->metadata.size != size) {
+		return RA_FAILURE("asset %016" PRIx64 " has wrong size", path_hash);
+	}
+	
+	// Archive paths are relative to the game folder and use backslashes.
+	char path[RA_MAX_PATH];
+	snprintf(path, sizeof(path), "%s/%s", TEST_GAME_DIR, archive_path);
+	for(char* c = path; *c != '\0'; c++) {
+		if(*c == '\\') {
+			*c = '/';
+		}
+	}
+	FILE* file = fopen(path, "rb");
+	if(file == NULL) {
+		return RA_FAILURE("cannot open '%s'", path);
+	}
+	u8* archive_data = RA_malloc(MAX(size, 1));
+	if(archive_data == NULL) {
+		fclose(file);
+		return RA_FAILURE("cannot allocate");
+	}
+	RA_Result result = RA_SUCCESS;
+	if(RA_file_read_range(file, asset->metadata.offset, archive_data, size) != RA_SUCCESS || memcmp(archive_data, data, size) != 0) {
+		result = RA_FAILURE("asset %016" PRIx64 " has wrong data", path_hash);
+	}
+	RA_free(archive_data);
+	fclose(file);
+	return result;
+}
+
+// The assets added by RA_install_mods aren't sorted, so RA_toc_lookup_asset
+// can't be used to find them.
+static RA_TocAsset* find_test_asset(RA_TableOfContents* toc, u64 path_hash, u32 group) {
+	for(u32 i = 0; i < toc->asset_count; i++) {
+		if(toc->assets[i].path_hash == path_hash && toc->assets[i].group == group) {
+			return &toc->assets[i];
+		}
+	}
+	return NULL;
+}
+
+// If zip64 is true, the sizes and offsets are put in the zip64 records and
+// extra fields instead, like tools do when they don't fit in 32 bits.
+static RA_Result write_test_zip(const char* path, TestZipEntry* entries, u32 entry_count, b8 zip64) {
+	s64 max_size = 56 + 20 + 22;
+	for(u32 i = 0; i < entry_count; i++) {
+		s64 name_size = strlen(entries[i].name);
+		max_size += 30 + name_size + entries[i].size + 5 * (entries[i].size / 0xffff + 1) + 46 + name_size + 28;
+	}
+	u8* data = RA_malloc(max_size);
+	u32* local_offsets = RA_malloc(MAX(entry_count, 1) * sizeof(u32));
+	if(data == NULL || local_offsets == NULL) {
+		if(data) RA_free(data);
+		if(local_offsets) RA_free(local_offsets);
+		return RA_FAILURE("cannot allocate zip");
+	}
+	
+	s64 offset = 0;
+	for(u32 i = 0; i < entry_count; i++) {
+		TestZipEntry* entry = &entries[i];
+		u16 name_size = (u16) strlen(entry->name);
+		u8* header = &data[offset];
+		local_offsets[i] = (u32) offset;
+		offset += 30 + name_size;
+		
+		s64 data_offset = offset;
+		if(entry->deflate) {
+			// Split the data up into uncompressed blocks.
+			u32 copied = 0;
+			do {
+				u16 block_size = (u16) MIN(entry->size - copied, 0xffff);
+				data[offset] = copied + block_size == entry->size; // Last block.
+				put_u16(&data[offset + 1], block_size);
+				put_u16(&data[offset + 3], (u16) ~block_size);
+				memcpy(&data[offset + 5], entry->data + copied, block_size);
+				offset += 5 + block_size;
+				copied += block_size;
+			} while(copied < entry->size);
+		} else {
+			memcpy(&data[offset], entry->data, entry->size);
+			offset += entry->size;
+		}
+		
+		memset(header, 0, 30);
+		put_u32(&header[0], 0x04034b50);
+		put_u16(&header[4], 20); // Version needed to extract.
+		put_u16(&header[8], entry->deflate ? 8 : 0);
+		put_u32(&header[14], ~RA_crc32_update(0xffffffff, entry->data, entry->size));
+		put_u32(&header[18], (u32) (offset - data_offset));
+		put_u32(&header[22], entry->size);
+		put_u16(&header[26], name_size);
+		memcpy(&header[30], entry->name, name_size);
+	}
+	
+	s64 directory_offset = offset;
+	for(u32 i = 0; i < entry_count; i++) {
+		u8* local_header = &data[local_offsets[i]];
+		u16 name_size = (u16) strlen(entries[i].name);
+		u8* header = &data[offset];
+		memset(header, 0, 46);
+		put_u32(&header[0], 0x02014b50);
+		put_u16(&header[4], zip64 ? 45 : 20); // Version made by.
+		put_u16(&header[6], zip64 ? 45 : 20); // Version needed to extract.
+		// The method, time, date, CRC and sizes are laid out the same way as
+		// in the local header.
+		memcpy(&header[10], &local_header[8], 18);
+		put_u16(&header[28], name_size);
+		put_u32(&header[42], local_offsets[i]);
+		memcpy(&header[46], entries[i].name, name_size);
+		offset += 46 + name_size;
+		
+		if(zip64) {
+			u32 compressed_size;
+			memcpy(&compressed_size, &local_header[18], 4);
+			put_u32(&header[20], 0xffffffff);
+			put_u32(&header[24], 0xffffffff);
+			put_u16(&header[30], 28);
+			put_u32(&header[42], 0xffffffff);
+			u8* extra = &data[offset];
+			put_u16(&extra[0], 0x0001);
+			put_u16(&extra[2], 24);
+			put_u64(&extra[4], entries[i].size);
+			put_u64(&extra[12], compressed_size);
+			put_u64(&extra[20], local_offsets[i]);
+			offset += 28;
+		}
+	}
+	s64 directory_size = offset - directory_offset;
+	
+	if(zip64) {
+		u8* record = &data[offset];
+		memset(record, 0, 56);
+		put_u32(&record[0], 0x06064b50);
+		put_u64(&record[4], 56 - 12); // Size of the rest of the record.
+		put_u16(&record[12], 45); // Version made by.
+		put_u16(&record[14], 45); // Version needed to extract.
+		put_u64(&record[24], entry_count);
+		put_u64(&record[32], entry_count);
+		put_u64(&record[40], directory_size);
+		put_u64(&record[48], directory_offset);
+		
+		u8* locator = &data[offset + 56];
+		put_u32(&locator[0], 0x07064b50);
+		put_u32(&locator[4], 0);
+		put_u64(&locator[8], offset);
+		put_u32(&locator[16], 1); // Number of disks.
+		offset += 56 + 20;
+	}
+	
+	u8* end = &data[offset];
+	memset(end, 0, 22);
+	put_u32(&end[0], 0x06054b50);
+	put_u16(&end[8], zip64 ? 0xffff : entry_count);
+	put_u16(&end[10], zip64 ? 0xffff : entry_count);
+	put_u32(&end[12], zip64 ? 0xffffffff : (u32) directory_size);
+	put_u32(&end[16], zip64 ? 0xffffffff : (u32) directory_offset);
+	offset += 22;
+	
+	RA_Result result = write_test_file(path, data, offset);
+	RA_free(local_offsets);
+	RA_free(data);
+	return result;
+}
+
+// Build a texture asset, starting with its asset header, where the texture
+// header lump is header_offset bytes into the DAT file.
+static RA_Result build_test_texture(u8** data_dest, u32* size_dest, u32 header_offset, RA_TextureHeader* texture_header) {
+	RA_Result result;
+	
+	// The lumps are laid out in order, so the first one pushes the texture
+	// header along. Work out how far it goes with a guess at the size first.
+	u32 filler_size = header_offset / 2;
+	for(u32 pass = 0; pass < 2; pass++) {
+		RA_DatWriter* writer = RA_dat_writer_begin(RA_ASSET_TYPE_TEXTURE, 0);
+		u8* filler = RA_dat_writer_lump(writer, LUMP_MODEL_LOOK, filler_size);
+		fill_test_data(filler, filler_size, 3);
+		RA_TextureHeader* header = RA_dat_writer_lump(writer, LUMP_TEXTURE_HEADER, sizeof(RA_TextureHeader));
+		memcpy(header, texture_header, sizeof(RA_TextureHeader));
+		u8* pixels = RA_dat_writer_lump(writer, LUMP_MODEL_LOOK, 0x1000);
+		fill_test_data(pixels, 0x1000, 4);
+		
+		u8* dat_data;
+		s64 dat_size;
+		if((result = RA_dat_writer_finish(writer, &dat_data, &dat_size)) != RA_SUCCESS) {
+			return result;
+		}
+		RA_DatFile dat;
+		if((result = RA_dat_parse(&dat, dat_data, (u32) dat_size, 0)) != RA_SUCCESS) {
+			RA_free(dat_data);
+			return result;
+		}
+		u32 offset = RA_dat_lookup_lump(&dat, LUMP_TEXTURE_HEADER)->offset;
+		RA_dat_free(&dat, DONT_FREE_FILE_DATA);
+		
+		if(offset == header_offset) {
+			u8* data = RA_malloc(sizeof(RA_TocAssetHeader) + dat_size);
+			if(data == NULL) {
+				RA_free(dat_data);
+				return RA_FAILURE("cannot allocate");
+			}
+			RA_TocAssetHeader asset_header = {0};
+			asset_header.asset_type_hash = RA_ASSET_TYPE_TEXTURE;
+			memcpy(data, &asset_header, sizeof(RA_TocAssetHeader));
+			memcpy(data + sizeof(RA_TocAssetHeader), dat_data, dat_size);
+			RA_free(dat_data);
+			*data_dest = data;
+			*size_dest = (u32) (sizeof(RA_TocAssetHeader) + dat_size);
+			return RA_SUCCESS;
+		}
+		RA_free(dat_data);
+		filler_size += header_offset - offset;
+	}
+	
+	return RA_FAILURE("cannot put the texture header at 0x%x", header_offset);
+}
+
+static RA_Result write_test_file(const char* path, const u8* data, s64 size) {
+	FILE* file = fopen(path, "wb");
+	if(file == NULL) {
+		return RA_FAILURE("cannot open '%s'", path);
+	}
+	b8 success = size == 0 || fwrite(data, size, 1, file) == 1;
+	if(fclose(file) != 0 || !success) {
+		return RA_FAILURE("cannot write '%s'", path);
+	}
+	return RA_SUCCESS;
+}
+
+static void fill_test_data(u8* data, s64 size, u32 seed) {
+	u32 random = seed;
+	for(s64 i = 0; i < size; i++) {
+		random = random * 1103515245 + 12345;
+		data[i] = (u8) (random >> 16);
+	}
+}
+
+static void put_u16(u8* dest, u16 value) {
+	memcpy(dest, &value, 2);
+}
+
+static void put_u32(u8* dest, u32 value) {
+	memcpy(dest, &value, 4);
+}
+
+static void put_u64(u8* dest, u64 value) {
+	memcpy(dest, &value, 8);
+}
@@ -119,7 +119,8 @@ int main(int argc, char** argv) {
 			continue;
 		}
 		
-		// Read and decompress blocks as necessary, and assemble the asset.
+		// Read and decompress blocks as necessary, and assemble the parts of
+		// the asset that are needed to find the texture header.
 		u8* data = RA_calloc(1, toc_asset->metadata.size);
 		u32 size = toc_asset->metadata.size;
 		if(toc_asset->has_header) {
@@ -129,21 +130,24 @@ int main(int argc, char** argv) {
 			fprintf(stderr, "error: Failed allocate memory for asset '%s'.\n", asset_path);
 			return 1;
 		}
-		if((result = RA_archive_read(&archive, toc_asset->metadata.offset, toc_asset->metadata.size, data)) != RA_SUCCESS) {
+		u32 peek_size = MIN(size, RA_DAT_MAX_HEADER_SIZE);
+		if((result = RA_archive_read(&archive, toc_asset->metadata.offset, peek_size, data)) != RA_SUCCESS) {
 			fprintf(stderr, "error: Failed to read block for asset '%s' (%s).\n", asset_path, result->message);
 			return 1;
 		}
 		
-		RA_DatFile dat;
-		if((result = RA_dat_parse(&dat, data, size, 0)) != RA_SUCCESS) {
-			fprintf(stderr, "error: Failed to read texture asset '%s' (%s).", asset_path, result->message);
+		RA_DatLump header_lump;
+		if((result = RA_dat_peek_lump(&header_lump, data, peek_size, size, 0, LUMP_TEXTURE_HEADER)) != RA_SUCCESS) {
+			fprintf(stderr, "error: Failed to find texture header lump in asset '%s' (%s).", asset_path, result->message);
 			return 1;
 		}
-		
-		RA_DatLump* lump = RA_dat_lookup_lump(&dat, LUMP_TEXTURE_HEADER);
-		if(lump == NULL) {
-			fprintf(stderr, "error: Failed to find texture header lump in asset '%s'.", asset_path);
-			return 1;
+		RA_DatLump* lump = &header_lump;
+		if(lump->data == NULL) {
+			if((result = RA_archive_read(&archive, toc_asset->metadata.offset + lump->offset, lump->size, data + lump->offset)) != RA_SUCCESS) {
+				fprintf(stderr, "error: Failed to read block for asset '%s' (%s).\n", asset_path, result->message);
+				return 1;
+			}
+			lump->data = data + lump->offset;
 		}
 		
 		RA_TocTextureMeta meta;